@@ -21,6 +21,17 @@
  *          Dinh Thao Le <243759@vut.cz>
  */
 
+#include "analytic-random-mobility-model.h"
+#include "async-pcap-capture.h"
+#include "http-metrics-collector.h"
+#include "http-qoe-tracker.h"
+#include "lte-kpi-tracer.h"
+#include "run-summary.h"
+#include "simulation-progress.h"
+#include "spatial-attach-helper.h"
+#include "staggered-install-helper.h"
+#include "traffic-mix-helper.h"
+
 #include "ns3/core-module.h"
 #include "ns3/point-to-point-module.h"
 #include "ns3/internet-module.h"
@@ -29,10 +40,9 @@
 #include "ns3/config-store-module.h"
 #include "ns3/lte-module.h"
 #include "ns3/netanim-module.h"
+#include "ns3/flow-monitor-module.h"
 #include "ns3/random-waypoint-mobility-model.h"
 #include <iostream>
-#include <cstdlib>
-#include <ctime>
 
 
 
@@ -79,14 +89,14 @@ ClientRx (Ptr<const Packet> packet, const Address &address)
 void
 ClientMainObjectReceived (Ptr<const ThreeGppHttpClient>, Ptr<const Packet> packet)
 {
-  Ptr<Packet> p = packet->Copy ();
   ThreeGppHttpHeader header;
-  p->RemoveHeader (header);
-  if (header.GetContentLength () == p->GetSize ()
+  const uint32_t headerSize = packet->PeekHeader (header);
+  const uint32_t contentSize = packet->GetSize () - headerSize;
+  if (header.GetContentLength () == contentSize
       && header.GetContentType () == ThreeGppHttpHeader::MAIN_OBJECT)
     {
       NS_LOG_INFO ("Client has successfully received a main object of "
-                   << p->GetSize () << " bytes.");
+                   << contentSize << " bytes.");
     }
   else
     {
@@ -97,14 +107,14 @@ ClientMainObjectReceived (Ptr<const ThreeGppHttpClient>, Ptr<const Packet> packe
 void
 ClientEmbeddedObjectReceived (Ptr<const ThreeGppHttpClient>, Ptr<const Packet> packet)
 {
-  Ptr<Packet> p = packet->Copy ();
   ThreeGppHttpHeader header;
-  p->RemoveHeader (header);
-  if (header.GetContentLength () == p->GetSize ()
+  const uint32_t headerSize = packet->PeekHeader (header);
+  const uint32_t contentSize = packet->GetSize () - headerSize;
+  if (header.GetContentLength () == contentSize
       && header.GetContentType () == ThreeGppHttpHeader::EMBEDDED_OBJECT)
     {
       NS_LOG_INFO ("Client has successfully received an embedded object of "
-                   << p->GetSize () << " bytes.");
+                   << contentSize << " bytes.");
     }
   else
     {
@@ -122,6 +132,19 @@ main (int argc, char *argv[])
   bool disableDl = false;
   bool disableUl = false;
   bool disablePl = false;
+  bool analyticMobility = true;
+  std::string summaryFile;
+  std::string attachMode = "parity";
+  std::string pcapMode = "full";
+  std::string httpTrace = "metrics";
+  std::string clientStart = "uniform";
+  Time clientStartSpread = Seconds (1);
+  int64_t clientStartStream = 1000;
+  std::string trafficMixWeights = "http=1,idle=1";
+  int64_t trafficMixStream = 2000;
+  Time kpiInterval = Seconds (0);
+  Time progressInterval = Seconds (10);
+  Time wallClockBudget = Seconds (0);
 
   // Command line arguments
   CommandLine cmd;
@@ -132,6 +155,19 @@ main (int argc, char *argv[])
   cmd.AddValue ("disableDl", "Disable downlink data flows", disableDl);
   cmd.AddValue ("disableUl", "Disable uplink data flows", disableUl);
   cmd.AddValue ("disablePl", "Disable data flows between peer UEs", disablePl);
+  cmd.AddValue ("analyticMobility", "Move the UEs with ns3::AnalyticRandomMobilityModel (positions computed when read) instead of RandomDirection2dMobilityModel (an event per leg and pause)", analyticMobility);
+  cmd.AddValue ("summaryFile", "CSV file receiving the aggregate run metrics", summaryFile);
+  cmd.AddValue ("attachMode", "Initial attachment: parity, nearest or strongest (spatial index)", attachMode);
+  cmd.AddValue ("pcapMode", "Capture of the point-to-point links: full, async (truncated, background writer, see ns3::AsyncPcapCapture) or none", pcapMode);
+  cmd.AddValue ("httpTrace", "HTTP application tracing: metrics (counters and histograms in lte-epc-http.csv, page load times in lte-epc-http-qoe.csv) or log (NS_LOG_INFO per packet)", httpTrace);
+  cmd.AddValue ("clientStart", "Start times of the HTTP, bulk and UDP clients: simultaneous, uniform or poisson", clientStart);
+  cmd.AddValue ("clientStartSpread", "Window of the uniform start times, mean span of the poisson arrivals", clientStartSpread);
+  cmd.AddValue ("clientStartStream", "Random stream of the client start times", clientStartStream);
+  cmd.AddValue ("trafficMix", "Weights of the UE traffic profiles: http (3GPP web browsing), bulk (uplink BulkSend), udp (downlink CBR every interPacketInterval) and idle, e.g. http=2,bulk=1,udp=1,idle=1", trafficMixWeights);
+  cmd.AddValue ("trafficMixStream", "Random stream of the placement of the traffic profiles", trafficMixStream);
+  cmd.AddValue ("kpiInterval", "Aggregation interval of the per-UE LTE KPI trace in lte-epc.kpi, read with lte-kpi-dump (0 disables it)", kpiInterval);
+  cmd.AddValue ("progressInterval", "Wall time between two progress lines on stderr (0 prints none)", progressInterval);
+  cmd.AddValue ("wallClockBudget", "Wall time after which the run stops early and writes its results for the simulated time reached (0 for no limit); Ctrl-C does the same", wallClockBudget);
   cmd.Parse (argc, argv);
 
   // ConfigStore inputConfig;
@@ -186,7 +222,11 @@ main (int argc, char *argv[])
     }
   MobilityHelper mobility;
   // Install the mobility model to the nodes
-  mobility.SetMobilityModel ("ns3::RandomDirection2dMobilityModel",
+  // Same random direction motion either way; the analytic model computes
+  // the positions when they are read instead of scheduling every leg and pause
+  std::string ueMobility = analyticMobility ? AnalyticRandomMobilityModel::GetTypeId ().GetName ()
+                                            : "ns3::RandomDirection2dMobilityModel";
+  mobility.SetMobilityModel (ueMobility,
                               "Speed", StringValue ("ns3::UniformRandomVariable[Min=10|Max=20]"),
                               "Pause", StringValue ("ns3::ConstantRandomVariable[Constant=0.005]"),
                               "Bounds", RectangleValue (Rectangle (-10, 70, -25, 25)));
@@ -215,18 +255,28 @@ main (int argc, char *argv[])
       ueStaticRouting->SetDefaultRoute (epcHelper->GetUeDefaultGatewayAddress (), 1); // default route
     }
 
-  // Attach one UE per eNodeB
-  for (uint16_t i = 0; i < numNodePairs; i++)
+  if (attachMode == "parity")
   {
-    if (i % 2 == 0)
-    {
-      lteHelper->Attach(ueLteDevs.Get(i), enbLteDevs.Get(0)); // attach UE nodes to the 1st eNB node
-    }
-    else
+    // Attach one UE per eNodeB
+    for (uint16_t i = 0; i < numNodePairs; i++)
     {
-      lteHelper->Attach(ueLteDevs.Get(i), enbLteDevs.Get(1)); // attach UE nodes to the 2nd eNB node
+      if (i % 2 == 0)
+      {
+        lteHelper->Attach(ueLteDevs.Get(i), enbLteDevs.Get(0)); // attach UE nodes to the 1st eNB node
+      }
+      else
+      {
+        lteHelper->Attach(ueLteDevs.Get(i), enbLteDevs.Get(1)); // attach UE nodes to the 2nd eNB node
+      }
+      // side effect: the default EPS bearer will be activated
     }
-    // side effect: the default EPS bearer will be activated
+  }
+  else
+  {
+    // Nearest or strongest eNodeB, found through a spatial index
+    SpatialAttachHelper attachHelper;
+    attachHelper.SetMode (SpatialAttachHelper::ModeFromString (attachMode));
+    attachHelper.Attach (lteHelper, ueLteDevs, enbLteDevs);
   }
   // Create HTTP server helper
   ThreeGppHttpServerHelper serverHelper (remoteHostAddr);
@@ -235,12 +285,24 @@ main (int argc, char *argv[])
   ApplicationContainer serverApps = serverHelper.Install (remoteHostContainer.Get (0));
   Ptr<ThreeGppHttpServer> httpServer = serverApps.Get (0)->GetObject<ThreeGppHttpServer> ();
 
-  // Example of connecting to the trace sources
-  httpServer->TraceConnectWithoutContext ("ConnectionEstablished",
-                                          MakeCallback (&ServerConnectionEstablished));
-  httpServer->TraceConnectWithoutContext ("MainObject", MakeCallback (&MainObjectGenerated));
-  httpServer->TraceConnectWithoutContext ("EmbeddedObject", MakeCallback (&EmbeddedObjectGenerated));
-  httpServer->TraceConnectWithoutContext ("Tx", MakeCallback (&ServerTx));
+  // Counters instead of a log line per packet, unless asked for
+  Ptr<HttpMetricsCollector> httpMetrics;
+  Ptr<HttpQoeTracker> httpQoe;
+  if (httpTrace == "metrics")
+    {
+      httpMetrics = CreateObject<HttpMetricsCollector> ();
+      httpMetrics->Install (serverApps);
+      httpQoe = CreateObject<HttpQoeTracker> ();
+    }
+  else
+    {
+      // Example of connecting to the trace sources
+      httpServer->TraceConnectWithoutContext ("ConnectionEstablished",
+                                              MakeCallback (&ServerConnectionEstablished));
+      httpServer->TraceConnectWithoutContext ("MainObject", MakeCallback (&MainObjectGenerated));
+      httpServer->TraceConnectWithoutContext ("EmbeddedObject", MakeCallback (&EmbeddedObjectGenerated));
+      httpServer->TraceConnectWithoutContext ("Tx", MakeCallback (&ServerTx));
+    }
 
   // Setup HTTP variables for the server
   PointerValue varPtr;
@@ -252,41 +314,137 @@ main (int argc, char *argv[])
 
   // Create HTTP client helper
   ThreeGppHttpClientHelper clientHelper (remoteHostAddr);
-  ApplicationContainer clientApps;
-  // Install HTTP client
-  for (uint32_t u = 0; u < ueNodes.GetN (); ++u)
-  { 
-  
-    // Seed the random number generator
-    std::srand(std::time(0));
-
-    // Generate a random number in the range from 1 to 2
-    int randomNumber = 1 + std::rand() % 2;
+  // Split the UEs between the traffic profiles, reproducibly for a given RngRun
+  TrafficMixHelper trafficMix ({"http", "bulk", "udp", "idle"});
+  trafficMix.SetWeights (trafficMixWeights);
+  trafficMix.AssignStreams (trafficMixStream);
+  trafficMix.Assign (ueNodes);
+  NodeContainer clientNodes = trafficMix.GetNodes ("http");
+
+  // Install HTTP clients on all of them at once, with spread start times
+  StaggeredInstallHelper clientInstaller;
+  clientInstaller.SetStartPattern (StaggeredInstallHelper::PatternFromString (clientStart),
+                                   MilliSeconds (500), clientStartSpread);
+  clientInstaller.AssignStreams (clientStartStream);
+  ApplicationContainer clientApps = clientInstaller.Install (clientHelper, clientNodes);
+  if (httpMetrics)
+    {
+      httpMetrics->Install (clientApps);
+      httpQoe->Install (clientApps);
+    }
+  else
+    {
+      // Example of connecting to the trace sources, of all clients at once
+      const std::string clients = "/NodeList/*/ApplicationList/*/$ns3::ThreeGppHttpClient/";
+      Config::ConnectWithoutContext (clients + "RxMainObject", MakeCallback (&ClientMainObjectReceived));
+      Config::ConnectWithoutContext (clients + "RxEmbeddedObject", MakeCallback (&ClientEmbeddedObjectReceived));
+      Config::ConnectWithoutContext (clients + "Rx", MakeCallback (&ClientRx));
+    }
 
-    if(randomNumber == 1){
-      clientApps = clientHelper.Install (ueNodes.Get (u));
-      Ptr<ThreeGppHttpClient> httpClient = clientApps.Get (0)->GetObject<ThreeGppHttpClient> ();
+  serverApps.Start (MilliSeconds (500));
 
-      // Example of connecting to the trace sources
-      httpClient->TraceConnectWithoutContext ("RxMainObject", MakeCallback (&ClientMainObjectReceived));
-      httpClient->TraceConnectWithoutContext ("RxEmbeddedObject", MakeCallback (&ClientEmbeddedObjectReceived));
-      httpClient->TraceConnectWithoutContext ("Rx", MakeCallback (&ClientRx));
+  // Uplink bulk TCP transfers, each profile installed in one call
+  uint16_t bulkPort = 9;
+  BulkSendHelper bulkHelper ("ns3::TcpSocketFactory", InetSocketAddress (remoteHostAddr, bulkPort));
+  bulkHelper.SetAttribute ("MaxBytes", UintegerValue (200000)); // 200 kB
+  ApplicationContainer bulkApps = trafficMix.Install ("bulk", bulkHelper);
+  clientInstaller.SetStartTimes (bulkApps);
+  if (bulkApps.GetN () > 0)
+    {
+      PacketSinkHelper bulkSink ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), bulkPort));
+      bulkSink.Install (remoteHost).Start (MilliSeconds (500));
     }
 
-    
-  }
-
-  serverApps.Start (MilliSeconds (500));
- clientApps.Start (MilliSeconds (500));
+  // Downlink constant bit rate UDP
+  uint16_t cbrPort = 1234;
+  NodeContainer cbrNodes = trafficMix.GetNodes ("udp");
+  ApplicationContainer cbrApps;
+  for (uint32_t u = 0; u < cbrNodes.GetN (); ++u)
+    {
+      Ipv4Address ueAddr = cbrNodes.Get (u)->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ();
+      UdpClientHelper cbrClient (ueAddr, cbrPort);
+      cbrClient.SetAttribute ("Interval", TimeValue (interPacketInterval));
+      cbrClient.SetAttribute ("MaxPackets", UintegerValue (1000000));
+      cbrApps.Add (cbrClient.Install (remoteHost));
+    }
+  clientInstaller.SetStartTimes (cbrApps);
+  PacketSinkHelper cbrSink ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), cbrPort));
+  trafficMix.Install ("udp", cbrSink).Start (MilliSeconds (500));
   // lteHelper->EnableTraces ();
+  // Sampled per-UE KPIs instead of the per-TTI traces
+  Ptr<LteKpiTracer> kpiTracer;
+  if (kpiInterval.IsStrictlyPositive ())
+    {
+      kpiTracer = CreateObject<LteKpiTracer> ();
+      kpiTracer->SetAttribute ("Interval", TimeValue (kpiInterval));
+      kpiTracer->Start ("lte-epc.kpi");
+    }
 
   
-  p2ph.EnablePcapAll("lte-epc");
+  Ptr<AsyncPcapCapture> pcapCapture;
+  if (pcapMode == "async")
+    {
+      pcapCapture = CreateObject<AsyncPcapCapture> ();
+      pcapCapture->InstallAll ("lte-epc");
+    }
+  else if (pcapMode == "full")
+    {
+      p2ph.EnablePcapAll("lte-epc");
+    }
 
   Simulator::Stop (simTime);
 
-  
+  // Flow statistics are only needed for the run summary
+  FlowMonitorHelper flowMonHelper;
+  Ptr<FlowMonitor> monitor;
+  if (!summaryFile.empty ())
+    {
+      monitor = flowMonHelper.Install (ueNodes);
+      monitor = flowMonHelper.Install (remoteHost);
+    }
+  if (httpMetrics)
+    {
+      httpMetrics->Start ("lte-epc-http.csv");
+    }
+
+  // Progress lines, and a clean early stop on the wall-clock budget or Ctrl-C
+  Ptr<SimulationProgress> progress = CreateObject<SimulationProgress> ();
+  progress->SetAttribute ("ReportInterval", TimeValue (progressInterval));
+  progress->SetAttribute ("WallClockBudget", TimeValue (wallClockBudget));
+  progress->Start (simTime);
+
   Simulator::Run ();
+  progress->Finish ();
+
+  if (kpiTracer)
+    {
+      kpiTracer->Close ();
+    }
+
+  if (httpMetrics)
+    {
+      httpMetrics->Flush ();
+      httpQoe->Write ("lte-epc-http-qoe.csv");
+    }
+  if (pcapCapture)
+    {
+      pcapCapture->Close ();
+    }
+  if (monitor)
+    {
+      monitor->CheckForLostPackets ();
+      RunSummary summary;
+      summary.AddFlowMonitor (monitor);
+      if (httpMetrics)
+        {
+          httpMetrics->AddToSummary (summary);
+          httpQoe->AddToSummary (summary);
+        }
+      trafficMix.AddToSummary (summary);
+      summary.Set ("simTimeS", Simulator::Now ().GetSeconds ());
+      progress->AddToSummary (summary);
+      summary.Write (summaryFile);
+    }
 
   // GtkConfigStore config;
   // config.ConfigureAttributes();
@@ -30,6 +30,12 @@
 #include "ns3/lte-module.h"
 #include "ns3/netanim-module.h"
 #include "ns3/random-waypoint-mobility-model.h"
+#include <fstream>
+
+#include "analytic-random-mobility-model.h"
+#include "burst-udp-client.h"
+#include "lte-kpi-tracer.h"
+#include "multi-port-udp-sink.h"
 
 
 
@@ -53,6 +59,11 @@ main (int argc, char *argv[])
   bool disableDl = false;
   bool disableUl = false;
   bool disablePl = false;
+  bool analyticMobility = true;
+  uint32_t udpBurst = 0;
+  std::string udpSchedule = "cbr";
+  Time kpiInterval = Seconds (0);
+  std::string sinkMode = "multi";
 
   // Command line arguments
   CommandLine cmd;
@@ -63,6 +74,11 @@ main (int argc, char *argv[])
   cmd.AddValue ("disableDl", "Disable downlink data flows", disableDl);
   cmd.AddValue ("disableUl", "Disable uplink data flows", disableUl);
   cmd.AddValue ("disablePl", "Disable data flows between peer UEs", disablePl);
+  cmd.AddValue ("analyticMobility", "Move the UEs with ns3::AnalyticRandomMobilityModel (positions computed when read) instead of RandomDirection2dMobilityModel (an event per leg and pause)", analyticMobility);
+  cmd.AddValue ("udpBurst", "Datagrams per event of the UDP clients (ns3::BurstUdpClient); 0 keeps UdpClient", udpBurst);
+  cmd.AddValue ("udpSchedule", "Bursts of the UDP clients when udpBurst > 0: cbr or poisson", udpSchedule);
+  cmd.AddValue ("kpiInterval", "Aggregation interval of the per-UE LTE KPI trace in lte-epc.kpi, read with lte-kpi-dump (0 disables it)", kpiInterval);
+  cmd.AddValue ("sinkMode", "UDP sinks: multi (one ns3::MultiPortUdpSink per node, all uplink flows on one remote host port, per-flow counters in lte-epc-sinks.csv) or packetSink (one PacketSink per flow)", sinkMode);
   cmd.Parse (argc, argv);
 
   // ConfigStore inputConfig;
@@ -117,7 +133,11 @@ main (int argc, char *argv[])
     }
   MobilityHelper mobility;
   // Install the mobility model to the nodes
-  mobility.SetMobilityModel ("ns3::RandomDirection2dMobilityModel",
+  // Same random direction motion either way; the analytic model computes
+  // the positions when they are read instead of scheduling every leg and pause
+  std::string ueMobility = analyticMobility ? AnalyticRandomMobilityModel::GetTypeId ().GetName ()
+                                            : "ns3::RandomDirection2dMobilityModel";
+  mobility.SetMobilityModel (ueMobility,
                               "Speed", StringValue ("ns3::UniformRandomVariable[Min=10|Max=20]"),
                               "Pause", StringValue ("ns3::ConstantRandomVariable[Constant=0.005]"),
                               "Bounds", RectangleValue (Rectangle (-10, 70, -25, 25)));
@@ -154,53 +174,97 @@ main (int argc, char *argv[])
     }
 
 
+  // UDP flow at interPacketInterval from a node, through UdpClient or in bursts
+  auto installUdpClient = [&] (Address remote, uint16_t port, Ptr<Node> node) {
+    if (udpBurst == 0)
+      {
+        UdpClientHelper client (remote, port);
+        client.SetAttribute ("Interval", TimeValue (interPacketInterval));
+        client.SetAttribute ("MaxPackets", UintegerValue (1000000));
+        return client.Install (node);
+      }
+    BurstUdpClientHelper client (remote, port);
+    client.SetAttribute ("Interval", TimeValue (interPacketInterval));
+    client.SetAttribute ("MaxPackets", UintegerValue (1000000));
+    client.SetAttribute ("BurstSize", UintegerValue (udpBurst));
+    client.SetAttribute ("Schedule", StringValue (udpSchedule));
+    return client.Install (node);
+  };
+
   // Install and start applications on UEs and remote host
   uint16_t dlPort = 1100;
   uint16_t ulPort = 2000;
   uint16_t otherPort = 3000;
   ApplicationContainer clientApps;
   ApplicationContainer serverApps;
+  // One sink per node: the downlink and peer ports of every UE, and a single
+  // port on the remote host for all uplink flows, told apart by their source
+  NS_ABORT_MSG_IF (sinkMode != "multi" && sinkMode != "packetSink",
+                   "Unknown sinkMode \"" << sinkMode << "\", expected multi or packetSink");
+  const bool multiSink = sinkMode == "multi";
+  if (multiSink)
+    {
+      MultiPortUdpSinkHelper ueSink (dlPort, 2);
+      ueSink.SetAttribute ("DelayStats", BooleanValue (true));
+      serverApps.Add (ueSink.Install (ueNodes));
+      if (!disableUl)
+        {
+          MultiPortUdpSinkHelper remoteHostSink (ulPort);
+          remoteHostSink.SetAttribute ("DelayStats", BooleanValue (true));
+          serverApps.Add (remoteHostSink.Install (remoteHost));
+        }
+    }
   for (uint32_t u = 0; u < ueNodes.GetN (); ++u)
     {
       if (!disableDl)
         {
-          PacketSinkHelper dlPacketSinkHelper ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), dlPort));
-          serverApps.Add (dlPacketSinkHelper.Install (ueNodes.Get (u)));
+          if (!multiSink)
+            {
+              PacketSinkHelper dlPacketSinkHelper ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), dlPort));
+              serverApps.Add (dlPacketSinkHelper.Install (ueNodes.Get (u)));
+            }
 
-          UdpClientHelper dlClient (ueIpIface.GetAddress (u), dlPort); // udp client
-          dlClient.SetAttribute ("Interval", TimeValue (interPacketInterval));
-          dlClient.SetAttribute ("MaxPackets", UintegerValue (1000000));
-          clientApps.Add (dlClient.Install (remoteHost));
+          clientApps.Add (installUdpClient (ueIpIface.GetAddress (u), dlPort, remoteHost));
         }
 
       if (!disableUl)
         {
-          ++ulPort;
-          PacketSinkHelper ulPacketSinkHelper ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), ulPort));
-          serverApps.Add (ulPacketSinkHelper.Install (remoteHost));
-
-          UdpClientHelper ulClient (remoteHostAddr, ulPort); // udp client
-          ulClient.SetAttribute ("Interval", TimeValue (interPacketInterval));
-          ulClient.SetAttribute ("MaxPackets", UintegerValue (1000000));
-          clientApps.Add (ulClient.Install (ueNodes.Get(u)));
+          if (!multiSink)
+            {
+              ++ulPort;
+              PacketSinkHelper ulPacketSinkHelper ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), ulPort));
+              serverApps.Add (ulPacketSinkHelper.Install (remoteHost));
+            }
+
+          clientApps.Add (installUdpClient (remoteHostAddr, ulPort, ueNodes.Get (u)));
         }
 
       if (!disablePl && numNodePairs > 1)
         {
-          ++otherPort;
-          PacketSinkHelper packetSinkHelper ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), otherPort));
-          serverApps.Add (packetSinkHelper.Install (ueNodes.Get (u)));
-
-          UdpClientHelper client (ueIpIface.GetAddress (u), otherPort); // udp client
-          client.SetAttribute ("Interval", TimeValue (interPacketInterval));
-          client.SetAttribute ("MaxPackets", UintegerValue (1000000));
-          clientApps.Add (client.Install (ueNodes.Get ((u + 1) % numNodePairs)));
+          uint16_t peerPort = dlPort + 1;
+          if (!multiSink)
+            {
+              peerPort = ++otherPort;
+              PacketSinkHelper packetSinkHelper ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), peerPort));
+              serverApps.Add (packetSinkHelper.Install (ueNodes.Get (u)));
+            }
+
+          clientApps.Add (installUdpClient (ueIpIface.GetAddress (u), peerPort,
+                                            ueNodes.Get ((u + 1) % numNodePairs)));
         }
     }
 
   serverApps.Start (MilliSeconds (500));
   clientApps.Start (MilliSeconds (500));
   // lteHelper->EnableTraces ();
+  // Sampled per-UE KPIs instead of the per-TTI traces
+  Ptr<LteKpiTracer> kpiTracer;
+  if (kpiInterval.IsStrictlyPositive ())
+    {
+      kpiTracer = CreateObject<LteKpiTracer> ();
+      kpiTracer->SetAttribute ("Interval", TimeValue (kpiInterval));
+      kpiTracer->Start ("lte-epc.kpi");
+    }
 
   
   p2ph.EnablePcapAll("lte-epc");
@@ -210,6 +274,20 @@ main (int argc, char *argv[])
   
   Simulator::Run ();
 
+  if (kpiTracer)
+    {
+      kpiTracer->Close ();
+    }
+  if (multiSink)
+    {
+      std::ofstream sinks ("lte-epc-sinks.csv");
+      MultiPortUdpSink::PrintHeader (sinks);
+      for (auto it = serverApps.Begin (); it != serverApps.End (); ++it)
+        {
+          DynamicCast<MultiPortUdpSink> (*it)->Print (sinks);
+        }
+    }
+
   // GtkConfigStore config;
   // config.ConfigureAttributes();
 
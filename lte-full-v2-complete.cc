@@ -19,8 +19,27 @@
  *         Dinh Thao Le <Dinh.Thao.Le@vutbr.cz>
 */
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <memory>
 #include <string>
+#include <vector>
+
+#include "async-pcap-capture.h"
+#include "binary-animation-trace.h"
+#include "burst-udp-client.h"
+#include "cached-propagation-loss-model.h"
+#include "coalescing-bulk-send.h"
+#include "flow-delay-quantiles.h"
+#include "component-carrier-stats.h"
+#include "flow-monitor-columnar.h"
+#include "flow-stats-collector.h"
+#include "load-aware-component-carrier-manager.h"
+#include "lte-kpi-tracer.h"
+#include "run-summary.h"
+#include "spatial-attach-helper.h"
+#include "traffic-mix-helper.h"
 
 #include "ns3/lte-helper.h"
 #include "ns3/epc-helper.h"
@@ -53,6 +72,24 @@ int main(int argc, char *argv[]) {
   double interval = 50.0; // ms
   double distance = 200.0;
   bool useCa = true;
+  uint16_t numberOfCarriers = 2;
+  std::string ccManager = "ns3::LoadAwareComponentCarrierManager";
+  std::string flowmonFormat = "xml";
+  std::string summaryFile;
+  std::string attachMode = "cellSearch";
+  std::string pcapMode = "full";
+  std::string animFormat = "xml";
+  std::string bulkApp = "coalescing";
+  uint32_t bulkMinWrite = 1448;
+  uint32_t udpBurst = 0;
+  std::string udpSchedule = "cbr";
+  std::string udpTrace;
+  double timeSeriesBin = 100.0; // ms
+  bool delayQuantiles = true;
+  double kpiInterval = 0.0; // ms
+  bool pathlossCache = true;
+  std::string trafficMixWeights = "bulk=1,udp=1";
+  int64_t trafficMixStream = 2000;
 
   // Command line arguments
   CommandLine cmd;
@@ -60,13 +97,33 @@ int main(int argc, char *argv[]) {
   cmd.AddValue("simTime", "Total duration of the simulation [s])", simTime);
   cmd.AddValue("distance", "Distance between eNBs [m]", distance);
   cmd.AddValue("useCa", "Whether to use carrier aggregation.", useCa);
+  cmd.AddValue("numberOfCarriers", "Component carriers per eNB when useCa is set", numberOfCarriers);
+  cmd.AddValue("ccManager", "eNB component carrier manager when useCa is set", ccManager);
   cmd.AddValue("interval", "Inter-packet interval for UDP client [ms]", interval);
+  cmd.AddValue("flowmonFormat", "Format of the final flow monitor dump (xml or columnar)", flowmonFormat);
+  cmd.AddValue("summaryFile", "CSV file receiving the aggregate run metrics", summaryFile);
+  cmd.AddValue("attachMode", "Initial attachment: cellSearch, nearest or strongest (spatial index)", attachMode);
+  cmd.AddValue("pcapMode", "Capture of the point-to-point links: full, async (truncated, background writer, see ns3::AsyncPcapCapture) or none", pcapMode);
+  cmd.AddValue("animFormat", "NetAnim output: xml, binary (lte-full.anim, convert with anim-to-netanim) or none", animFormat);
+  cmd.AddValue("bulkApp", "TCP bulk client: coalescing (large shared-payload writes, see ns3::CoalescingBulkSendApplication) or bulk (BulkSend, 100-byte writes)", bulkApp);
+  cmd.AddValue("bulkMinWrite", "Smallest socket write of the coalescing bulk client [bytes]", bulkMinWrite);
+  cmd.AddValue("udpBurst", "Datagrams per event of the UDP client (ns3::BurstUdpClient); 0 keeps UdpClient", udpBurst);
+  cmd.AddValue("udpSchedule", "Bursts of the UDP client when udpBurst > 0: cbr, poisson or trace", udpSchedule);
+  cmd.AddValue("udpTrace", "Burst times of the trace schedule, \"<seconds> [datagrams]\" per line", udpTrace);
+  cmd.AddValue("timeSeriesBin", "Bin of the per-flow throughput and delay series in lte-full-timeseries.csv [ms] (0 disables them)", timeSeriesBin);
+  cmd.AddValue("delayQuantiles", "Record per-flow and per-cell delay and jitter quantiles (p50 to p99.9)", delayQuantiles);
+  cmd.AddValue("kpiInterval", "Aggregation interval of the per-UE RSRP/SINR/CQI/MCS/RLC buffer trace in lte-full.kpi, read with lte-kpi-dump [ms] (0 disables it)", kpiInterval);
+  cmd.AddValue("pathlossCache", "Compute the pathloss of every static eNB/UE pair once (ns3::CachedPropagationLossModel around Friis)", pathlossCache);
+  cmd.AddValue("trafficMix", "Weights of the UE traffic profiles: bulk (TCP bulk client), udp (UDP client) and idle, e.g. bulk=2,udp=1,idle=1", trafficMixWeights);
+  cmd.AddValue("trafficMixStream", "Random stream of the placement of the traffic profiles", trafficMixStream);
   cmd.Parse(argc, argv);
 
   if (useCa) {
+      // Keep the scratch library type linked in, it is only named by string
+      LoadAwareComponentCarrierManager::GetTypeId();
       Config::SetDefault("ns3::LteHelper::UseCa", BooleanValue(useCa));
-      Config::SetDefault("ns3::LteHelper::NumberOfComponentCarriers", UintegerValue(2));
-      Config::SetDefault("ns3::LteHelper::EnbComponentCarrierManager", StringValue("ns3::RrComponentCarrierManager"));
+      Config::SetDefault("ns3::LteHelper::NumberOfComponentCarriers", UintegerValue(numberOfCarriers));
+      Config::SetDefault("ns3::LteHelper::EnbComponentCarrierManager", StringValue(ccManager));
   }
 
   ConfigStore inputConfig;
@@ -78,6 +135,10 @@ int main(int argc, char *argv[]) {
   Ptr<LteHelper> lteHelper = CreateObject<LteHelper> (); // create LteHelper object
   Ptr<PointToPointEpcHelper>  epcHelper = CreateObject<PointToPointEpcHelper> (); // PointToPointEpcHelper
   lteHelper->SetEpcHelper (epcHelper); // enable the use of EPC by LTE helper
+  if (pathlossCache) {
+      // All nodes are static: the pathloss of a pair only changes with a CourseChange
+      lteHelper->SetPathlossModelType(CachedPropagationLossModel::GetTypeId());
+  }
 
   // EJERCICIO
 
@@ -189,7 +250,16 @@ int main(int argc, char *argv[]) {
     }
 
   // Attach UEs to eNodeBs
-  lteHelper->Attach(ueLteDevs);
+  if (attachMode == "cellSearch")
+    {
+      lteHelper->Attach(ueLteDevs);
+    }
+  else
+    {
+      SpatialAttachHelper attachHelper;
+      attachHelper.SetMode(SpatialAttachHelper::ModeFromString(attachMode));
+      attachHelper.Attach(lteHelper, ueLteDevs, enbLteDevs);
+    }
 
   // Create BulkSendApplication as 1st client application
   uint16_t port = 9; // First half of UEs
@@ -197,6 +267,10 @@ int main(int argc, char *argv[]) {
   // Set the amount of data to send in bytes. Zero is unlimited .
   source.SetAttribute("MaxBytes", UintegerValue(200000)); //200 kB
   source.SetAttribute("SendSize", UintegerValue(100));
+  // Same transfer in a few large writes sharing one payload buffer
+  CoalescingBulkSendHelper coalescingSource("ns3::TcpSocketFactory", InetSocketAddress(remoteHostAddr, port));
+  coalescingSource.SetAttribute("MaxBytes", UintegerValue(200000));
+  coalescingSource.SetAttribute("MinWriteSize", UintegerValue(bulkMinWrite));
 
 
   //ApplicationContainer sourceApps;
@@ -214,21 +288,40 @@ int main(int argc, char *argv[]) {
   UdpClientHelper ulClient (remoteHostAddr, port2);
   ulClient.SetAttribute("Interval", TimeValue(MilliSeconds(interval)));
   ulClient.SetAttribute("MaxPackets", UintegerValue(1000000));
+  // Same offered load, udpBurst datagrams per scheduled event
+  BurstUdpClientHelper burstClient (remoteHostAddr, port2);
+  burstClient.SetAttribute("Interval", TimeValue(MilliSeconds(interval)));
+  burstClient.SetAttribute("MaxPackets", UintegerValue(1000000));
+  burstClient.SetAttribute("BurstSize", UintegerValue(std::max<uint32_t>(udpBurst, 1)));
+  burstClient.SetAttribute("Schedule", StringValue(udpSchedule));
+  burstClient.SetAttribute("TraceFile", StringValue(udpTrace));
 
   ApplicationContainer sourceApps;
   ApplicationContainer sourceApps2;
 
-  for (uint16_t i = 0; i < numberOfUes; i++)
-    {
-      if (i < numberOfUes/2) {
-        sourceApps.Add(source.Install(ueNodes.Get(i)));
-      }
-      else {
-        sourceApps2.Add(ulClient.Install(ueNodes.Get(i)));
-    }
+  // Split the UEs between the traffic profiles, reproducibly for a given
+  // RngRun, and install each profile on all its UEs at once
+  TrafficMixHelper trafficMix({"bulk", "udp", "idle"});
+  trafficMix.SetWeights(trafficMixWeights);
+  trafficMix.AssignStreams(trafficMixStream);
+  trafficMix.Assign(ueNodes);
+  NS_ABORT_MSG_IF(bulkApp != "bulk" && bulkApp != "coalescing",
+                  "Unknown bulkApp \"" << bulkApp << "\", expected coalescing or bulk");
+  if (bulkApp == "bulk") {
+      sourceApps = trafficMix.Install("bulk", source);
+  }
+  else {
+      sourceApps = trafficMix.Install("bulk", coalescingSource);
+  }
+  if (udpBurst == 0) {
+      sourceApps2 = trafficMix.Install("udp", ulClient);
+  }
+  else {
+      sourceApps2 = trafficMix.Install("udp", burstClient);
+  }
 
-    sourceApps.Start(Seconds(0.5));
-    sourceApps.Start(Seconds(0.5));
+  sourceApps.Start(Seconds(0.5));
+  sourceApps2.Start(Seconds(0.5));
 
   // Create a PacketSinkApplication and install it on Remote host
   PacketSinkHelper sink("ns3::TcpSocketFactory", InetSocketAddress(Ipv4Address::GetAny(), port));
@@ -237,39 +330,86 @@ int main(int argc, char *argv[]) {
 
   // Uncomment to enable traces
   // lteHelper->EnableTraces();
+  // Sampled per-UE KPIs, under a kilobyte per UE and second instead of
+  // the per-TTI text traces
+  Ptr<LteKpiTracer> kpiTracer;
+  if (kpiInterval > 0) {
+      kpiTracer = CreateObject<LteKpiTracer>();
+      kpiTracer->SetAttribute("Interval", TimeValue(MilliSeconds(kpiInterval)));
+      kpiTracer->Start("lte-full.kpi");
+  }
 
-  // Animation definition
-  AnimationInterface anim("lte-full.xml");
-  
+  // Animation definition, as XML or as a compact binary trace converted
+  // offline with anim-to-netanim
+  std::unique_ptr<AnimationInterface> anim;
+  Ptr<BinaryAnimationTrace> binaryAnim;
+  if (animFormat == "xml")
+    {
+      anim = std::make_unique<AnimationInterface> ("lte-full.xml");
 
-  /// Optional step
-  anim.SetMobilityPollInterval (Seconds (0.75));
-  
-  // Uncomment to enable recording of packet Metadata
-  // anim.EnablePacketMetadata(true);
+      /// Optional step
+      anim->SetMobilityPollInterval (Seconds (0.75));
 
-  unsigned long long maxAnimPackets = 0xFFFFFFFFFFFFFFFF;
-  anim.SetMaxPktsPerTraceFile(maxAnimPackets);
-  
-  anim.UpdateNodeDescription(pgw, "PGW");
-  anim.UpdateNodeDescription(remoteHost, "RemoteHost");
-  anim.UpdateNodeDescription(1, "SGW");
-  anim.UpdateNodeDescription(2, "MME");
+      // Uncomment to enable recording of packet Metadata
+      // anim->EnablePacketMetadata(true);
+
+      unsigned long long maxAnimPackets = 0xFFFFFFFFFFFFFFFF;
+      anim->SetMaxPktsPerTraceFile(maxAnimPackets);
+    }
+  else if (animFormat == "binary")
+    {
+      binaryAnim = CreateObject<BinaryAnimationTrace> ();
+      binaryAnim->Start ("lte-full.anim");
+    }
+  auto describeNode = [&] (uint32_t nodeId, const std::string& description) {
+    if (anim)
+      {
+        anim->UpdateNodeDescription (nodeId, description);
+      }
+    if (binaryAnim)
+      {
+        binaryAnim->UpdateNodeDescription (nodeId, description);
+      }
+  };
+  auto colorNode = [&] (uint32_t nodeId, uint8_t r, uint8_t g, uint8_t b) {
+    if (anim)
+      {
+        anim->UpdateNodeColor (nodeId, r, g, b);
+      }
+    if (binaryAnim)
+      {
+        binaryAnim->UpdateNodeColor (nodeId, r, g, b);
+      }
+  };
+
+  describeNode(pgw->GetId(), "PGW");
+  describeNode(remoteHost->GetId(), "RemoteHost");
+  describeNode(1, "SGW");
+  describeNode(2, "MME");
 
   for (uint32_t u = 0; u < ueNodes.GetN(); ++u)
     {
-      anim.UpdateNodeDescription(ueNodes.Get(u), "Ue_" + std::to_string(u));
-      anim.UpdateNodeColor(ueNodes.Get(u), 0, 0, 255); // Optional
+      describeNode(ueNodes.Get(u)->GetId(), "Ue_" + std::to_string(u));
+      colorNode(ueNodes.Get(u)->GetId(), 0, 0, 255); // Optional
    }
 
   for (uint32_t u = 0; u < enbNodes.GetN(); ++u)
     {
-      anim.UpdateNodeDescription(enbNodes.Get(u), "eNodeB_" + std::to_string(u));
-      anim.UpdateNodeColor(enbNodes.Get(u), 0, 255, 0); // Optional
+      describeNode(enbNodes.Get(u)->GetId(), "eNodeB_" + std::to_string(u));
+      colorNode(enbNodes.Get(u)->GetId(), 0, 255, 0); // Optional
     }
 
   // Uncomment to enable PCAP tracing
-  p2ph.EnablePcapAll("lte-full");
+  Ptr<AsyncPcapCapture> pcapCapture;
+  if (pcapMode == "async")
+    {
+      pcapCapture = CreateObject<AsyncPcapCapture> ();
+      pcapCapture->InstallAll ("lte-full");
+    }
+  else if (pcapMode == "full")
+    {
+      p2ph.EnablePcapAll("lte-full");
+    }
 
   Ptr <FlowMonitor> monitor; // = flowMonHelper.InstallAll();
   FlowMonitorHelper flowMonHelper;
@@ -277,23 +417,86 @@ int main(int argc, char *argv[]) {
   monitor = flowMonHelper.Install(ueNodes);
   monitor = flowMonHelper.Install(remoteHost);
 
+  // Tail delay and jitter per flow and per cell, in constant memory per flow
+  Ptr<FlowDelayQuantiles> delayStats;
+  if (delayQuantiles) {
+      delayStats = CreateObject<FlowDelayQuantiles>();
+      delayStats->Install(NodeContainer::GetGlobal());
+  }
+
+  // Per-flow throughput and delay bins, bounded in memory, exported at the end
+  Ptr<FlowStatsCollector> timeSeries;
+  if (timeSeriesBin > 0) {
+      timeSeries = CreateObject<FlowStatsCollector>();
+      timeSeries->SetAttribute("BinWidth", TimeValue(MilliSeconds(timeSeriesBin)));
+      timeSeries->Install(monitor, DynamicCast<Ipv4FlowClassifier>(flowMonHelper.GetClassifier()), "");
+  }
+
+  // Cell throughput of every component carrier, for the run summary
+  Ptr<ComponentCarrierStats> carrierStats;
+  if (!summaryFile.empty()) {
+      carrierStats = CreateObject<ComponentCarrierStats>();
+      carrierStats->Install();
+  }
+
   Simulator::Stop(Seconds(simTime));
+  const auto runStart = std::chrono::steady_clock::now();
   Simulator::Run();
+  const std::chrono::duration<double> runWall = std::chrono::steady_clock::now() - runStart;
+
+  if (timeSeries) {
+      timeSeries->Flush();
+      timeSeries->WriteSeries("lte-full-timeseries.csv");
+  }
+  if (kpiTracer) {
+      kpiTracer->Close();
+  }
+  if (pcapCapture)
+    {
+      pcapCapture->Close ();
+    }
+  if (binaryAnim)
+    {
+      binaryAnim->Close ();
+    }
 
   // GnuPlot
   std::string jmenoSouboru = "delay";
   std::string graphicsFileName = jmenoSouboru + ".png";
   std::string plotFileName = jmenoSouboru + ".plt";
-  std::string plotTitle = "Average delay";
+  std::string plotTitle = "Delay per flow";
   std::string dataTitle = "Delay [ms]";
   Gnuplot gnuplot(graphicsFileName);
   gnuplot.SetTitle(plotTitle);
   gnuplot.SetTerminal("png");
   gnuplot.SetLegend("IDs of data streams", "Delay [ms]");
-  gnuplot.AppendExtra("set xrange [1:" + std::to_string(numberOfUes * 2) + "]");
-  gnuplot.AppendExtra("set yrange [0:500]");
+  gnuplot.AppendExtra("set yrange [0:*]");
   gnuplot.AppendExtra("set grid");
-  Gnuplot2dDataset dataset_delay;
+  Gnuplot2dDataset dataset_delay("mean");
+  // Tail percentiles, per flow and per cell, for the delay and the jitter
+  const std::pair<double, std::string> quantiles[] = {
+      {0.5, "p50"},
+      {0.95, "p95"},
+      {0.99, "p99"},
+      {0.999, "p99.9"},
+  };
+  std::vector<Gnuplot2dDataset> dataset_delayQ;
+  std::vector<Gnuplot2dDataset> dataset_jitterQ;
+  for (const auto& [q, name] : quantiles) {
+      dataset_delayQ.emplace_back(name);
+      dataset_jitterQ.emplace_back(name);
+  }
+
+  jmenoSouboru = "jitter";
+  graphicsFileName = jmenoSouboru + ".png";
+  std::string plotFileNameJitter = jmenoSouboru + ".plt";
+  Gnuplot gnuplot_jitter(graphicsFileName);
+  gnuplot_jitter.SetTitle("Jitter per flow");
+  gnuplot_jitter.SetTerminal("png");
+  gnuplot_jitter.SetLegend("IDs of data streams", "Jitter [ms]");
+  gnuplot_jitter.AppendExtra("set yrange [0:*]");
+  gnuplot_jitter.AppendExtra("set grid");
+  Gnuplot2dDataset dataset_jitter("mean");
 
   jmenoSouboru = "datarate";
   graphicsFileName = jmenoSouboru + ".png";
@@ -304,7 +507,6 @@ int main(int argc, char *argv[]) {
   gnuplot_DR.SetTitle(plotTitle);
   gnuplot_DR.SetTerminal("png");
   gnuplot_DR.SetLegend("IDs of all streams", "Data rate [kbps]");
-  gnuplot_DR.AppendExtra("set xrange [1:" + std::to_string(numberOfUes * 2) + "]");
   gnuplot_DR.AppendExtra("set yrange [0:2500]");
   gnuplot_DR.AppendExtra("set grid");
   Gnuplot2dDataset dataset_rate;
@@ -313,7 +515,41 @@ int main(int argc, char *argv[]) {
   Ptr <Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(flowMonHelper.GetClassifier());
   std::map <FlowId, FlowMonitor::FlowStats> stats = monitor->GetFlowStats();
 
-  monitor->SerializeToXmlFile("lte-full.flowmon", true, true);
+  if (!summaryFile.empty()) {
+      RunSummary summary;
+      summary.AddFlowMonitor(monitor);
+      carrierStats->AddToSummary(summary, numberOf_eNodeBs);
+      if (delayStats) {
+          delayStats->AddToSummary(summary);
+      }
+      summary.Set("numberOfCarriers", useCa ? numberOfCarriers : 1);
+      trafficMix.AddToSummary(summary);
+      summary.Set("simTimeS", Simulator::Now().GetSeconds());
+      summary.AddRunCost(runWall.count());
+      uint64_t bulkWrites = 0;
+      for (auto it = sourceApps.Begin(); it != sourceApps.End(); ++it) {
+          if (auto app = DynamicCast<CoalescingBulkSendApplication>(*it)) {
+              bulkWrites += app->GetWrites();
+          }
+      }
+      summary.Set("bulkSocketWrites", bulkWrites);
+      if (auto cache = DynamicCast<CachedPropagationLossModel>(lteHelper->GetDownlinkSpectrumChannel()->GetPropagationLossModel())) {
+          const uint64_t lookups = cache->GetHits() + cache->GetMisses();
+          summary.Set("dlPathlossCacheHitRatio", lookups > 0 ? double(cache->GetHits()) / lookups : 0.0);
+      }
+      summary.Write(summaryFile);
+  }
+
+  if (flowmonFormat == "columnar") {
+      SerializeFlowMonitorToColumnarFile(monitor, classifier, "lte-full.flowcol", true);
+  }
+  else {
+      monitor->SerializeToXmlFile("lte-full.flowmon", true, true);
+  }
+
+  if (delayStats) {
+      delayStats->Write("lte-full-delay-quantiles.csv", monitor, classifier);
+  }
 
   std::cout << std::endl << "*** Flow monitor statistic ***" << std::endl;
   for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator i = stats.begin(); i != stats.end(); ++i) {
@@ -335,7 +571,20 @@ int main(int argc, char *argv[]) {
       DataRate = i->second.rxBytes * 8.0 / (i->second.timeLastRxPacket.GetSeconds() - i->second.timeFirstTxPacket.GetSeconds()) / 1024;
 
       dataset_delay.Add((double) i->first, (double) Delay);
+      if (const auto* d = delayStats ? delayStats->GetFlow(t) : nullptr) {
+          std::cout << "Delay p50/p95/p99/p99.9: " << d->delay.GetQuantile(0.5) << "/" << d->delay.GetQuantile(0.95) << "/"
+                    << d->delay.GetQuantile(0.99) << "/" << d->delay.GetQuantile(0.999) << "ms" << std::endl;
+          std::cout << "Jitter p50/p95/p99/p99.9: " << d->jitter.GetQuantile(0.5) << "/" << d->jitter.GetQuantile(0.95) << "/"
+                    << d->jitter.GetQuantile(0.99) << "/" << d->jitter.GetQuantile(0.999) << "ms" << std::endl;
+          for (std::size_t k = 0; k < std::size(quantiles); ++k) {
+              dataset_delayQ[k].Add((double) i->first, d->delay.GetQuantile(quantiles[k].first));
+              dataset_jitterQ[k].Add((double) i->first, d->jitter.GetQuantile(quantiles[k].first));
+          }
+      }
       dataset_rate.Add((double) i->first, (double) DataRate);
+      if (i->second.rxPackets > 1) {
+          dataset_jitter.Add((double) i->first, i->second.jitterSum.GetSeconds() / (i->second.rxPackets - 1) * 1000);
+      }
       std::cout << "Jitter sum: " << i->second.jitterSum.GetMilliSeconds() << "ms" << std::endl;
       std::cout << "Mean jitter: " << (i->second.jitterSum.GetSeconds() / (i->second.rxPackets - 1)) * 1000 << "ms" << std::endl;
       // std::cout << "Lost Packets: " << i->second.lostPackets << std::endl;
@@ -345,16 +594,57 @@ int main(int argc, char *argv[]) {
 
   }
 
-  // Gnuplot - continuation
+  // Gnuplot - continuation, one x position per flow
+  const std::string xrange = "set xrange [0:" + std::to_string(stats.size() + 1) + "]";
+  gnuplot.AppendExtra(xrange);
+  gnuplot_DR.AppendExtra(xrange);
+  gnuplot_jitter.AppendExtra(xrange);
   gnuplot.AddDataset(dataset_delay);
+  gnuplot_jitter.AddDataset(dataset_jitter);
+  if (delayStats) {
+      for (std::size_t k = 0; k < std::size(quantiles); ++k) {
+          gnuplot.AddDataset(dataset_delayQ[k]);
+          gnuplot_jitter.AddDataset(dataset_jitterQ[k]);
+      }
+  }
   std::ofstream plotFile(plotFileName.c_str());
   gnuplot.GenerateOutput(plotFile);
   plotFile.close();
+  std::ofstream plotFileJitter(plotFileNameJitter.c_str());
+  gnuplot_jitter.GenerateOutput(plotFileJitter);
+  plotFileJitter.close();
   gnuplot_DR.AddDataset(dataset_rate);
   std::ofstream plotFileDR(plotFileNameDR.c_str());
   gnuplot_DR.GenerateOutput(plotFileDR);
   plotFileDR.close();
 
+  // Gnuplot - delay and jitter percentiles per serving cell (0: no LTE endpoint)
+  if (delayStats) {
+      const std::vector<uint16_t> cells = delayStats->GetCellIds();
+      const std::string cellRange = "set xrange [-1:" + std::to_string(cells.empty() ? 1 : cells.back() + 1) + "]";
+      for (const std::string metric : {"delay", "jitter"}) {
+          jmenoSouboru = "cell_" + metric;
+          Gnuplot gnuplot_cell(jmenoSouboru + ".png");
+          gnuplot_cell.SetTitle("Percentiles of the " + metric + " per cell");
+          gnuplot_cell.SetTerminal("png");
+          gnuplot_cell.SetLegend("Cell ID", (metric == "delay" ? "Delay" : "Jitter") + std::string(" [ms]"));
+          gnuplot_cell.AppendExtra("set yrange [0:*]");
+          gnuplot_cell.AppendExtra("set grid");
+          gnuplot_cell.AppendExtra(cellRange);
+          for (const auto& [q, name] : quantiles) {
+              Gnuplot2dDataset dataset_cell(name);
+              for (uint16_t cell : cells) {
+                  const auto* d = delayStats->GetCell(cell);
+                  const auto& hist = metric == "delay" ? d->delay : d->jitter;
+                  dataset_cell.Add(cell, hist.GetQuantile(q));
+              }
+              gnuplot_cell.AddDataset(dataset_cell);
+          }
+          std::ofstream plotFileCell(jmenoSouboru + ".plt");
+          gnuplot_cell.GenerateOutput(plotFileCell);
+      }
+  }
+
   Simulator::Destroy();
   return 0;
-}}
+}
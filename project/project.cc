@@ -2,6 +2,20 @@
 
 #include "functions.cc"
 
+#include "analytic-random-mobility-model.h"
+#include "async-pcap-capture.h"
+#include "binary-animation-trace.h"
+#include "cached-propagation-loss-model.h"
+#include "flow-delay-quantiles.h"
+#include "flow-monitor-columnar.h"
+#include "flow-stats-collector.h"
+#include "http-metrics-collector.h"
+#include "http-qoe-tracker.h"
+#include "run-summary.h"
+#include "simulation-progress.h"
+#include "spatial-attach-helper.h"
+#include "staggered-install-helper.h"
+
 #include "ns3/applications-module.h"
 #include "ns3/buildings-module.h"
 #include "ns3/buildings-propagation-loss-model.h"
@@ -20,7 +34,7 @@
 #include "ns3/point-to-point-module.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/traffic-control-module.h"
-#include <random>
+#include <memory>
 
 using namespace ns3;
 
@@ -59,13 +73,13 @@ ClientRx(Ptr<const Packet> packet, const Address& address)
 void
 ClientMainObjectReceived(Ptr<const ThreeGppHttpClient>, Ptr<const Packet> packet)
 {
-    Ptr<Packet> p = packet->Copy();
     ThreeGppHttpHeader header;
-    p->RemoveHeader(header);
-    if (header.GetContentLength() == p->GetSize() &&
+    const uint32_t headerSize = packet->PeekHeader(header);
+    const uint32_t contentSize = packet->GetSize() - headerSize;
+    if (header.GetContentLength() == contentSize &&
         header.GetContentType() == ThreeGppHttpHeader::MAIN_OBJECT)
     {
-        NS_LOG_INFO("Client has successfully received a main object of " << p->GetSize()
+        NS_LOG_INFO("Client has successfully received a main object of " << contentSize
                                                                          << " bytes.");
     }
     else
@@ -77,13 +91,13 @@ ClientMainObjectReceived(Ptr<const ThreeGppHttpClient>, Ptr<const Packet> packet
 void
 ClientEmbeddedObjectReceived(Ptr<const ThreeGppHttpClient>, Ptr<const Packet> packet)
 {
-    Ptr<Packet> p = packet->Copy();
     ThreeGppHttpHeader header;
-    p->RemoveHeader(header);
-    if (header.GetContentLength() == p->GetSize() &&
+    const uint32_t headerSize = packet->PeekHeader(header);
+    const uint32_t contentSize = packet->GetSize() - headerSize;
+    if (header.GetContentLength() == contentSize &&
         header.GetContentType() == ThreeGppHttpHeader::EMBEDDED_OBJECT)
     {
-        NS_LOG_INFO("Client has successfully received an embedded object of " << p->GetSize()
+        NS_LOG_INFO("Client has successfully received an embedded object of " << contentSize
                                                                               << " bytes.");
     }
     else
@@ -91,12 +105,6 @@ ClientEmbeddedObjectReceived(Ptr<const ThreeGppHttpClient>, Ptr<const Packet> pa
         NS_LOG_INFO("Client failed to parse an embedded object. ");
     }
 }
-int getRandomNumber(int min, int max) {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<int> dis(min, max);
-        return dis(gen);
-    }
 
 int
 main(int argc, char* argv[])
@@ -111,6 +119,23 @@ main(int argc, char* argv[])
     uint16_t webSocketClient = 2000;
     Time interPacketInterval = MilliSeconds(200);
     uint16_t numberOfUes = 10;
+    Time flowStatsInterval = Seconds(1.0);
+    Time timeSeriesBin = MilliSeconds(100);
+    bool delayQuantiles = true;
+    bool pathlossCache = true;
+    bool analyticMobility = true;
+    Time progressInterval = Seconds(10);
+    Time wallClockBudget = Seconds(0);
+    std::string flowmonFormat = "xml";
+    std::string summaryFile;
+    std::string attachMode = "cellSearch";
+    std::string pcapMode = "full";
+    std::string animFormat = "xml";
+    std::string httpTrace = "metrics";
+    std::string clientStart = "uniform";
+    Time clientStartSpread = Seconds(1);
+    int64_t clientStartStream = 1000;
+    int64_t positionStream = 3000;
 
     // Command line arguments
     CommandLine cmd;
@@ -118,15 +143,79 @@ main(int argc, char* argv[])
     cmd.AddValue("simTime", "Total duration of the simulation", simTime);
     cmd.AddValue("webSocketPort", "Web socket port (for web anim)", webSocketServer);
     cmd.AddValue("webSocketClient", "Web socket client (for web anim)", webSocketClient);
+    cmd.AddValue("flowStatsInterval",
+                 "Window of the streamed per-flow statistics (0 disables them)",
+                 flowStatsInterval);
+    cmd.AddValue("timeSeriesBin",
+                 "Bin of the in-memory per-flow throughput and delay series (0 disables them)",
+                 timeSeriesBin);
+    cmd.AddValue("delayQuantiles",
+                 "Record per-flow and per-cell delay and jitter quantiles (p50 to p99.9)",
+                 delayQuantiles);
+    cmd.AddValue("pathlossCache",
+                 "Compute the pathloss of every static eNB/UE pair once "
+                 "(ns3::CachedPropagationLossModel around Friis)",
+                 pathlossCache);
+    cmd.AddValue("analyticMobility",
+                 "Walk with ns3::AnalyticRandomMobilityModel, positions computed when read, "
+                 "instead of RandomWalk2dMobilityModel and its events per leg",
+                 analyticMobility);
+    cmd.AddValue("progressInterval",
+                 "Wall time between two progress lines on stderr (0 prints none)",
+                 progressInterval);
+    cmd.AddValue("wallClockBudget",
+                 "Wall time after which the run stops early and writes its results for the "
+                 "simulated time reached (0 for no limit); Ctrl-C does the same",
+                 wallClockBudget);
+    cmd.AddValue("flowmonFormat",
+                 "Format of the final flow monitor dump (xml or columnar)",
+                 flowmonFormat);
+    cmd.AddValue("summaryFile", "CSV file receiving the aggregate run metrics", summaryFile);
+    cmd.AddValue("attachMode",
+                 "Initial attachment: cellSearch, nearest or strongest (spatial index)",
+                 attachMode);
+    cmd.AddValue("pcapMode",
+                 "Capture of the point-to-point links: full, async (truncated, background "
+                 "writer, see ns3::AsyncPcapCapture) or none",
+                 pcapMode);
+    cmd.AddValue("animFormat",
+                 "NetAnim output: xml, binary (project.anim, convert with anim-to-netanim) "
+                 "or none",
+                 animFormat);
+    cmd.AddValue("httpTrace",
+                 "HTTP application tracing: metrics (counters and histograms in "
+                 "project-http.csv, page load times in project-http-qoe.csv) or log "
+                 "(NS_LOG_INFO per packet)",
+                 httpTrace);
+    cmd.AddValue("clientStart",
+                 "Start times of the HTTP clients: simultaneous, uniform or poisson",
+                 clientStart);
+    cmd.AddValue("clientStartSpread",
+                 "Window of the uniform start times, mean span of the poisson arrivals",
+                 clientStartSpread);
+    cmd.AddValue("clientStartStream",
+                 "Random stream of the HTTP client start times",
+                 clientStartStream);
+    cmd.AddValue("positionStream",
+                 "Random stream of the eNB and UE positions, drawn anew for every RngRun",
+                 positionStream);
     cmd.Parse(argc, argv);
 
     // parse again so you can override default values from the command line
     cmd.Parse(argc, argv);
 
+    // The LTE/EPC setup below runs on every run. ns-3 cannot restore the object
+    // graph built by the helpers (devices, RRC and S1 state, bearers, routes)
+    // from a file, so it cannot be snapshotted and skipped across seeds
     Ptr<LteHelper> lteHelper = CreateObject<LteHelper>(); // create LteHelper object
     Ptr<PointToPointEpcHelper> epcHelper =
         CreateObject<PointToPointEpcHelper>(); // PointToPointEpcHelper
     lteHelper->SetEpcHelper(epcHelper);        // enable the use of EPC by LTE helper
+    if (pathlossCache)
+    {
+        // The eNBs and half of the UEs never move; the walking UEs bypass the cache
+        lteHelper->SetPathlossModelType(CachedPropagationLossModel::GetTypeId());
+    }
 
     // Create eNodeBs
     NodeContainer enbNodes;
@@ -137,8 +226,12 @@ main(int argc, char* argv[])
     ueNodes.Create(numberOfUes); // number of UEs defined by numNodePairs
     Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator>();
 
+    // From an ns-3 stream, so a run is reproducible for a given RngRun
+    Ptr<UniformRandomVariable> positionRng = CreateObject<UniformRandomVariable>();
+    positionRng->SetStream(positionStream);
     for (int i = 0; i < 20; i++) {
-        positionAlloc->Add(Vector(getRandomNumber(0, 500), getRandomNumber(0, 500), 0.0));
+        positionAlloc->Add(
+            Vector(positionRng->GetInteger(0, 500), positionRng->GetInteger(0, 500), 0.0));
     }
     // Install Mobility Model
     MobilityHelper mobility;
@@ -169,9 +262,26 @@ main(int argc, char* argv[])
     walkingUeNodes.Add(ueNodes.Get(9));
 
     MobilityHelper walkingMobility;
-    walkingMobility.SetMobilityModel("ns3::RandomWalk2dMobilityModel",
-                                     "Bounds",
-                                     RectangleValue(Rectangle(-500, 500, -500, 500)));
+    if (analyticMobility)
+    {
+        // The walk of the RandomWalk2dMobilityModel branch below (its defaults:
+        // 1 m legs at 2-4 m/s), without a scheduler event per leg
+        walkingMobility.SetMobilityModel(AnalyticRandomMobilityModel::GetTypeId().GetName(),
+                                         "Mode",
+                                         StringValue("walkDistance"),
+                                         "Distance",
+                                         DoubleValue(1.0),
+                                         "Speed",
+                                         StringValue("ns3::UniformRandomVariable[Min=2.0|Max=4.0]"),
+                                         "Bounds",
+                                         RectangleValue(Rectangle(-500, 500, -500, 500)));
+    }
+    else
+    {
+        walkingMobility.SetMobilityModel("ns3::RandomWalk2dMobilityModel",
+                                         "Bounds",
+                                         RectangleValue(Rectangle(-500, 500, -500, 500)));
+    }
     walkingMobility.SetPositionAllocator(positionAlloc);
     walkingMobility.Install(walkingUeNodes);
 
@@ -261,7 +371,16 @@ main(int argc, char* argv[])
     //     // side effect: the default EPS bearer will be activated
     // }
     // Attach UEs to eNodeBs
-    lteHelper->Attach(ueLteDevs);
+    if (attachMode == "cellSearch")
+    {
+        lteHelper->Attach(ueLteDevs);
+    }
+    else
+    {
+        SpatialAttachHelper attachHelper;
+        attachHelper.SetMode(SpatialAttachHelper::ModeFromString(attachMode));
+        attachHelper.Attach(lteHelper, ueLteDevs, enbLteDevs);
+    }
     // Create HTTP server helper
     ThreeGppHttpServerHelper serverHelper(remoteHostAddr);
 
@@ -269,13 +388,25 @@ main(int argc, char* argv[])
     ApplicationContainer serverApps = serverHelper.Install(remoteHostContainer.Get(0));
     Ptr<ThreeGppHttpServer> httpServer = serverApps.Get(0)->GetObject<ThreeGppHttpServer>();
 
-    // Example of connecting to the trace sources
-    httpServer->TraceConnectWithoutContext("ConnectionEstablished",
-                                           MakeCallback(&ServerConnectionEstablished));
-    httpServer->TraceConnectWithoutContext("MainObject", MakeCallback(&MainObjectGenerated));
-    httpServer->TraceConnectWithoutContext("EmbeddedObject",
-                                           MakeCallback(&EmbeddedObjectGenerated));
-    httpServer->TraceConnectWithoutContext("Tx", MakeCallback(&ServerTx));
+    // Counters instead of a log line per packet, unless asked for
+    Ptr<HttpMetricsCollector> httpMetrics;
+    Ptr<HttpQoeTracker> httpQoe;
+    if (httpTrace == "metrics")
+    {
+        httpMetrics = CreateObject<HttpMetricsCollector>();
+        httpMetrics->Install(serverApps);
+        httpQoe = CreateObject<HttpQoeTracker>();
+    }
+    else
+    {
+        // Example of connecting to the trace sources
+        httpServer->TraceConnectWithoutContext("ConnectionEstablished",
+                                               MakeCallback(&ServerConnectionEstablished));
+        httpServer->TraceConnectWithoutContext("MainObject", MakeCallback(&MainObjectGenerated));
+        httpServer->TraceConnectWithoutContext("EmbeddedObject",
+                                               MakeCallback(&EmbeddedObjectGenerated));
+        httpServer->TraceConnectWithoutContext("Tx", MakeCallback(&ServerTx));
+    }
 
     // Setup HTTP variables for the server
     PointerValue varPtr;
@@ -286,31 +417,31 @@ main(int argc, char* argv[])
 
     // Create HTTP client helper
     ThreeGppHttpClientHelper clientHelper(remoteHostAddr);
-    ApplicationContainer clientApps;
-    // Install HTTP client
-    // Install HTTP client
-    // ApplicationContainer clientApps = clientHelper.Install (ueNodes.Get (0));
-    // Ptr<ThreeGppHttpClient> httpClient = clientApps.Get (0)->GetObject<ThreeGppHttpClient> ();
-
-    // // Example of connecting to the trace sources
-    // httpClient->TraceConnectWithoutContext ("RxMainObject", MakeCallback (&ClientMainObjectReceived));
-    // httpClient->TraceConnectWithoutContext ("RxEmbeddedObject", MakeCallback (&ClientEmbeddedObjectReceived));
-    // httpClient->TraceConnectWithoutContext ("Rx", MakeCallback (&ClientRx));
-    for (uint32_t u = 0; u < ueNodes.GetN(); ++u)
-    {
-        clientApps = clientHelper.Install(ueNodes.Get(u));
-        Ptr<ThreeGppHttpClient> httpClient = clientApps.Get(0)->GetObject<ThreeGppHttpClient>();
 
-        // Example of connecting to the trace sources
-        httpClient->TraceConnectWithoutContext("RxMainObject",
-                                               MakeCallback(&ClientMainObjectReceived));
-        httpClient->TraceConnectWithoutContext("RxEmbeddedObject",
-                                               MakeCallback(&ClientEmbeddedObjectReceived));
-        httpClient->TraceConnectWithoutContext("Rx", MakeCallback(&ClientRx));
+    // Install HTTP clients on every UE at once, with spread start times
+    StaggeredInstallHelper clientInstaller;
+    clientInstaller.SetStartPattern(StaggeredInstallHelper::PatternFromString(clientStart),
+                                    MilliSeconds(500),
+                                    clientStartSpread);
+    clientInstaller.AssignStreams(clientStartStream);
+    ApplicationContainer clientApps = clientInstaller.Install(clientHelper, ueNodes);
+    if (httpMetrics)
+    {
+        httpMetrics->Install(clientApps);
+        httpQoe->Install(clientApps);
+    }
+    else
+    {
+        // Example of connecting to the trace sources, of all clients at once
+        const std::string clients = "/NodeList/*/ApplicationList/*/$ns3::ThreeGppHttpClient/";
+        Config::ConnectWithoutContext(clients + "RxMainObject",
+                                      MakeCallback(&ClientMainObjectReceived));
+        Config::ConnectWithoutContext(clients + "RxEmbeddedObject",
+                                      MakeCallback(&ClientEmbeddedObjectReceived));
+        Config::ConnectWithoutContext(clients + "Rx", MakeCallback(&ClientRx));
     }
 
     serverApps.Start(MilliSeconds(500));
-    clientApps.Start(MilliSeconds(500));
 
     double startTime = Simulator::Now().GetSeconds();
     double latencyForOperation = Simulator::Now().GetSeconds() - startTime;
@@ -318,54 +449,177 @@ main(int argc, char* argv[])
 
     // Run simulation
     Simulator::Stop(simTime);
-    p2ph.EnablePcapAll("project");
+    Ptr<AsyncPcapCapture> pcapCapture;
+    if (pcapMode == "async")
+    {
+        pcapCapture = CreateObject<AsyncPcapCapture>();
+        pcapCapture->InstallAll("project");
+    }
+    else if (pcapMode == "full")
+    {
+        p2ph.EnablePcapAll("project");
+    }
     Ptr<FlowMonitor> monitor; // = flowMonHelper.InstallAll();
     FlowMonitorHelper flowMonHelper;
 
-    // NetAnim animation
-    AnimationInterface animation("project.xml"); // 1 Is SGW, 0 is PGW, 3 is Remote Host, 2 is MME,
-                                                 // 6 and 7 are UE, 4 are 5 are eNodeB
-    animation.UpdateNodeDescription(pgw,"PGW");
-    animation.UpdateNodeDescription(1,"SGW");
-    animation.UpdateNodeDescription(2,"MME");
+    // NetAnim animation, as XML or as a compact binary trace converted offline
+    // 1 Is SGW, 0 is PGW, 3 is Remote Host, 2 is MME, 6 and 7 are UE, 4 are 5 are eNodeB
+    std::unique_ptr<AnimationInterface> animation;
+    Ptr<BinaryAnimationTrace> binaryAnimation;
+    if (animFormat == "xml")
+    {
+        animation = std::make_unique<AnimationInterface>("project.xml");
+    }
+    else if (animFormat == "binary")
+    {
+        binaryAnimation = CreateObject<BinaryAnimationTrace>();
+        binaryAnimation->Start("project.anim");
+    }
+    auto describeNode = [&](uint32_t nodeId, const std::string& description) {
+        if (animation)
+        {
+            animation->UpdateNodeDescription(nodeId, description);
+        }
+        if (binaryAnimation)
+        {
+            binaryAnimation->UpdateNodeDescription(nodeId, description);
+        }
+    };
+    auto colorNode = [&](uint32_t nodeId, uint8_t r, uint8_t g, uint8_t b) {
+        if (animation)
+        {
+            animation->UpdateNodeColor(nodeId, r, g, b);
+        }
+        if (binaryAnimation)
+        {
+            binaryAnimation->UpdateNodeColor(nodeId, r, g, b);
+        }
+    };
+    describeNode(pgw->GetId(),"PGW");
+    describeNode(1,"SGW");
+    describeNode(2,"MME");
 
     for (uint32_t u = 0; u < 5; ++u){
-        animation.UpdateNodeDescription(ueNodes.Get (u),"UE_"+std::to_string(u));
-        animation.UpdateNodeColor(ueNodes.Get (u), 0, 0, 255);
+        describeNode(ueNodes.Get (u)->GetId(),"UE_"+std::to_string(u));
+        colorNode(ueNodes.Get (u)->GetId(), 0, 0, 255);
     }
 
     for (uint32_t u = 5; u < ueNodes.GetN (); ++u){
-        animation.UpdateNodeDescription(ueNodes.Get (u),"UE_"+std::to_string(u));
-        animation.UpdateNodeColor(ueNodes.Get (u), 0, 255, 0);
+        describeNode(ueNodes.Get (u)->GetId(),"UE_"+std::to_string(u));
+        colorNode(ueNodes.Get (u)->GetId(), 0, 255, 0);
     }
 
     for (uint32_t u = 0; u < enbNodes.GetN (); ++u){
-        animation.UpdateNodeDescription(enbNodes.Get (u),"eNodeB_"+std::to_string(u));
-        animation.UpdateNodeColor(enbNodes.Get (u), 0, 255, 0);
+        describeNode(enbNodes.Get (u)->GetId(),"eNodeB_"+std::to_string(u));
+        colorNode(enbNodes.Get (u)->GetId(), 0, 255, 0);
     }
 
-    animation.UpdateNodeDescription(remoteHostContainer.Get (0),"remoteHost"+std::to_string(0));
-    animation.UpdateNodeColor(remoteHostContainer.Get (0), 0, 255, 0);
+    describeNode(remoteHostContainer.Get (0)->GetId(),"remoteHost"+std::to_string(0));
+    colorNode(remoteHostContainer.Get (0)->GetId(), 0, 255, 0);
 
     monitor = flowMonHelper.Install(enbNodes);
     monitor = flowMonHelper.Install(ueNodes);
     monitor = flowMonHelper.Install(remoteHost);
+    Ptr<Ipv4FlowClassifier> classifier =
+        DynamicCast<Ipv4FlowClassifier>(flowMonHelper.GetClassifier());
+
+    // Tail delay and jitter per flow and per cell, in constant memory per flow
+    Ptr<FlowDelayQuantiles> delayStats;
+    if (delayQuantiles)
+    {
+        delayStats = CreateObject<FlowDelayQuantiles>();
+        delayStats->Install(NodeContainer::GetGlobal());
+    }
+
+    // Per-flow deltas written while the simulation runs, and throughput and
+    // delay bins, bounded in memory, exported at the end; one sampler for both
+    Ptr<FlowStatsCollector> flowStats;
+    if (flowStatsInterval.IsStrictlyPositive() || timeSeriesBin.IsStrictlyPositive())
+    {
+        flowStats = CreateObject<FlowStatsCollector>();
+        if (flowStatsInterval.IsStrictlyPositive())
+        {
+            flowStats->SetAttribute("Interval", TimeValue(flowStatsInterval));
+        }
+        flowStats->SetAttribute("BinWidth", TimeValue(timeSeriesBin));
+        flowStats->Install(monitor,
+                           classifier,
+                           flowStatsInterval.IsStrictlyPositive() ? "project-flowstats.csv" : "");
+    }
+    if (httpMetrics)
+    {
+        httpMetrics->Start("project-http.csv");
+    }
+
+    // Progress lines, and a clean early stop on the wall-clock budget or Ctrl-C
+    Ptr<SimulationProgress> progress = CreateObject<SimulationProgress>();
+    progress->SetAttribute("ReportInterval", TimeValue(progressInterval));
+    progress->SetAttribute("WallClockBudget", TimeValue(wallClockBudget));
+    progress->Start(simTime);
+
     Simulator::Run();
+    progress->Finish();
+
+    if (flowStats)
+    {
+        flowStats->Flush();
+        if (timeSeriesBin.IsStrictlyPositive())
+        {
+            flowStats->WriteSeries("project-timeseries.csv");
+        }
+    }
+    if (httpMetrics)
+    {
+        httpMetrics->Flush();
+        httpQoe->Write("project-http-qoe.csv");
+    }
+    if (pcapCapture)
+    {
+        pcapCapture->Close();
+    }
+    if (binaryAnimation)
+    {
+        binaryAnimation->Close();
+    }
 
     // GnuPlot
     std::string jmenoSouboru = "project_delay";
     std::string graphicsFileName = jmenoSouboru + ".png";
     std::string plotFileName = jmenoSouboru + ".plt";
-    std::string plotTitle = "Average delay";
+    std::string plotTitle = "Delay per flow";
     std::string dataTitle = "Delay [ms]";
     Gnuplot gnuplot(graphicsFileName);
     gnuplot.SetTitle(plotTitle);
     gnuplot.SetTerminal("png");
     gnuplot.SetLegend("IDs of data streams", "Delay [ms]");
-    gnuplot.AppendExtra("set xrange [1:" + std::to_string(numberOfUes * 4) + "]");
-    gnuplot.AppendExtra("set yrange [0:100]");
+    gnuplot.AppendExtra("set yrange [0:*]");
     gnuplot.AppendExtra("set grid");
-    Gnuplot2dDataset dataset_delay;
+    Gnuplot2dDataset dataset_delay("mean");
+    // Tail percentiles, per flow and per cell, for the delay and the jitter
+    const std::pair<double, std::string> quantiles[] = {
+        {0.5, "p50"},
+        {0.95, "p95"},
+        {0.99, "p99"},
+        {0.999, "p99.9"},
+    };
+    std::vector<Gnuplot2dDataset> dataset_delayQ;
+    std::vector<Gnuplot2dDataset> dataset_jitterQ;
+    for (const auto& [q, name] : quantiles)
+    {
+        dataset_delayQ.emplace_back(name);
+        dataset_jitterQ.emplace_back(name);
+    }
+
+    jmenoSouboru = "project_jitter";
+    graphicsFileName = jmenoSouboru + ".png";
+    std::string plotFileNameJitter = jmenoSouboru + ".plt";
+    Gnuplot gnuplot_jitter(graphicsFileName);
+    gnuplot_jitter.SetTitle("Jitter per flow");
+    gnuplot_jitter.SetTerminal("png");
+    gnuplot_jitter.SetLegend("IDs of data streams", "Jitter [ms]");
+    gnuplot_jitter.AppendExtra("set yrange [0:*]");
+    gnuplot_jitter.AppendExtra("set grid");
+    Gnuplot2dDataset dataset_jitter("mean");
 
     jmenoSouboru = "project_data_rate";
     graphicsFileName = jmenoSouboru + ".png";
@@ -376,45 +630,78 @@ main(int argc, char* argv[])
     gnuplot_DR.SetTitle(plotTitle);
     gnuplot_DR.SetTerminal("png");
     gnuplot_DR.SetLegend("IDs of all streams", "Data rate [kbps]");
-    gnuplot_DR.AppendExtra("set xrange [1:" + std::to_string(numberOfUes * 4) + "]");
     gnuplot_DR.AppendExtra("set yrange [0:2500]");
     gnuplot_DR.AppendExtra("set grid");
     Gnuplot2dDataset dataset_rate;
 
     monitor->CheckForLostPackets();
-    Ptr<Ipv4FlowClassifier> classifier =
-        DynamicCast<Ipv4FlowClassifier>(flowMonHelper.GetClassifier());
-    std::map<FlowId, FlowMonitor::FlowStats> stats = monitor->GetFlowStats();
+    const FlowMonitor::FlowStatsContainer& stats = monitor->GetFlowStats();
 
-    monitor->SerializeToXmlFile("project.flowmon", true, true);
+    if (!summaryFile.empty())
+    {
+        RunSummary summary;
+        summary.AddFlowMonitor(monitor);
+        if (httpMetrics)
+        {
+            httpMetrics->AddToSummary(summary);
+            httpQoe->AddToSummary(summary);
+        }
+        if (delayStats)
+        {
+            delayStats->AddToSummary(summary);
+        }
+        summary.Set("simTimeS", Simulator::Now().GetSeconds());
+        progress->AddToSummary(summary);
+        Ptr<CachedPropagationLossModel> cachedPathloss =
+            DynamicCast<CachedPropagationLossModel>(
+                lteHelper->GetDownlinkSpectrumChannel()->GetPropagationLossModel());
+        if (cachedPathloss)
+        {
+            const uint64_t lookups = cachedPathloss->GetHits() + cachedPathloss->GetMisses();
+            summary.Set("dlPathlossCacheHitRatio",
+                        lookups > 0 ? double(cachedPathloss->GetHits()) / lookups : 0.0);
+        }
+        summary.Write(summaryFile);
+    }
 
-    std::cout << std::endl << "*** Flow monitor statistic ***" << std::endl;
-    for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator i = stats.begin();
-         i != stats.end();
-         ++i)
+    if (flowmonFormat == "columnar")
+    {
+        SerializeFlowMonitorToColumnarFile(monitor, classifier, "project.flowcol", true);
+    }
+    else
+    {
+        monitor->SerializeToXmlFile("project.flowmon", true, true);
+    }
+
+    if (delayStats)
+    {
+        delayStats->Write("project-delay-quantiles.csv", monitor, classifier);
+    }
+
+    std::cout << "\n*** Flow monitor statistic ***\n";
+    for (FlowMonitor::FlowStatsContainerCI i = stats.begin(); i != stats.end(); ++i)
     {
         // if (i-> first > 2) {
         double Delay, DataRate;
         Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(i->first);
-        std::cout << "Flow ID: " << i->first << std::endl;
+        std::cout << "Flow ID: " << i->first << '\n';
         std::cout << "Src add: " << t.sourceAddress << "-> Dst add: " << t.destinationAddress
-                  << std::endl;
+                  << '\n';
         std::cout << "Src port: " << t.sourcePort << "-> Dst port: " << t.destinationPort
-                  << std::endl;
+                  << '\n';
         std::cout << "Tx Packets/Bytes: " << i->second.txPackets << "/" << i->second.txBytes
-                  << std::endl;
+                  << '\n';
         std::cout << "Rx Packets/Bytes: " << i->second.rxPackets << "/" << i->second.rxBytes
-                  << std::endl;
+                  << '\n';
         std::cout << "Throughput: "
                   << i->second.rxBytes * 8.0 /
                          (i->second.timeLastRxPacket.GetSeconds() -
                           i->second.timeFirstTxPacket.GetSeconds()) /
                          1024
-                  << "kb/s" << std::endl;
-        std::cout << "Delay sum: " << i->second.delaySum.GetMilliSeconds() << "ms" << std::endl;
+                  << "kb/s\n";
+        std::cout << "Delay sum: " << i->second.delaySum.GetMilliSeconds() << "ms\n";
         std::cout << "Mean delay: "
-                  << (i->second.delaySum.GetSeconds() / i->second.rxPackets) * 1000 << "ms"
-                  << std::endl;
+                  << (i->second.delaySum.GetSeconds() / i->second.rxPackets) * 1000 << "ms\n";
 
         // gnuplot Delay
         Delay = (i->second.delaySum.GetSeconds() / i->second.rxPackets) * 1000;
@@ -424,25 +711,95 @@ main(int argc, char* argv[])
             1024;
 
         dataset_delay.Add((double)i->first, (double)Delay);
+        if (const auto* d = delayStats ? delayStats->GetFlow(t) : nullptr)
+        {
+            std::cout << "Delay p50/p95/p99/p99.9: " << d->delay.GetQuantile(0.5) << "/"
+                      << d->delay.GetQuantile(0.95) << "/" << d->delay.GetQuantile(0.99) << "/"
+                      << d->delay.GetQuantile(0.999) << "ms\n";
+            std::cout << "Jitter p50/p95/p99/p99.9: " << d->jitter.GetQuantile(0.5) << "/"
+                      << d->jitter.GetQuantile(0.95) << "/" << d->jitter.GetQuantile(0.99) << "/"
+                      << d->jitter.GetQuantile(0.999) << "ms\n";
+            for (std::size_t k = 0; k < std::size(quantiles); ++k)
+            {
+                dataset_delayQ[k].Add((double)i->first, d->delay.GetQuantile(quantiles[k].first));
+                dataset_jitterQ[k].Add((double)i->first,
+                                       d->jitter.GetQuantile(quantiles[k].first));
+            }
+        }
         dataset_rate.Add((double)i->first, (double)DataRate);
-        std::cout << "Jitter sum: " << i->second.jitterSum.GetMilliSeconds() << "ms" << std::endl;
+        if (i->second.rxPackets > 1)
+        {
+            dataset_jitter.Add((double)i->first,
+                               i->second.jitterSum.GetSeconds() / (i->second.rxPackets - 1) *
+                                   1000);
+        }
+        std::cout << "Jitter sum: " << i->second.jitterSum.GetMilliSeconds() << "ms\n";
         std::cout << "Mean jitter: "
-                  << (i->second.jitterSum.GetSeconds() / (i->second.rxPackets - 1)) * 1000 << "ms"
-                  << std::endl;
+                  << (i->second.jitterSum.GetSeconds() / (i->second.rxPackets - 1)) * 1000
+                  << "ms\n";
         // std::cout << "Lost Packets: " << i->second.lostPackets << std::endl;
-        std::cout << "Lost Packets: " << i->second.txPackets - i->second.rxPackets << std::endl;
+        std::cout << "Lost Packets: " << i->second.txPackets - i->second.rxPackets << '\n';
         std::cout << "Packet loss: "
                   << (((i->second.txPackets - i->second.rxPackets) * 1.0) / i->second.txPackets) *
                          100
-                  << "%" << std::endl;
-        std::cout << "------------------------------------------------" << std::endl;
+                  << "%\n";
+        std::cout << "------------------------------------------------\n";
     }
 
-    // Gnuplot - continuation
+    // Gnuplot - continuation, one x position per flow
+    const std::string xrange = "set xrange [0:" + std::to_string(stats.size() + 1) + "]";
+    gnuplot.AppendExtra(xrange);
+    gnuplot_DR.AppendExtra(xrange);
+    gnuplot_jitter.AppendExtra(xrange);
     gnuplot.AddDataset(dataset_delay);
+    gnuplot_jitter.AddDataset(dataset_jitter);
+    if (delayStats)
+    {
+        for (std::size_t k = 0; k < std::size(quantiles); ++k)
+        {
+            gnuplot.AddDataset(dataset_delayQ[k]);
+            gnuplot_jitter.AddDataset(dataset_jitterQ[k]);
+        }
+    }
     std::ofstream plotFile(plotFileName.c_str());
     gnuplot.GenerateOutput(plotFile);
     plotFile.close();
+    std::ofstream plotFileJitter(plotFileNameJitter.c_str());
+    gnuplot_jitter.GenerateOutput(plotFileJitter);
+    plotFileJitter.close();
+
+    // Gnuplot - delay and jitter percentiles per serving cell (0: no LTE endpoint)
+    if (delayStats)
+    {
+        const std::vector<uint16_t> cells = delayStats->GetCellIds();
+        const std::string cellRange =
+            "set xrange [-1:" + std::to_string(cells.empty() ? 1 : cells.back() + 1) + "]";
+        for (const std::string metric : {"delay", "jitter"})
+        {
+            jmenoSouboru = "project_cell_" + metric;
+            Gnuplot gnuplot_cell(jmenoSouboru + ".png");
+            gnuplot_cell.SetTitle("Percentiles of the " + metric + " per cell");
+            gnuplot_cell.SetTerminal("png");
+            gnuplot_cell.SetLegend("Cell ID", (metric == "delay" ? "Delay" : "Jitter") +
+                                                  std::string(" [ms]"));
+            gnuplot_cell.AppendExtra("set yrange [0:*]");
+            gnuplot_cell.AppendExtra("set grid");
+            gnuplot_cell.AppendExtra(cellRange);
+            for (const auto& [q, name] : quantiles)
+            {
+                Gnuplot2dDataset dataset_cell(name);
+                for (uint16_t cell : cells)
+                {
+                    const auto* d = delayStats->GetCell(cell);
+                    const auto& hist = metric == "delay" ? d->delay : d->jitter;
+                    dataset_cell.Add(cell, hist.GetQuantile(q));
+                }
+                gnuplot_cell.AddDataset(dataset_cell);
+            }
+            std::ofstream plotFileCell(jmenoSouboru + ".plt");
+            gnuplot_cell.GenerateOutput(plotFileCell);
+        }
+    }
     gnuplot_DR.AddDataset(dataset_rate);
     std::ofstream plotFileDR(plotFileNameDR.c_str());
     gnuplot_DR.GenerateOutput(plotFileDR);
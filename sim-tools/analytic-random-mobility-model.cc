@@ -0,0 +1,259 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "analytic-random-mobility-model.h"
+
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/log.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("AnalyticRandomMobilityModel");
+
+NS_OBJECT_ENSURE_REGISTERED(AnalyticRandomMobilityModel);
+
+TypeId
+AnalyticRandomMobilityModel::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::AnalyticRandomMobilityModel")
+            .SetParent<MobilityModel>()
+            .AddConstructor<AnalyticRandomMobilityModel>()
+            .AddAttribute("Mode",
+                          "How the segments are drawn: direction (to a wall, pause, inwards), "
+                          "walkTime or walkDistance (new course every Time or Distance).",
+                          EnumValue(AnalyticRandomMobilityModel::DIRECTION),
+                          MakeEnumAccessor(&AnalyticRandomMobilityModel::m_mode),
+                          MakeEnumChecker(AnalyticRandomMobilityModel::DIRECTION,
+                                          "direction",
+                                          AnalyticRandomMobilityModel::WALK_TIME,
+                                          "walkTime",
+                                          AnalyticRandomMobilityModel::WALK_DISTANCE,
+                                          "walkDistance"))
+            .AddAttribute("Bounds",
+                          "Area of the trajectory.",
+                          RectangleValue(Rectangle(-100, 100, -100, 100)),
+                          MakeRectangleAccessor(&AnalyticRandomMobilityModel::m_bounds),
+                          MakeRectangleChecker())
+            .AddAttribute("Speed",
+                          "Speed of a move [m/s].",
+                          StringValue("ns3::UniformRandomVariable[Min=1.0|Max=2.0]"),
+                          MakePointerAccessor(&AnalyticRandomMobilityModel::m_speed),
+                          MakePointerChecker<RandomVariableStream>())
+            .AddAttribute("Pause",
+                          "Pause on a wall in direction mode [s].",
+                          StringValue("ns3::ConstantRandomVariable[Constant=2.0]"),
+                          MakePointerAccessor(&AnalyticRandomMobilityModel::m_pause),
+                          MakePointerChecker<RandomVariableStream>())
+            .AddAttribute("Time",
+                          "Duration of a walk leg in walkTime mode.",
+                          TimeValue(Seconds(20)),
+                          MakeTimeAccessor(&AnalyticRandomMobilityModel::m_legTime),
+                          MakeTimeChecker())
+            .AddAttribute("Distance",
+                          "Length of a walk leg in walkDistance mode [m].",
+                          DoubleValue(30),
+                          MakeDoubleAccessor(&AnalyticRandomMobilityModel::m_legDistance),
+                          MakeDoubleChecker<double>(0));
+    return tid;
+}
+
+AnalyticRandomMobilityModel::AnalyticRandomMobilityModel()
+    : m_direction(CreateObject<UniformRandomVariable>())
+{
+    NS_LOG_FUNCTION(this);
+}
+
+AnalyticRandomMobilityModel::~AnalyticRandomMobilityModel()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+int64_t
+AnalyticRandomMobilityModel::DoAssignStreams(int64_t stream)
+{
+    m_speed->SetStream(stream);
+    m_pause->SetStream(stream + 1);
+    m_direction->SetStream(stream + 2);
+    return 3;
+}
+
+void
+AnalyticRandomMobilityModel::DoSetPosition(const Vector& position)
+{
+    NS_LOG_FUNCTION(this << position);
+    // The first segment is drawn by the first query, after AssignStreams
+    m_state = START;
+    m_start = position;
+    m_velocity = Vector(0, 0, 0);
+    m_segmentStart = Simulator::Now();
+    m_segmentEnd = m_segmentStart;
+    NotifyCourseChange();
+}
+
+Vector
+AnalyticRandomMobilityModel::DoGetPosition() const
+{
+    Update();
+    const double elapsed = (Simulator::Now() - m_segmentStart).GetSeconds();
+    return Vector(m_start.x + m_velocity.x * elapsed,
+                  m_start.y + m_velocity.y * elapsed,
+                  m_start.z);
+}
+
+Vector
+AnalyticRandomMobilityModel::DoGetVelocity() const
+{
+    Update();
+    return m_velocity;
+}
+
+void
+AnalyticRandomMobilityModel::Update() const
+{
+    const Time now = Simulator::Now();
+    if (m_segmentEnd > now)
+    {
+        return;
+    }
+    while (m_segmentEnd <= now)
+    {
+        NextSegment();
+    }
+    NotifyCourseChange();
+}
+
+void
+AnalyticRandomMobilityModel::NextSegment() const
+{
+    const double twoPi = 2 * M_PI;
+    if (m_state == START)
+    {
+        const Time legEnd = m_mode == DIRECTION ? Time::Max() : m_segmentEnd;
+        Move(m_direction->GetValue(0, twoPi), m_speed->GetValue(), legEnd);
+        return;
+    }
+    if (m_mode != DIRECTION)
+    {
+        // Leg over, or bounce on the wall for the rest of it
+        if (m_segmentEnd >= m_legEnd)
+        {
+            Move(m_direction->GetValue(0, twoPi), m_speed->GetValue(), m_segmentEnd);
+        }
+        else
+        {
+            const bool vertical = m_wall == Rectangle::LEFT || m_wall == Rectangle::RIGHT;
+            const double direction = vertical ? std::atan2(m_velocity.y, -m_velocity.x)
+                                              : std::atan2(-m_velocity.y, m_velocity.x);
+            Move(direction, std::hypot(m_velocity.x, m_velocity.y), m_legEnd);
+        }
+        return;
+    }
+    if (m_state == MOVING)
+    {
+        m_start = GetSegmentEnd();
+        m_velocity = Vector(0, 0, 0);
+        m_segmentStart = m_segmentEnd;
+        m_segmentEnd = m_segmentStart + Seconds(std::max(0.0, m_pause->GetValue()));
+        m_state = PAUSED;
+        return;
+    }
+    // Leave the wall inwards, as RandomDirection2dMobilityModel does
+    double low = 0;
+    switch (m_wall)
+    {
+    case Rectangle::RIGHT:
+        low = M_PI / 2;
+        break;
+    case Rectangle::LEFT:
+        low = -M_PI / 2;
+        break;
+    case Rectangle::TOP:
+        low = M_PI;
+        break;
+    case Rectangle::BOTTOM:
+        low = 0;
+        break;
+    }
+    Move(m_direction->GetValue(low, low + M_PI), m_speed->GetValue(), Time::Max());
+}
+
+void
+AnalyticRandomMobilityModel::Move(double direction, double speed, Time until) const
+{
+    m_start = GetSegmentEnd();
+    m_segmentStart = m_segmentEnd;
+    speed = std::max(0.0, speed);
+    m_velocity = Vector(speed * std::cos(direction), speed * std::sin(direction), 0);
+    m_state = MOVING;
+
+    // A new walk leg ends after Time, or once Distance is covered whatever
+    // the bounces; a bounce continues the current leg
+    if (m_mode == WALK_TIME && until == m_segmentStart)
+    {
+        NS_ABORT_MSG_IF(!m_legTime.IsStrictlyPositive(), "Walk legs need a positive Time");
+        until = m_segmentStart + m_legTime;
+    }
+    else if (m_mode == WALK_DISTANCE && until == m_segmentStart)
+    {
+        NS_ABORT_MSG_IF(m_legDistance <= 0, "Walk legs need a positive Distance");
+        until = speed > 0 ? m_segmentStart + Seconds(m_legDistance / speed) : Time::Max();
+    }
+    m_legEnd = until;
+
+    // Time to the first wall ahead
+    const double inf = std::numeric_limits<double>::infinity();
+    const double toX = m_velocity.x > 0   ? (m_bounds.xMax - m_start.x) / m_velocity.x
+                       : m_velocity.x < 0 ? (m_bounds.xMin - m_start.x) / m_velocity.x
+                                          : inf;
+    const double toY = m_velocity.y > 0   ? (m_bounds.yMax - m_start.y) / m_velocity.y
+                       : m_velocity.y < 0 ? (m_bounds.yMin - m_start.y) / m_velocity.y
+                                          : inf;
+    if (toX <= toY)
+    {
+        m_wall = m_velocity.x > 0 ? Rectangle::RIGHT : Rectangle::LEFT;
+    }
+    else
+    {
+        m_wall = m_velocity.y > 0 ? Rectangle::TOP : Rectangle::BOTTOM;
+    }
+    const double toWall = std::max(0.0, std::min(toX, toY));
+    const Time wall = toWall == inf || toWall >= (Time::Max() - m_segmentStart).GetSeconds()
+                          ? Time::Max()
+                          : m_segmentStart + Seconds(toWall);
+    m_segmentEnd = std::min(wall, m_legEnd);
+}
+
+Vector
+AnalyticRandomMobilityModel::GetSegmentEnd() const
+{
+    const double elapsed = (m_segmentEnd - m_segmentStart).GetSeconds();
+    return Vector(std::clamp(m_start.x + m_velocity.x * elapsed, m_bounds.xMin, m_bounds.xMax),
+                  std::clamp(m_start.y + m_velocity.y * elapsed, m_bounds.yMin, m_bounds.yMax),
+                  m_start.z);
+}
+
+} // namespace ns3
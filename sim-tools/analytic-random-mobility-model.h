@@ -0,0 +1,119 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef ANALYTIC_RANDOM_MOBILITY_MODEL_H
+#define ANALYTIC_RANDOM_MOBILITY_MODEL_H
+
+#include "ns3/mobility-model.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rectangle.h"
+
+namespace ns3
+{
+
+/**
+ * Random direction or random walk in a rectangle, evaluated on demand
+ * instead of driven by the scheduler.
+ *
+ * The trajectory is a sequence of straight segments: a move to the next
+ * wall, a pause or a walk leg, each drawn from the model's own streams only
+ * when a position or velocity at or beyond its start is asked for. The
+ * position within a segment is its start plus the velocity times the time
+ * elapsed, so the model schedules no event at all; a node nobody looks at
+ * costs nothing, and one looked at rarely catches up on all the segments it
+ * skipped at once. Segments are drawn in order from the time of the last
+ * SetPosition, whatever the times of the queries, so the trajectory only
+ * depends on the seed, run number and streams.
+ *
+ * The modes follow RandomDirection2dMobilityModel (cross to a wall, pause,
+ * leave it inwards) and RandomWalk2dMobilityModel (change speed and
+ * direction every Time or Distance, bounce on the walls). CourseChange is
+ * fired once when a query first finds that the course changed since the
+ * previous one, at the time of that query, rather than at every wall and
+ * pause: observers that need it (a pathloss cache, an animation) read the
+ * position anyway, and the others get nothing.
+ */
+class AnalyticRandomMobilityModel : public MobilityModel
+{
+  public:
+    /// How the segments are drawn.
+    enum Mode
+    {
+        DIRECTION,    //!< To a wall, pause, then inwards.
+        WALK_TIME,    //!< New speed and direction every Time.
+        WALK_DISTANCE //!< New speed and direction every Distance.
+    };
+
+    AnalyticRandomMobilityModel();
+    ~AnalyticRandomMobilityModel() override;
+
+    /**
+     * Register this type.
+     * \return The TypeId.
+     */
+    static TypeId GetTypeId();
+
+  private:
+    /// What the current segment is.
+    enum State
+    {
+        START,  //!< Nothing drawn since the last SetPosition.
+        MOVING, //!< Moving.
+        PAUSED  //!< Pausing on a wall.
+    };
+
+    Vector DoGetPosition() const override;
+    void DoSetPosition(const Vector& position) override;
+    Vector DoGetVelocity() const override;
+    int64_t DoAssignStreams(int64_t stream) override;
+
+    /// Move to the segment covering the current time, firing CourseChange
+    /// if it is a new one.
+    void Update() const;
+    /// Replace the current segment by the one following it.
+    void NextSegment() const;
+
+    /**
+     * Start moving at the end of the current segment.
+     * \param direction Heading [rad].
+     * \param speed Speed [m/s].
+     * \param until End of the walk leg, Time::Max() in DIRECTION mode.
+     */
+    void Move(double direction, double speed, Time until) const;
+
+    /// \return The position at the end of the current segment, in the bounds.
+    Vector GetSegmentEnd() const;
+
+    Mode m_mode;                                     //!< How the segments are drawn.
+    Rectangle m_bounds;                              //!< Area of the trajectory.
+    Ptr<RandomVariableStream> m_speed;               //!< Speed of a move [m/s].
+    Ptr<RandomVariableStream> m_pause;               //!< Pause on a wall [s].
+    Time m_legTime;                                  //!< Walk leg of WALK_TIME.
+    double m_legDistance;                            //!< Walk leg of WALK_DISTANCE [m].
+    Ptr<UniformRandomVariable> m_direction;          //!< Headings.
+    mutable State m_state{START};                    //!< What the current segment is.
+    mutable Vector m_start;                          //!< Position at the start of the segment.
+    mutable Vector m_velocity;                       //!< Velocity during the segment.
+    mutable Time m_segmentStart;                     //!< Start of the segment.
+    mutable Time m_segmentEnd;                       //!< End of the segment.
+    mutable Time m_legEnd;                           //!< End of the current walk leg.
+    mutable Rectangle::Side m_wall{Rectangle::LEFT}; //!< Wall at the end of a move.
+};
+
+} // namespace ns3
+
+#endif /* ANALYTIC_RANDOM_MOBILITY_MODEL_H */
@@ -0,0 +1,198 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Converts a binary animation trace to a NetAnim XML file, e.g.
+//
+//   ./ns3 run "anim-to-netanim --input=project.anim --output=project.xml"
+//
+// The trace is read twice: once for the topology (nodes, first positions,
+// links), once to stream the updates and packets in time order.
+
+#include "binary-animation-trace.h"
+
+#include "ns3/core-module.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("AnimToNetanim");
+
+namespace
+{
+
+/// \return The text escaped for an XML attribute.
+std::string
+XmlEscape(const std::string& text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        switch (c)
+        {
+        case '&':
+            escaped += "&amp;";
+            break;
+        case '<':
+            escaped += "&lt;";
+            break;
+        case '>':
+            escaped += "&gt;";
+            break;
+        case '"':
+            escaped += "&quot;";
+            break;
+        default:
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    std::string input;
+    std::string output;
+
+    CommandLine cmd;
+    cmd.AddValue("input", "Binary animation trace", input);
+    cmd.AddValue("output", "NetAnim XML file", output);
+    cmd.Parse(argc, argv);
+
+    BinaryAnimationReader reader;
+    if (!reader.Open(input))
+    {
+        std::cerr << "Cannot read " << input << "\n";
+        return 1;
+    }
+
+    // Topology: every node seen, its first position and the links
+    std::map<uint32_t, Vector> firstPositions;
+    std::set<uint32_t> nodes;
+    std::vector<std::pair<uint32_t, uint32_t>> links;
+    AnimationRecord record;
+    while (reader.Next(record))
+    {
+        nodes.insert(record.node);
+        if (record.type == AnimationRecordType::NODE_POSITION)
+        {
+            firstPositions.emplace(record.node, record.position);
+        }
+        else if (record.type == AnimationRecordType::LINK)
+        {
+            nodes.insert(record.peer);
+            links.emplace_back(record.node, record.peer);
+        }
+    }
+
+    double minX = 0;
+    double minY = 0;
+    double maxX = 0;
+    double maxY = 0;
+    for (const auto& [node, position] : firstPositions)
+    {
+        minX = std::min(minX, position.x);
+        minY = std::min(minY, position.y);
+        maxX = std::max(maxX, position.x);
+        maxY = std::max(maxY, position.y);
+    }
+
+    std::ofstream os(output, std::ios::out | std::ios::trunc);
+    if (!os.is_open())
+    {
+        std::cerr << "Cannot write " << output << "\n";
+        return 1;
+    }
+    os << std::setprecision(9);
+    os << "<anim ver=\"netanim-3.108\" filetype=\"animation\" >\n";
+    os << "<topology minX=\"" << minX << "\" minY=\"" << minY << "\" maxX=\"" << maxX
+       << "\" maxY=\"" << maxY << "\">\n";
+    for (uint32_t node : nodes)
+    {
+        auto it = firstPositions.find(node);
+        Vector position = it != firstPositions.end() ? it->second : Vector();
+        os << "<node id=\"" << node << "\" sysId=\"0\" locX=\"" << position.x << "\" locY=\""
+           << position.y << "\" />\n";
+    }
+    for (const auto& [from, to] : links)
+    {
+        os << "<link fromId=\"" << from << "\" toId=\"" << to << "\" fd=\"\" ld=\"\" />\n";
+    }
+    os << "</topology>\n";
+
+    // Updates, in time order; a received packet is matched with its last
+    // transmission, which is the previous hop
+    BinaryAnimationReader updates;
+    updates.Open(input);
+    std::set<uint32_t> placed;
+    std::map<uint64_t, std::pair<uint32_t, Time>> inFlight;
+    uint64_t packets = 0;
+    while (updates.Next(record))
+    {
+        const double t = record.time.GetSeconds();
+        switch (record.type)
+        {
+        case AnimationRecordType::NODE_POSITION:
+            // The first position is already in the topology
+            if (!placed.insert(record.node).second)
+            {
+                os << "<nu p=\"p\" t=\"" << t << "\" id=\"" << record.node << "\" x=\""
+                   << record.position.x << "\" y=\"" << record.position.y << "\" />\n";
+            }
+            break;
+        case AnimationRecordType::NODE_DESCRIPTION:
+            os << "<nu p=\"d\" t=\"" << t << "\" id=\"" << record.node << "\" descr=\""
+               << XmlEscape(record.description) << "\" />\n";
+            break;
+        case AnimationRecordType::NODE_COLOR:
+            os << "<nu p=\"c\" t=\"" << t << "\" id=\"" << record.node << "\" r=\""
+               << +record.color[0] << "\" g=\"" << +record.color[1] << "\" b=\""
+               << +record.color[2] << "\" />\n";
+            break;
+        case AnimationRecordType::LINK:
+            break;
+        case AnimationRecordType::PACKET_TX:
+            inFlight[record.uid] = {record.node, record.time};
+            break;
+        case AnimationRecordType::PACKET_RX: {
+            auto it = inFlight.find(record.uid);
+            if (it == inFlight.end())
+            {
+                break;
+            }
+            const double tx = it->second.second.GetSeconds();
+            os << "<p fId=\"" << it->second.first << "\" fbTx=\"" << tx << "\" lbTx=\"" << tx
+               << "\" tId=\"" << record.node << "\" fbRx=\"" << t << "\" lbRx=\"" << t
+               << "\" />\n";
+            inFlight.erase(it);
+            ++packets;
+            break;
+        }
+        }
+    }
+    os << "</anim>\n";
+
+    std::cout << nodes.size() << " nodes, " << links.size() << " links, " << packets
+              << " packets written to " << output << "\n";
+    return 0;
+}
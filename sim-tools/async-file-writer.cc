@@ -0,0 +1,233 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "async-file-writer.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("AsyncFileWriter");
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+    Close();
+}
+
+void
+AsyncFileWriter::Open(const std::string& fileName, std::size_t bufferSize, uint32_t buffers)
+{
+    NS_LOG_FUNCTION(this << fileName << bufferSize << buffers);
+    NS_ABORT_MSG_IF(IsOpen(), "Writer already open");
+    NS_ABORT_MSG_IF(bufferSize == 0 || buffers == 0, "The writer needs at least one buffer");
+
+    // The first file is opened here so a bad path fails immediately
+    std::FILE* file = std::fopen(fileName.c_str(), "wb");
+    NS_ABORT_MSG_IF(!file, "Unable to open " << fileName);
+    m_files.assign(1, file);
+    m_fileCount = 1;
+
+    m_bufferSize = bufferSize;
+    m_maxPending = buffers;
+    m_current.data.reserve(m_bufferSize);
+    m_closing = false;
+    m_thread = std::thread(&AsyncFileWriter::Run, this);
+}
+
+uint32_t
+AsyncFileWriter::AddFile(const std::string& fileName)
+{
+    NS_LOG_FUNCTION(this << fileName);
+    NS_ABORT_MSG_IF(!IsOpen(), "Open the writer first");
+    std::FILE* file = std::fopen(fileName.c_str(), "wb");
+    NS_ABORT_MSG_IF(!file, "Unable to open " << fileName);
+    // The thread owns the file list: it takes the file in order with the data
+    Segment segment;
+    segment.file = m_fileCount;
+    segment.open = file;
+    m_current.segments.push_back(std::move(segment));
+    return m_fileCount++;
+}
+
+bool
+AsyncFileWriter::IsOpen() const
+{
+    return m_thread.joinable();
+}
+
+void
+AsyncFileWriter::Write(const void* data, std::size_t size)
+{
+    Write(0, data, size);
+}
+
+void
+AsyncFileWriter::Write(uint32_t file, const void* data, std::size_t size)
+{
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0)
+    {
+        std::size_t chunk = std::min(size, m_bufferSize - m_current.data.size());
+        m_current.data.insert(m_current.data.end(), bytes, bytes + chunk);
+        // Bytes after a reopen belong to the next file, so they start a segment
+        std::vector<Segment>& segments = m_current.segments;
+        if (segments.empty() || segments.back().file != file || !segments.back().reopen.empty())
+        {
+            segments.emplace_back();
+            segments.back().file = file;
+        }
+        segments.back().size += chunk;
+        bytes += chunk;
+        size -= chunk;
+        if (m_current.data.size() == m_bufferSize)
+        {
+            Submit();
+        }
+    }
+}
+
+void
+AsyncFileWriter::Reopen(uint32_t file,
+                        const std::string& fileName,
+                        const std::string& removeFileName)
+{
+    NS_LOG_FUNCTION(this << file << fileName << removeFileName);
+    Segment segment;
+    segment.file = file;
+    segment.reopen = fileName;
+    segment.remove = removeFileName;
+    m_current.segments.push_back(std::move(segment));
+}
+
+void
+AsyncFileWriter::Flush()
+{
+    if (!m_current.segments.empty())
+    {
+        Submit();
+    }
+}
+
+void
+AsyncFileWriter::Close()
+{
+    if (!IsOpen())
+    {
+        return;
+    }
+    NS_LOG_FUNCTION(this);
+    Flush();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closing = true;
+    }
+    m_ready.notify_one();
+    m_thread.join();
+    NS_LOG_DEBUG("Closed after " << m_stalls << " stalls");
+}
+
+uint64_t
+AsyncFileWriter::GetStalls() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stalls;
+}
+
+void
+AsyncFileWriter::Submit()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_pending.size() >= m_maxPending)
+    {
+        ++m_stalls;
+        m_space.wait(lock, [this] { return m_pending.size() < m_maxPending; });
+    }
+    m_pending.push_back(std::move(m_current));
+    if (!m_free.empty())
+    {
+        m_current = std::move(m_free.back());
+        m_free.pop_back();
+    }
+    else
+    {
+        m_current = Block();
+        m_current.data.reserve(m_bufferSize);
+    }
+    lock.unlock();
+    m_ready.notify_one();
+}
+
+void
+AsyncFileWriter::Run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_ready.wait(lock, [this] { return m_closing || !m_pending.empty(); });
+        if (m_pending.empty())
+        {
+            break;
+        }
+        Block block = std::move(m_pending.front());
+        m_pending.pop_front();
+        lock.unlock();
+        m_space.notify_one();
+
+        const char* bytes = block.data.data();
+        for (const auto& segment : block.segments)
+        {
+            if (segment.open)
+            {
+                m_files.resize(std::max<std::size_t>(m_files.size(), segment.file + 1));
+                m_files[segment.file] = segment.open;
+            }
+            std::FILE* file = m_files[segment.file];
+            if (segment.size > 0 && std::fwrite(bytes, 1, segment.size, file) != segment.size)
+            {
+                NS_FATAL_ERROR("Write failed: " << std::strerror(errno));
+            }
+            bytes += segment.size;
+            if (!segment.reopen.empty())
+            {
+                std::fclose(file);
+                m_files[segment.file] = std::fopen(segment.reopen.c_str(), "wb");
+                NS_ABORT_MSG_IF(!m_files[segment.file], "Unable to open " << segment.reopen);
+            }
+            if (!segment.remove.empty())
+            {
+                std::remove(segment.remove.c_str());
+            }
+        }
+
+        block.data.clear();
+        block.segments.clear();
+        lock.lock();
+        m_free.push_back(std::move(block));
+    }
+    lock.unlock();
+    for (std::FILE* file : m_files)
+    {
+        std::fclose(file);
+    }
+    m_files.clear();
+}
+
+} // namespace ns3
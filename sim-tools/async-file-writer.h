@@ -0,0 +1,145 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ASYNC_FILE_WRITER_H
+#define ASYNC_FILE_WRITER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Binary file writer that moves the disk I/O off the simulation thread.
+ *
+ * Write() only copies into an in-memory buffer. Full buffers are handed to a
+ * background thread through a bounded queue; when the disk cannot keep up the
+ * queue fills and Write() waits for a free buffer, so memory stays bounded and
+ * nothing is dropped. The writer can switch to another file without waiting for
+ * the pending data, which is what file rotation needs.
+ *
+ * Several files can share the buffers and the thread: AddFile() returns the
+ * index to write to, and each buffer records which of its bytes go to which
+ * file. Captures with one file per device thus cost one thread and one set
+ * of buffers however many devices there are.
+ */
+class AsyncFileWriter
+{
+  public:
+    AsyncFileWriter() = default;
+    ~AsyncFileWriter();
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    /**
+     * Open the file, truncating it, and start the background thread.
+     * \param fileName The file to write, index 0.
+     * \param bufferSize Size of one buffer in bytes.
+     * \param buffers Number of full buffers that may wait for the disk.
+     */
+    void Open(const std::string& fileName, std::size_t bufferSize, uint32_t buffers);
+
+    /**
+     * Open one more file, truncating it, written by the same thread.
+     * \param fileName The file.
+     * \return Its index.
+     */
+    uint32_t AddFile(const std::string& fileName);
+
+    /// \return True between Open() and Close().
+    bool IsOpen() const;
+
+    /**
+     * Append bytes to the first file.
+     * \param data The bytes.
+     * \param size Number of bytes.
+     */
+    void Write(const void* data, std::size_t size);
+
+    /**
+     * Append bytes to a file.
+     * \param file Index of the file.
+     * \param data The bytes.
+     * \param size Number of bytes.
+     */
+    void Write(uint32_t file, const void* data, std::size_t size);
+
+    /**
+     * Continue a file in another one once everything written to it so far is
+     * on disk.
+     * \param file Index of the file, kept by the new one.
+     * \param fileName The next file, truncated when opened.
+     * \param removeFileName A file to delete at the same time, or empty.
+     */
+    void Reopen(uint32_t file, const std::string& fileName, const std::string& removeFileName = "");
+
+    /// Hand the current buffer over to the background thread.
+    void Flush();
+
+    /// Write everything still buffered, close the files and stop the thread.
+    void Close();
+
+    /// \return How many times Write() had to wait for the disk.
+    uint64_t GetStalls() const;
+
+  private:
+    /// A run of bytes of a buffer that go to one file, and what to do with it.
+    struct Segment
+    {
+        uint32_t file{0};         //!< Index of the file.
+        std::size_t size{0};      //!< Bytes, following those of the previous segment.
+        std::FILE* open{nullptr}; //!< File to start with, if not null.
+        std::string reopen;       //!< File to continue in after the bytes, if not empty.
+        std::string remove;       //!< File to delete, if not empty.
+    };
+
+    /// A full buffer and where its bytes go.
+    struct Block
+    {
+        std::vector<char> data;        //!< Bytes to write.
+        std::vector<Segment> segments; //!< Their files, in order.
+    };
+
+    /// Queue the current buffer.
+    void Submit();
+    /// Body of the background thread.
+    void Run();
+
+    std::vector<std::FILE*> m_files; //!< Open files, owned by the thread.
+    uint32_t m_fileCount{0};         //!< Files handed out so far.
+    std::size_t m_bufferSize{0};     //!< Capacity of a buffer.
+    uint32_t m_maxPending{0};        //!< Bound of the queue.
+    Block m_current;                 //!< Buffer being filled.
+    std::deque<Block> m_pending;     //!< Buffers waiting for the disk.
+    std::vector<Block> m_free;       //!< Written buffers, for reuse.
+    mutable std::mutex m_mutex;      //!< Protects the queue and m_free.
+    std::condition_variable m_ready; //!< Signals the thread.
+    std::condition_variable m_space; //!< Signals a waiting Write().
+    bool m_closing{false};           //!< Tells the thread to exit.
+    uint64_t m_stalls{0};            //!< Writes that waited for a buffer.
+    std::thread m_thread;            //!< The background thread.
+};
+
+} // namespace ns3
+
+#endif /* ASYNC_FILE_WRITER_H */
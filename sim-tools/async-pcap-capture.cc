@@ -0,0 +1,346 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "async-pcap-capture.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("AsyncPcapCapture");
+
+NS_OBJECT_ENSURE_REGISTERED(AsyncPcapCapture);
+
+namespace
+{
+
+/// Size of the pcap global header.
+const uint32_t PCAP_FILE_HEADER_SIZE = 24;
+/// Size of a pcap record header.
+const uint32_t PCAP_RECORD_HEADER_SIZE = 16;
+/// Link type of the point-to-point devices, which carry a PPP header.
+const uint32_t DLT_PPP = 9;
+
+/// Store a 32 bit value in host order, which the pcap magic number tells readers.
+void
+PutU32(uint8_t* buffer, uint32_t value)
+{
+    std::memcpy(buffer, &value, sizeof(value));
+}
+
+} // namespace
+
+TypeId
+AsyncPcapCapture::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::AsyncPcapCapture")
+            .SetParent<Object>()
+            .AddConstructor<AsyncPcapCapture>()
+            .AddAttribute("SnapLen",
+                          "Bytes kept of every packet; the default covers the PPP, IPv4 "
+                          "and TCP headers with options.",
+                          UintegerValue(128),
+                          MakeUintegerAccessor(&AsyncPcapCapture::m_snapLen),
+                          MakeUintegerChecker<uint32_t>(1, 65535))
+            .AddAttribute("BufferSize",
+                          "Size in bytes of one buffer of the background writer.",
+                          UintegerValue(1 << 20),
+                          MakeUintegerAccessor(&AsyncPcapCapture::m_bufferSize),
+                          MakeUintegerChecker<uint32_t>(4096))
+            .AddAttribute("Buffers",
+                          "Full buffers, shared by all the devices, that may queue before "
+                          "the simulation waits for the disk.",
+                          UintegerValue(8),
+                          MakeUintegerAccessor(&AsyncPcapCapture::m_buffers),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("MaxFileSize",
+                          "Size in bytes after which a new file is started (0 disables "
+                          "rotation).",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&AsyncPcapCapture::m_maxFileSize),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("MaxFiles",
+                          "Number of rotated files kept per device, older ones are "
+                          "deleted (0 keeps all).",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&AsyncPcapCapture::m_maxFiles),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("Window",
+                          "Only keep the packets of this last stretch of simulated time, "
+                          "written when the capture is closed (0 keeps all).",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&AsyncPcapCapture::m_window),
+                          MakeTimeChecker(Seconds(0)))
+            .AddAttribute("WindowBytes",
+                          "Memory in bytes holding the window of all the devices; when "
+                          "full, the oldest packets are dropped first.",
+                          UintegerValue(32 << 20),
+                          MakeUintegerAccessor(&AsyncPcapCapture::m_windowBytes),
+                          MakeUintegerChecker<uint64_t>());
+    return tid;
+}
+
+AsyncPcapCapture::AsyncPcapCapture()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+AsyncPcapCapture::~AsyncPcapCapture()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+AsyncPcapCapture::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    Close();
+    Object::DoDispose();
+}
+
+void
+AsyncPcapCapture::Install(Ptr<NetDevice> device, const std::string& prefix)
+{
+    NS_LOG_FUNCTION(this << device << prefix);
+    std::string fileName = prefix + "-" + std::to_string(device->GetNode()->GetId()) + "-" +
+                           std::to_string(device->GetIfIndex());
+    m_record.resize(PCAP_RECORD_HEADER_SIZE + m_snapLen);
+    if (!m_window.IsZero() && m_ring.empty())
+    {
+        NS_ABORT_MSG_IF(m_windowBytes < sizeof(uint32_t) + m_record.size(),
+                        "WindowBytes cannot hold a single packet");
+        m_ring.resize(m_windowBytes);
+    }
+    m_captures.push_back(std::make_unique<DeviceCapture>(this, m_captures.size(), fileName));
+    bool connected =
+        device->TraceConnectWithoutContext("PromiscSniffer",
+                                           MakeCallback(&DeviceCapture::Sniff,
+                                                        m_captures.back().get()));
+    NS_ABORT_MSG_IF(!connected, "Device " << fileName << " has no PromiscSniffer trace source");
+}
+
+void
+AsyncPcapCapture::Install(const NetDeviceContainer& devices, const std::string& prefix)
+{
+    for (uint32_t i = 0; i < devices.GetN(); ++i)
+    {
+        Install(devices.Get(i), prefix);
+    }
+}
+
+void
+AsyncPcapCapture::InstallAll(const std::string& prefix)
+{
+    for (uint32_t n = 0; n < NodeList::GetNNodes(); ++n)
+    {
+        Ptr<Node> node = NodeList::GetNode(n);
+        for (uint32_t d = 0; d < node->GetNDevices(); ++d)
+        {
+            if (DynamicCast<PointToPointNetDevice>(node->GetDevice(d)))
+            {
+                Install(node->GetDevice(d), prefix);
+            }
+        }
+    }
+}
+
+void
+AsyncPcapCapture::Close()
+{
+    if (!m_writer.IsOpen())
+    {
+        return;
+    }
+    NS_LOG_FUNCTION(this);
+    // The window goes out oldest first, each record to the file of its device
+    while (m_ringUsed > 0)
+    {
+        uint8_t prefix[sizeof(uint32_t) + PCAP_RECORD_HEADER_SIZE];
+        ReadWindow(m_ringStart, prefix, sizeof(prefix));
+        uint32_t index;
+        uint32_t captured;
+        std::memcpy(&index, prefix, sizeof(index));
+        std::memcpy(&captured, prefix + sizeof(uint32_t) + 8, sizeof(captured));
+        const uint32_t size = PCAP_RECORD_HEADER_SIZE + captured;
+        ReadWindow(m_ringStart + sizeof(uint32_t), m_record.data(), size);
+        m_captures[index]->Write(m_record.data(), size);
+        PopWindow();
+    }
+    if (m_ringOverflows > 0)
+    {
+        NS_LOG_WARN(m_ringOverflows << " packets of the window did not fit in WindowBytes");
+    }
+    m_writer.Close();
+}
+
+uint32_t
+AsyncPcapCapture::OpenFile(const std::string& fileName)
+{
+    if (!m_writer.IsOpen())
+    {
+        m_writer.Open(fileName, m_bufferSize, m_buffers);
+        return 0;
+    }
+    return m_writer.AddFile(fileName);
+}
+
+void
+AsyncPcapCapture::PushWindow(uint32_t index, const uint8_t* record, uint32_t size)
+{
+    const std::size_t needed = sizeof(uint32_t) + size;
+    const int64_t oldest = (Simulator::Now() - m_window).GetMicroSeconds();
+    while (m_ringUsed > 0)
+    {
+        uint8_t prefix[sizeof(uint32_t) + 8];
+        ReadWindow(m_ringStart, prefix, sizeof(prefix));
+        uint32_t seconds;
+        uint32_t microseconds;
+        std::memcpy(&seconds, prefix + sizeof(uint32_t), sizeof(seconds));
+        std::memcpy(&microseconds, prefix + sizeof(uint32_t) + 4, sizeof(microseconds));
+        const bool expired = static_cast<int64_t>(seconds) * 1000000 + microseconds < oldest;
+        if (!expired && m_ringUsed + needed <= m_ring.size())
+        {
+            break;
+        }
+        m_ringOverflows += expired ? 0 : 1;
+        PopWindow();
+    }
+
+    std::size_t offset = (m_ringStart + m_ringUsed) % m_ring.size();
+    auto put = [this, &offset](const uint8_t* data, std::size_t count) {
+        const std::size_t first = std::min(count, m_ring.size() - offset);
+        std::memcpy(m_ring.data() + offset, data, first);
+        std::memcpy(m_ring.data(), data + first, count - first);
+        offset = (offset + count) % m_ring.size();
+    };
+    uint8_t prefix[sizeof(uint32_t)];
+    std::memcpy(prefix, &index, sizeof(index));
+    put(prefix, sizeof(prefix));
+    put(record, size);
+    m_ringUsed += needed;
+}
+
+void
+AsyncPcapCapture::PopWindow()
+{
+    uint8_t captured[sizeof(uint32_t)];
+    ReadWindow(m_ringStart + sizeof(uint32_t) + 8, captured, sizeof(captured));
+    uint32_t size;
+    std::memcpy(&size, captured, sizeof(size));
+    size += sizeof(uint32_t) + PCAP_RECORD_HEADER_SIZE;
+    m_ringStart = (m_ringStart + size) % m_ring.size();
+    m_ringUsed -= size;
+}
+
+void
+AsyncPcapCapture::ReadWindow(std::size_t offset, uint8_t* data, std::size_t size) const
+{
+    offset %= m_ring.size();
+    const std::size_t first = std::min(size, m_ring.size() - offset);
+    std::memcpy(data, m_ring.data() + offset, first);
+    std::memcpy(data + first, m_ring.data(), size - first);
+}
+
+AsyncPcapCapture::DeviceCapture::DeviceCapture(AsyncPcapCapture* owner,
+                                               uint32_t index,
+                                               const std::string& fileName)
+    : m_owner(owner),
+      m_index(index),
+      m_baseName(fileName)
+{
+    m_file = m_owner->OpenFile(GetFileName(0));
+    WriteFileHeader();
+}
+
+std::string
+AsyncPcapCapture::DeviceCapture::GetFileName(uint32_t index) const
+{
+    if (m_owner->m_maxFileSize == 0 || !m_owner->m_window.IsZero())
+    {
+        return m_baseName + ".pcap";
+    }
+    return m_baseName + "-" + std::to_string(index) + ".pcap";
+}
+
+void
+AsyncPcapCapture::DeviceCapture::WriteFileHeader()
+{
+    uint8_t header[PCAP_FILE_HEADER_SIZE];
+    PutU32(header, 0xa1b2c3d4); // microsecond timestamps
+    const uint16_t major = 2;
+    const uint16_t minor = 4;
+    std::memcpy(header + 4, &major, sizeof(major));
+    std::memcpy(header + 6, &minor, sizeof(minor));
+    PutU32(header + 8, 0);  // GMT offset
+    PutU32(header + 12, 0); // timestamp accuracy
+    PutU32(header + 16, m_owner->m_snapLen);
+    PutU32(header + 20, DLT_PPP);
+    m_owner->m_writer.Write(m_file, header, sizeof(header));
+    m_fileBytes = sizeof(header);
+}
+
+void
+AsyncPcapCapture::DeviceCapture::Sniff(Ptr<const Packet> packet)
+{
+    // The simulation is single threaded, so the devices share one scratch record
+    uint8_t* record = m_owner->m_record.data();
+    const uint32_t captured =
+        packet->CopyData(record + PCAP_RECORD_HEADER_SIZE, m_owner->m_snapLen);
+    const int64_t us = Simulator::Now().GetMicroSeconds();
+    PutU32(record, static_cast<uint32_t>(us / 1000000));
+    PutU32(record + 4, static_cast<uint32_t>(us % 1000000));
+    PutU32(record + 8, captured);
+    PutU32(record + 12, packet->GetSize());
+    const uint32_t size = PCAP_RECORD_HEADER_SIZE + captured;
+
+    if (!m_owner->m_window.IsZero())
+    {
+        m_owner->PushWindow(m_index, record, size);
+        return;
+    }
+    Write(record, size);
+}
+
+void
+AsyncPcapCapture::DeviceCapture::Write(const uint8_t* record, uint32_t size)
+{
+    if (m_owner->m_maxFileSize > 0 && m_owner->m_window.IsZero() &&
+        m_fileBytes > PCAP_FILE_HEADER_SIZE && m_fileBytes + size > m_owner->m_maxFileSize)
+    {
+        ++m_fileIndex;
+        std::string expired;
+        if (m_owner->m_maxFiles > 0 && m_fileIndex >= m_owner->m_maxFiles)
+        {
+            expired = GetFileName(m_fileIndex - m_owner->m_maxFiles);
+        }
+        m_owner->m_writer.Reopen(m_file, GetFileName(m_fileIndex), expired);
+        WriteFileHeader();
+    }
+    m_owner->m_writer.Write(m_file, record, size);
+    m_fileBytes += size;
+}
+
+} // namespace ns3
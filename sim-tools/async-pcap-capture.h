@@ -0,0 +1,170 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ASYNC_PCAP_CAPTURE_H
+#define ASYNC_PCAP_CAPTURE_H
+
+#include "async-file-writer.h"
+
+#include "ns3/net-device-container.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/packet.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Pcap capture of point-to-point devices that keeps the simulation thread off
+ * the disk.
+ *
+ * Only the first SnapLen bytes of every packet are kept (the headers, with the
+ * default), and the records of all the devices go through one AsyncFileWriter,
+ * so a capture costs one thread and Buffers buffers of BufferSize bytes
+ * however many devices it covers. Two optional modes bound what ends up on
+ * disk:
+ *
+ * - MaxFileSize rotates to a new numbered file once a file is full, and with
+ *   MaxFiles only the newest files are kept;
+ * - Window keeps the records of the last Window of simulated time in a ring of
+ *   WindowBytes, allocated once, and writes them when the capture is closed.
+ *   When the ring is full the oldest records go first, even if they are
+ *   within the window.
+ *
+ * The files are named like those of PointToPointHelper::EnablePcap,
+ * prefix-node-device.pcap, with the file number appended when rotating.
+ */
+class AsyncPcapCapture : public Object
+{
+  public:
+    AsyncPcapCapture();
+    ~AsyncPcapCapture() override;
+
+    /**
+     * Register this type.
+     * \return The TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * Capture the packets sent and received by a point-to-point device.
+     * \param device The device.
+     * \param prefix Prefix of the file name.
+     */
+    void Install(Ptr<NetDevice> device, const std::string& prefix);
+
+    /**
+     * Capture the packets of every device in a container.
+     * \param devices The devices.
+     * \param prefix Prefix of the file names.
+     */
+    void Install(const NetDeviceContainer& devices, const std::string& prefix);
+
+    /**
+     * Capture every point-to-point device of the simulation, like
+     * PointToPointHelper::EnablePcapAll.
+     * \param prefix Prefix of the file names.
+     */
+    void InstallAll(const std::string& prefix);
+
+    /// Write the pending records, the window if enabled, and close the files.
+    void Close();
+
+  private:
+    void DoDispose() override;
+
+    /// Capture state of one device.
+    class DeviceCapture
+    {
+      public:
+        /**
+         * \param owner The capture holding the configuration and the writer.
+         * \param index Index of this device in the capture.
+         * \param fileName File name without the .pcap extension.
+         */
+        DeviceCapture(AsyncPcapCapture* owner, uint32_t index, const std::string& fileName);
+
+        /// PromiscSniffer trace sink.
+        void Sniff(Ptr<const Packet> packet);
+        /**
+         * Write a record to the file, rotating it first if it is full.
+         * \param record The pcap record header and the captured bytes.
+         * \param size Size of the record.
+         */
+        void Write(const uint8_t* record, uint32_t size);
+
+      private:
+        /// \return The name of file number index.
+        std::string GetFileName(uint32_t index) const;
+        /// Write the pcap global header to the current file.
+        void WriteFileHeader();
+
+        AsyncPcapCapture* m_owner; //!< Configuration and writer.
+        uint32_t m_index;          //!< Index of this device in the capture.
+        std::string m_baseName;    //!< File name without the extension.
+        uint32_t m_file{0};        //!< Index of the file in the writer.
+        uint64_t m_fileBytes{0};   //!< Bytes in the current file.
+        uint32_t m_fileIndex{0};   //!< Number of the current file.
+    };
+
+    /**
+     * \param fileName A pcap file.
+     * \return Its index in the writer, which is opened with the first file.
+     */
+    uint32_t OpenFile(const std::string& fileName);
+
+    /**
+     * Keep a record in the window ring, dropping the records that left the
+     * window or do not leave it room.
+     * \param index Index of the device.
+     * \param record The pcap record header and the captured bytes.
+     * \param size Size of the record.
+     */
+    void PushWindow(uint32_t index, const uint8_t* record, uint32_t size);
+
+    /// Drop the oldest record of the window ring.
+    void PopWindow();
+
+    /**
+     * \param offset Offset in the ring, wrapped around.
+     * \param data Where to copy the bytes.
+     * \param size Number of bytes.
+     */
+    void ReadWindow(std::size_t offset, uint8_t* data, std::size_t size) const;
+
+    uint32_t m_snapLen;            //!< Bytes kept of every packet.
+    uint32_t m_bufferSize;         //!< Size of one writer buffer.
+    uint32_t m_buffers;            //!< Writer buffers.
+    uint64_t m_maxFileSize;        //!< Rotation size, 0 disables rotation.
+    uint32_t m_maxFiles;           //!< Rotated files kept, 0 keeps all.
+    Time m_window;                 //!< Length of the window mode, 0 disables it.
+    uint64_t m_windowBytes;        //!< Capacity of the window ring.
+    AsyncFileWriter m_writer;      //!< Output of all the devices.
+    std::vector<uint8_t> m_record; //!< Scratch record.
+    std::vector<uint8_t> m_ring;   //!< Window records, each after its device index.
+    std::size_t m_ringStart{0};    //!< Offset of the oldest record.
+    std::size_t m_ringUsed{0};     //!< Bytes of the records in the ring.
+    uint64_t m_ringOverflows{0};   //!< Records dropped within the window.
+    /// One capture per installed device.
+    std::vector<std::unique_ptr<DeviceCapture>> m_captures;
+};
+
+} // namespace ns3
+
+#endif /* ASYNC_PCAP_CAPTURE_H */
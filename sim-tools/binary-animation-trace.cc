@@ -0,0 +1,395 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "binary-animation-trace.h"
+
+#include "ns3/abort.h"
+#include "ns3/channel.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/mobility-model.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("BinaryAnimationTrace");
+
+NS_OBJECT_ENSURE_REGISTERED(BinaryAnimationTrace);
+
+namespace
+{
+
+/// Magic number at the start of a trace.
+const char ANIMATION_MAGIC[8] = {'N', 'S', '3', 'A', 'N', 'I', 'M', '1'};
+/// Size of the writer buffers.
+const std::size_t ANIMATION_BUFFER_SIZE = 256 * 1024;
+/// Number of writer buffers that may wait for the disk.
+const uint32_t ANIMATION_BUFFERS = 8;
+
+/// \return A coordinate in whole centimetres.
+int64_t
+ToCentimetres(double metres)
+{
+    return std::llround(metres * 100);
+}
+
+} // namespace
+
+TypeId
+BinaryAnimationTrace::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::BinaryAnimationTrace")
+            .SetParent<Object>()
+            .AddConstructor<BinaryAnimationTrace>()
+            .AddAttribute("PollInterval",
+                          "Period of the position polling.",
+                          TimeValue(MilliSeconds(250)),
+                          MakeTimeAccessor(&BinaryAnimationTrace::m_pollInterval),
+                          MakeTimeChecker(MilliSeconds(1)))
+            .AddAttribute("MinDistance",
+                          "Distance in metres a node must move before its position is "
+                          "recorded again.",
+                          DoubleValue(1.0),
+                          MakeDoubleAccessor(&BinaryAnimationTrace::m_minDistance),
+                          MakeDoubleChecker<double>(0))
+            .AddAttribute("PacketSampling",
+                          "Record the packets whose uid is a multiple of this value "
+                          "(1 records every packet, 0 none).",
+                          UintegerValue(100),
+                          MakeUintegerAccessor(&BinaryAnimationTrace::m_packetSampling),
+                          MakeUintegerChecker<uint32_t>());
+    return tid;
+}
+
+BinaryAnimationTrace::BinaryAnimationTrace()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+BinaryAnimationTrace::~BinaryAnimationTrace()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+BinaryAnimationTrace::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    Close();
+    Object::DoDispose();
+}
+
+void
+BinaryAnimationTrace::Start(const std::string& fileName)
+{
+    NS_LOG_FUNCTION(this << fileName);
+    m_writer.Open(fileName, ANIMATION_BUFFER_SIZE, ANIMATION_BUFFERS);
+    m_writer.Write(ANIMATION_MAGIC, sizeof(ANIMATION_MAGIC));
+    m_lastTime = Simulator::Now();
+    m_positions.assign(NodeList::GetNNodes(), NodePosition());
+
+    for (uint32_t n = 0; n < NodeList::GetNNodes(); ++n)
+    {
+        Ptr<Node> node = NodeList::GetNode(n);
+        for (uint32_t d = 0; d < node->GetNDevices(); ++d)
+        {
+            Ptr<PointToPointNetDevice> device =
+                DynamicCast<PointToPointNetDevice>(node->GetDevice(d));
+            if (!device)
+            {
+                continue;
+            }
+            // Each link is recorded once, from its lower node id
+            Ptr<Channel> channel = device->GetChannel();
+            for (std::size_t k = 0; channel && k < channel->GetNDevices(); ++k)
+            {
+                uint32_t peer = channel->GetDevice(k)->GetNode()->GetId();
+                if (peer > n)
+                {
+                    BeginRecord(AnimationRecordType::LINK);
+                    PutUnsigned(n);
+                    PutUnsigned(peer);
+                    EndRecord();
+                }
+            }
+            if (m_packetSampling > 0)
+            {
+                device->TraceConnect("PhyTxBegin",
+                                     std::to_string(n),
+                                     MakeCallback(&BinaryAnimationTrace::PacketTx, this));
+                device->TraceConnect("PhyRxEnd",
+                                     std::to_string(n),
+                                     MakeCallback(&BinaryAnimationTrace::PacketRx, this));
+            }
+        }
+    }
+    PollPositions();
+}
+
+void
+BinaryAnimationTrace::UpdateNodeDescription(uint32_t nodeId, const std::string& description)
+{
+    NS_ABORT_MSG_IF(!m_writer.IsOpen(), "Start the animation trace first");
+    BeginRecord(AnimationRecordType::NODE_DESCRIPTION);
+    PutUnsigned(nodeId);
+    PutUnsigned(description.size());
+    m_record.insert(m_record.end(), description.begin(), description.end());
+    EndRecord();
+}
+
+void
+BinaryAnimationTrace::UpdateNodeColor(uint32_t nodeId, uint8_t r, uint8_t g, uint8_t b)
+{
+    NS_ABORT_MSG_IF(!m_writer.IsOpen(), "Start the animation trace first");
+    BeginRecord(AnimationRecordType::NODE_COLOR);
+    PutUnsigned(nodeId);
+    m_record.push_back(r);
+    m_record.push_back(g);
+    m_record.push_back(b);
+    EndRecord();
+}
+
+void
+BinaryAnimationTrace::Close()
+{
+    NS_LOG_FUNCTION(this);
+    m_pollEvent.Cancel();
+    m_writer.Close();
+}
+
+void
+BinaryAnimationTrace::BeginRecord(AnimationRecordType type)
+{
+    const Time now = Simulator::Now();
+    m_record.clear();
+    m_record.push_back(static_cast<uint8_t>(type));
+    PutUnsigned((now - m_lastTime).GetNanoSeconds());
+    m_lastTime = now;
+}
+
+void
+BinaryAnimationTrace::PutUnsigned(uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        m_record.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    m_record.push_back(static_cast<uint8_t>(value));
+}
+
+void
+BinaryAnimationTrace::PutSigned(int64_t value)
+{
+    PutUnsigned((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void
+BinaryAnimationTrace::EndRecord()
+{
+    m_writer.Write(m_record.data(), m_record.size());
+}
+
+void
+BinaryAnimationTrace::PollPositions()
+{
+    const int64_t threshold = ToCentimetres(m_minDistance);
+    for (uint32_t n = 0; n < m_positions.size(); ++n)
+    {
+        Ptr<MobilityModel> mobility = NodeList::GetNode(n)->GetObject<MobilityModel>();
+        if (!mobility)
+        {
+            continue;
+        }
+        const Vector position = mobility->GetPosition();
+        const NodePosition& last = m_positions[n];
+        if (last.recorded)
+        {
+            const double dx = ToCentimetres(position.x) - last.x;
+            const double dy = ToCentimetres(position.y) - last.y;
+            const double dz = ToCentimetres(position.z) - last.z;
+            if (dx * dx + dy * dy + dz * dz <= static_cast<double>(threshold) * threshold)
+            {
+                continue;
+            }
+        }
+        RecordPosition(n, position);
+    }
+    m_pollEvent = Simulator::Schedule(m_pollInterval, &BinaryAnimationTrace::PollPositions, this);
+}
+
+void
+BinaryAnimationTrace::RecordPosition(uint32_t nodeId, const Vector& position)
+{
+    NodePosition& last = m_positions[nodeId];
+    const int64_t x = ToCentimetres(position.x);
+    const int64_t y = ToCentimetres(position.y);
+    const int64_t z = ToCentimetres(position.z);
+    BeginRecord(AnimationRecordType::NODE_POSITION);
+    PutUnsigned(nodeId);
+    PutSigned(x - last.x);
+    PutSigned(y - last.y);
+    PutSigned(z - last.z);
+    EndRecord();
+    last.recorded = true;
+    last.x = x;
+    last.y = y;
+    last.z = z;
+}
+
+void
+BinaryAnimationTrace::PacketTx(std::string context, Ptr<const Packet> packet)
+{
+    if (packet->GetUid() % m_packetSampling != 0)
+    {
+        return;
+    }
+    BeginRecord(AnimationRecordType::PACKET_TX);
+    PutUnsigned(std::stoul(context));
+    PutUnsigned(packet->GetUid());
+    EndRecord();
+}
+
+void
+BinaryAnimationTrace::PacketRx(std::string context, Ptr<const Packet> packet)
+{
+    if (packet->GetUid() % m_packetSampling != 0)
+    {
+        return;
+    }
+    BeginRecord(AnimationRecordType::PACKET_RX);
+    PutUnsigned(std::stoul(context));
+    PutUnsigned(packet->GetUid());
+    EndRecord();
+}
+
+bool
+BinaryAnimationReader::Open(const std::string& fileName)
+{
+    m_file.open(fileName, std::ios::in | std::ios::binary);
+    char magic[sizeof(ANIMATION_MAGIC)];
+    if (!m_file.read(magic, sizeof(magic)) ||
+        std::memcmp(magic, ANIMATION_MAGIC, sizeof(magic)) != 0)
+    {
+        return false;
+    }
+    m_time = 0;
+    m_positions.clear();
+    return true;
+}
+
+bool
+BinaryAnimationReader::Next(AnimationRecord& record)
+{
+    int type = m_file.get();
+    uint64_t elapsed = 0;
+    uint64_t node = 0;
+    if (type == std::char_traits<char>::eof() || !GetUnsigned(elapsed) || !GetUnsigned(node))
+    {
+        return false;
+    }
+    m_time += elapsed;
+    record.type = static_cast<AnimationRecordType>(type);
+    record.time = NanoSeconds(m_time);
+    record.node = node;
+
+    switch (record.type)
+    {
+    case AnimationRecordType::NODE_POSITION: {
+        if (node >= m_positions.size())
+        {
+            m_positions.resize(node + 1, {0, 0, 0});
+        }
+        for (auto& coordinate : m_positions[node])
+        {
+            int64_t delta = 0;
+            if (!GetSigned(delta))
+            {
+                return false;
+            }
+            coordinate += delta;
+        }
+        record.position = Vector(m_positions[node][0] / 100.0,
+                                 m_positions[node][1] / 100.0,
+                                 m_positions[node][2] / 100.0);
+        return true;
+    }
+    case AnimationRecordType::NODE_DESCRIPTION: {
+        uint64_t length = 0;
+        if (!GetUnsigned(length))
+        {
+            return false;
+        }
+        record.description.resize(length);
+        return static_cast<bool>(m_file.read(&record.description[0], length));
+    }
+    case AnimationRecordType::NODE_COLOR:
+        return static_cast<bool>(m_file.read(reinterpret_cast<char*>(record.color), 3));
+    case AnimationRecordType::LINK: {
+        uint64_t peer = 0;
+        bool ok = GetUnsigned(peer);
+        record.peer = peer;
+        return ok;
+    }
+    case AnimationRecordType::PACKET_TX:
+    case AnimationRecordType::PACKET_RX:
+        return GetUnsigned(record.uid);
+    }
+    NS_LOG_WARN("Unknown record type " << type);
+    return false;
+}
+
+bool
+BinaryAnimationReader::GetUnsigned(uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        int byte = m_file.get();
+        if (byte == std::char_traits<char>::eof())
+        {
+            return false;
+        }
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool
+BinaryAnimationReader::GetSigned(int64_t& value)
+{
+    uint64_t encoded = 0;
+    if (!GetUnsigned(encoded))
+    {
+        return false;
+    }
+    value = static_cast<int64_t>(encoded >> 1) ^ -static_cast<int64_t>(encoded & 1);
+    return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,193 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_ANIMATION_TRACE_H
+#define BINARY_ANIMATION_TRACE_H
+
+#include "async-file-writer.h"
+
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/packet.h"
+#include "ns3/vector.h"
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Layout of a binary animation trace: the magic "NS3ANIM1" followed by
+// records. Every record is a type byte, the time elapsed since the previous
+// record in nanoseconds, and the fields of its type. Unsigned integers are
+// LEB128 varints and signed ones zigzag varints; positions are in centimetres,
+// relative to the previous recorded position of the same node.
+//
+//   NODE_POSITION     node, dx, dy, dz
+//   NODE_DESCRIPTION  node, length, bytes
+//   NODE_COLOR        node, r, g, b (one byte each)
+//   LINK              node, peer
+//   PACKET_TX         node, packet uid
+//   PACKET_RX         node, packet uid
+
+namespace ns3
+{
+
+/// Record types of a binary animation trace.
+enum class AnimationRecordType : uint8_t
+{
+    NODE_POSITION = 1,    //!< A node moved.
+    NODE_DESCRIPTION = 2, //!< A node got a description.
+    NODE_COLOR = 3,       //!< A node got a color.
+    LINK = 4,             //!< A point-to-point link between two nodes.
+    PACKET_TX = 5,        //!< A sampled packet started transmission.
+    PACKET_RX = 6         //!< A sampled packet was received.
+};
+
+/**
+ * Compact replacement of AnimationInterface for large runs.
+ *
+ * The positions of all nodes are polled every PollInterval but a node is only
+ * recorded when it moved more than MinDistance since its last record, so the
+ * static eNBs, core nodes and hosts cost one record each. Of the packets on
+ * point-to-point links, only those whose uid is a multiple of PacketSampling
+ * are recorded, at both ends. Records go to disk through an AsyncFileWriter.
+ *
+ * The trace is converted to NetAnim XML offline by anim-to-netanim, so only the
+ * runs that are actually viewed pay for the XML.
+ */
+class BinaryAnimationTrace : public Object
+{
+  public:
+    BinaryAnimationTrace();
+    ~BinaryAnimationTrace() override;
+
+    /**
+     * Register this type.
+     * \return The TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * Open the trace, record the links and the initial positions, and start
+     * polling. Call once all nodes and devices exist.
+     * \param fileName The trace file.
+     */
+    void Start(const std::string& fileName);
+
+    /**
+     * \param nodeId The node.
+     * \param description Text shown next to the node.
+     */
+    void UpdateNodeDescription(uint32_t nodeId, const std::string& description);
+
+    /**
+     * \param nodeId The node.
+     * \param r Red component.
+     * \param g Green component.
+     * \param b Blue component.
+     */
+    void UpdateNodeColor(uint32_t nodeId, uint8_t r, uint8_t g, uint8_t b);
+
+    /// Stop polling and close the trace.
+    void Close();
+
+  private:
+    void DoDispose() override;
+
+    /// Last recorded position of a node, in centimetres.
+    struct NodePosition
+    {
+        bool recorded{false}; //!< Whether the node has a position yet.
+        int64_t x{0};         //!< X.
+        int64_t y{0};         //!< Y.
+        int64_t z{0};         //!< Z.
+    };
+
+    /// Start a record of the given type at the current time.
+    void BeginRecord(AnimationRecordType type);
+    /// Append an unsigned varint to the record.
+    void PutUnsigned(uint64_t value);
+    /// Append a signed (zigzag) varint to the record.
+    void PutSigned(int64_t value);
+    /// Hand the record over to the writer.
+    void EndRecord();
+
+    /// Record the nodes that moved far enough and schedule the next poll.
+    void PollPositions();
+    /// Record the position of a node.
+    void RecordPosition(uint32_t nodeId, const Vector& position);
+    /// PhyTxBegin trace sink; the context is the node id.
+    void PacketTx(std::string context, Ptr<const Packet> packet);
+    /// PhyRxEnd trace sink; the context is the node id.
+    void PacketRx(std::string context, Ptr<const Packet> packet);
+
+    Time m_pollInterval;                   //!< Position polling period.
+    double m_minDistance;                  //!< Movement that triggers a record.
+    uint32_t m_packetSampling;             //!< 1 in this many packets is recorded.
+    AsyncFileWriter m_writer;              //!< Output of the records.
+    std::vector<uint8_t> m_record;         //!< Record being built.
+    Time m_lastTime;                       //!< Time of the previous record.
+    std::vector<NodePosition> m_positions; //!< Last recorded positions.
+    EventId m_pollEvent;                   //!< Next position poll.
+};
+
+/// One decoded record of a binary animation trace.
+struct AnimationRecord
+{
+    /// Record type.
+    AnimationRecordType type{AnimationRecordType::NODE_POSITION};
+    Time time;                 //!< Simulation time.
+    uint32_t node{0};          //!< Node of the record.
+    uint32_t peer{0};          //!< Other end of a LINK.
+    Vector position;           //!< Absolute position in metres.
+    std::string description;   //!< NODE_DESCRIPTION text.
+    uint8_t color[3]{0, 0, 0}; //!< NODE_COLOR components.
+    uint64_t uid{0};           //!< Packet uid.
+};
+
+/// Sequential reader of the traces written by BinaryAnimationTrace.
+class BinaryAnimationReader
+{
+  public:
+    /**
+     * Open a trace and check its magic.
+     * \param fileName The trace file.
+     * \return False if the file is missing or is not an animation trace.
+     */
+    bool Open(const std::string& fileName);
+
+    /**
+     * Decode the next record, with absolute time and position.
+     * \param record The decoded record.
+     * \return False at the end of the trace or on a truncated record.
+     */
+    bool Next(AnimationRecord& record);
+
+  private:
+    /// Read an unsigned varint.
+    bool GetUnsigned(uint64_t& value);
+    /// Read a signed (zigzag) varint.
+    bool GetSigned(int64_t& value);
+
+    std::ifstream m_file;                            //!< The trace.
+    int64_t m_time{0};                               //!< Time of the previous record, ns.
+    std::vector<std::array<int64_t, 3>> m_positions; //!< Last positions, cm.
+};
+
+} // namespace ns3
+
+#endif /* BINARY_ANIMATION_TRACE_H */
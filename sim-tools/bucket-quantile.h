@@ -0,0 +1,68 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BUCKET_QUANTILE_H
+#define BUCKET_QUANTILE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Quantile of a bucketed distribution, interpolated linearly within the
+ * bucket that holds its rank. The last bucket also holds the overflow and
+ * has no upper edge, so the largest sample bounds it, as it bounds the result.
+ *
+ * \param counts Samples per bucket.
+ * \param count Total of the counts.
+ * \param max Largest sample.
+ * \param q The quantile, in [0, 1].
+ * \param bucketStart Lower edge of a bucket, from its index.
+ * \return The estimated quantile, 0 without samples.
+ */
+template <typename BucketStart>
+double
+GetBucketQuantile(const std::vector<uint64_t>& counts,
+                  uint64_t count,
+                  double max,
+                  double q,
+                  BucketStart bucketStart)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    const double rank = std::clamp(q, 0.0, 1.0) * count;
+    uint64_t below = 0;
+    for (uint32_t i = 0; i < counts.size(); ++i)
+    {
+        if (counts[i] > 0 && below + counts[i] >= rank)
+        {
+            const double start = bucketStart(i);
+            const double end = i + 1 < counts.size() ? bucketStart(i + 1) : std::max(start, max);
+            const double fraction = (rank - below) / counts[i];
+            return std::min(start + fraction * (end - start), max);
+        }
+        below += counts[i];
+    }
+    return max;
+}
+
+} // namespace ns3
+
+#endif /* BUCKET_QUANTILE_H */
@@ -0,0 +1,319 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "burst-udp-client.h"
+
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/seq-ts-header.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("BurstUdpClient");
+
+NS_OBJECT_ENSURE_REGISTERED(BurstUdpClient);
+
+TypeId
+BurstUdpClient::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::BurstUdpClient")
+            .SetParent<Application>()
+            .AddConstructor<BurstUdpClient>()
+            .AddAttribute("RemoteAddress",
+                          "The destination address of the datagrams.",
+                          AddressValue(),
+                          MakeAddressAccessor(&BurstUdpClient::m_peerAddress),
+                          MakeAddressChecker())
+            .AddAttribute("RemotePort",
+                          "The destination port of the datagrams.",
+                          UintegerValue(100),
+                          MakeUintegerAccessor(&BurstUdpClient::m_peerPort),
+                          MakeUintegerChecker<uint16_t>())
+            .AddAttribute("PacketSize",
+                          "Size of the datagrams, SeqTsHeader included [bytes].",
+                          UintegerValue(1024),
+                          MakeUintegerAccessor(&BurstUdpClient::m_size),
+                          MakeUintegerChecker<uint32_t>(12, 65507))
+            .AddAttribute("MaxPackets",
+                          "The number of datagrams to send, 0 for no limit.",
+                          UintegerValue(100),
+                          MakeUintegerAccessor(&BurstUdpClient::m_maxPackets),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("Interval",
+                          "The mean time between datagrams.",
+                          TimeValue(Seconds(1)),
+                          MakeTimeAccessor(&BurstUdpClient::m_interval),
+                          MakeTimeChecker())
+            .AddAttribute("BurstSize",
+                          "Datagrams sent per event; TraceFile lines may override it.",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&BurstUdpClient::m_burstSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("Schedule",
+                          "When the bursts are sent.",
+                          EnumValue(BurstUdpClient::CBR),
+                          MakeEnumAccessor(&BurstUdpClient::m_schedule),
+                          MakeEnumChecker(BurstUdpClient::CBR,
+                                          "cbr",
+                                          BurstUdpClient::POISSON,
+                                          "poisson",
+                                          BurstUdpClient::TRACE,
+                                          "trace"))
+            .AddAttribute("TraceFile",
+                          "Bursts of the trace schedule, one \"<seconds after start> "
+                          "[datagrams]\" line each, in time order; # starts a comment.",
+                          StringValue(""),
+                          MakeStringAccessor(&BurstUdpClient::m_traceFile),
+                          MakeStringChecker())
+            .AddTraceSource("Tx",
+                            "A datagram is sent.",
+                            MakeTraceSourceAccessor(&BurstUdpClient::m_txTrace),
+                            "ns3::Packet::TracedCallback");
+    return tid;
+}
+
+BurstUdpClient::BurstUdpClient()
+{
+    NS_LOG_FUNCTION(this);
+    m_gap = CreateObject<ExponentialRandomVariable>();
+}
+
+BurstUdpClient::~BurstUdpClient()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+int64_t
+BurstUdpClient::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+    m_gap->SetStream(stream);
+    return 1;
+}
+
+uint64_t
+BurstUdpClient::GetSent() const
+{
+    return m_sent;
+}
+
+uint64_t
+BurstUdpClient::GetTotalTx() const
+{
+    return m_totalTx;
+}
+
+void
+BurstUdpClient::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_socket = nullptr;
+    m_payload = nullptr;
+    m_gap = nullptr;
+    Application::DoDispose();
+}
+
+void
+BurstUdpClient::LoadTrace()
+{
+    m_trace.clear();
+    std::ifstream is(m_traceFile);
+    NS_ABORT_MSG_IF(!is, "Cannot read burst trace " << m_traceFile);
+    std::string line;
+    while (std::getline(is, line))
+    {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        double seconds;
+        if (!(fields >> seconds))
+        {
+            continue;
+        }
+        uint32_t datagrams = m_burstSize;
+        fields >> datagrams;
+        NS_ABORT_MSG_IF(!m_trace.empty() && Seconds(seconds) < m_trace.back().first,
+                        "Burst trace " << m_traceFile << " is not in time order");
+        m_trace.emplace_back(Seconds(seconds), datagrams);
+    }
+    NS_LOG_INFO(m_trace.size() << " bursts in " << m_traceFile);
+}
+
+void
+BurstUdpClient::StartApplication()
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_socket)
+    {
+        m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+        if (Ipv4Address::IsMatchingType(m_peerAddress))
+        {
+            NS_ABORT_MSG_IF(m_socket->Bind() == -1, "Failed to bind socket");
+            m_socket->Connect(
+                InetSocketAddress(Ipv4Address::ConvertFrom(m_peerAddress), m_peerPort));
+        }
+        else
+        {
+            NS_ABORT_MSG_IF(!InetSocketAddress::IsMatchingType(m_peerAddress),
+                            "Unsupported remote address");
+            NS_ABORT_MSG_IF(m_socket->Bind() == -1, "Failed to bind socket");
+            m_socket->Connect(m_peerAddress);
+        }
+        m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+        m_socket->SetAllowBroadcast(true);
+    }
+
+    // SeqTsHeader is 12 bytes; the rest of every datagram is this template
+    m_payload = Create<Packet>(m_size - SeqTsHeader().GetSerializedSize());
+    m_gap->SetAttribute("Mean", DoubleValue(GetBurstInterval().GetSeconds()));
+    if (m_schedule == TRACE)
+    {
+        LoadTrace();
+    }
+    m_start = Simulator::Now();
+    m_traceIndex = 0;
+    Time first;
+    if (m_schedule == TRACE)
+    {
+        if (m_trace.empty())
+        {
+            return;
+        }
+        first = m_trace.front().first;
+    }
+    m_sendEvent = Simulator::Schedule(first, &BurstUdpClient::SendBurst, this);
+}
+
+void
+BurstUdpClient::StopApplication()
+{
+    NS_LOG_FUNCTION(this);
+    Simulator::Cancel(m_sendEvent);
+}
+
+Time
+BurstUdpClient::GetBurstInterval() const
+{
+    return m_interval * static_cast<int64_t>(m_burstSize);
+}
+
+Time
+BurstUdpClient::NextBurst(Time now)
+{
+    switch (m_schedule)
+    {
+    case CBR:
+        return now + GetBurstInterval();
+    case POISSON:
+        return now + Seconds(m_gap->GetValue());
+    case TRACE:
+        if (m_traceIndex < m_trace.size())
+        {
+            return std::max(now, m_start + m_trace[m_traceIndex].first);
+        }
+        return Seconds(-1);
+    }
+    return Seconds(-1);
+}
+
+void
+BurstUdpClient::SendBurst()
+{
+    NS_LOG_FUNCTION(this);
+    uint64_t datagrams = m_schedule == TRACE ? m_trace[m_traceIndex++].second : m_burstSize;
+    if (m_maxPackets > 0)
+    {
+        datagrams = std::min(datagrams, m_maxPackets - m_sent);
+    }
+
+    // One header per burst: the timestamp is now, only the sequence changes
+    SeqTsHeader header;
+    for (uint64_t i = 0; i < datagrams; ++i)
+    {
+        header.SetSeq(m_seq);
+        Ptr<Packet> packet = m_payload->Copy();
+        packet->AddHeader(header);
+        if (m_socket->Send(packet) < 0)
+        {
+            NS_LOG_INFO("Error while sending datagram " << m_seq);
+            continue;
+        }
+        m_txTrace(packet);
+        ++m_seq;
+        ++m_sent;
+        m_totalTx += packet->GetSize();
+    }
+    NS_LOG_INFO("Sent " << datagrams << " datagrams to " << m_peerAddress << " at "
+                        << Simulator::Now().As(Time::S));
+
+    if (m_maxPackets > 0 && m_sent >= m_maxPackets)
+    {
+        return;
+    }
+    const Time next = NextBurst(Simulator::Now());
+    if (!next.IsNegative())
+    {
+        m_sendEvent =
+            Simulator::Schedule(next - Simulator::Now(), &BurstUdpClient::SendBurst, this);
+    }
+}
+
+BurstUdpClientHelper::BurstUdpClientHelper(const Address& address, uint16_t port)
+{
+    m_factory.SetTypeId(BurstUdpClient::GetTypeId());
+    m_factory.Set("RemoteAddress", AddressValue(address));
+    m_factory.Set("RemotePort", UintegerValue(port));
+}
+
+void
+BurstUdpClientHelper::SetAttribute(const std::string& name, const AttributeValue& value)
+{
+    m_factory.Set(name, value);
+}
+
+ApplicationContainer
+BurstUdpClientHelper::Install(NodeContainer nodes) const
+{
+    ApplicationContainer apps;
+    for (auto it = nodes.Begin(); it != nodes.End(); ++it)
+    {
+        apps.Add(Install(*it));
+    }
+    return apps;
+}
+
+ApplicationContainer
+BurstUdpClientHelper::Install(Ptr<Node> node) const
+{
+    Ptr<Application> app = m_factory.Create<Application>();
+    node->AddApplication(app);
+    return ApplicationContainer(app);
+}
+
+} // namespace ns3
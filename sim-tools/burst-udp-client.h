@@ -0,0 +1,165 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BURST_UDP_CLIENT_H
+#define BURST_UDP_CLIENT_H
+
+#include "ns3/address.h"
+#include "ns3/application-container.h"
+#include "ns3/application.h"
+#include "ns3/event-id.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/object-factory.h"
+#include "ns3/packet.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/socket.h"
+#include "ns3/traced-callback.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * UDP source sending datagrams in bursts, one simulator event per burst.
+ *
+ * Every datagram carries a SeqTsHeader with a per-flow sequence number, like
+ * UdpClient, so UdpServer counts losses and delays the same way; the
+ * timestamp is the emission time of the burst. The payload is one
+ * zero-filled template packet created at start and copied for every
+ * datagram, and the header of a burst is built once and only renumbered.
+ *
+ * Interval is the mean gap between datagrams, so a burst of BurstSize
+ * datagrams is sent every BurstSize * Interval and the offered load does not
+ * depend on the burst size. The bursts follow a constant rate, Poisson
+ * arrivals or the times listed in TraceFile.
+ */
+class BurstUdpClient : public Application
+{
+  public:
+    /// When the bursts are sent.
+    enum Schedule
+    {
+        CBR,     //!< Every BurstSize * Interval.
+        POISSON, //!< Exponential gaps of mean BurstSize * Interval.
+        TRACE    //!< At the times of TraceFile.
+    };
+
+    BurstUdpClient();
+    ~BurstUdpClient() override;
+
+    /**
+     * Register this type.
+     * \return The TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * \param stream The first stream index to use.
+     * \return The number of streams used.
+     */
+    int64_t AssignStreams(int64_t stream) override;
+
+    /// \return The number of datagrams sent.
+    uint64_t GetSent() const;
+
+    /// \return The bytes sent.
+    uint64_t GetTotalTx() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    void StartApplication() override;
+    void StopApplication() override;
+
+    /// Read TraceFile into m_trace.
+    void LoadTrace();
+
+    /// \return The mean time between bursts, BurstSize * Interval.
+    Time GetBurstInterval() const;
+
+    /// Send a burst and schedule the next one.
+    void SendBurst();
+
+    /**
+     * \param now Time of the burst being sent.
+     * \return Time of the next burst, negative if there is none.
+     */
+    Time NextBurst(Time now);
+
+    Address m_peerAddress;                          //!< Remote address.
+    uint16_t m_peerPort;                            //!< Remote port.
+    uint32_t m_size;                                //!< Datagram size, header included.
+    uint64_t m_maxPackets;                          //!< Datagrams to send, 0 for unlimited.
+    Time m_interval;                                //!< Mean gap between datagrams.
+    uint32_t m_burstSize;                           //!< Datagrams per burst.
+    Schedule m_schedule;                            //!< Burst schedule.
+    std::string m_traceFile;                        //!< Burst times of TRACE.
+    Ptr<ExponentialRandomVariable> m_gap;           //!< Burst gaps of POISSON.
+    Ptr<Socket> m_socket;                           //!< The socket.
+    Ptr<Packet> m_payload;                          //!< Payload copied by every datagram.
+    std::vector<std::pair<Time, uint32_t>> m_trace; //!< Offset and size of the TRACE bursts.
+    std::size_t m_traceIndex{0};                    //!< Next TRACE burst.
+    Time m_start;                                   //!< When the application started.
+    EventId m_sendEvent;                            //!< Next burst.
+    uint32_t m_seq{0};                              //!< Next sequence number.
+    uint64_t m_sent{0};                             //!< Datagrams sent.
+    uint64_t m_totalTx{0};                          //!< Bytes sent.
+
+    TracedCallback<Ptr<const Packet>> m_txTrace; //!< Every datagram.
+};
+
+/**
+ * Installs BurstUdpClient, like UdpClientHelper.
+ */
+class BurstUdpClientHelper
+{
+  public:
+    /**
+     * \param address The remote address.
+     * \param port The remote port.
+     */
+    BurstUdpClientHelper(const Address& address, uint16_t port);
+
+    /**
+     * Set an attribute of the applications to install.
+     * \param name The attribute name.
+     * \param value The attribute value.
+     */
+    void SetAttribute(const std::string& name, const AttributeValue& value);
+
+    /**
+     * \param nodes The nodes.
+     * \return One application per node.
+     */
+    ApplicationContainer Install(NodeContainer nodes) const;
+
+    /**
+     * \param node The node.
+     * \return The application.
+     */
+    ApplicationContainer Install(Ptr<Node> node) const;
+
+  private:
+    ObjectFactory m_factory; //!< Application factory.
+};
+
+} // namespace ns3
+
+#endif /* BURST_UDP_CLIENT_H */
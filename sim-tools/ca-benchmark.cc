@@ -0,0 +1,146 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measures what carrier aggregation costs and gains in lte-full-v2-complete,
+// over the number of component carriers and the carrier managers, e.g.
+//
+//   ./ns3 run "ca-benchmark --program=build/scratch/ns3.40-lte-full-v2-complete-default
+//              --carriers=1,2,3,4,5 --runs=3"
+//
+// Every point reports the throughput scheduled on each carrier and in total,
+// the executed events per wall second, the peak RSS and the wall time. Runs
+// are sequential by default so they do not compete for cores and memory
+// bandwidth, which would distort the cost columns.
+
+#include "parameter-sweep.h"
+
+#include "ns3/core-module.h"
+
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("CaBenchmark");
+
+namespace
+{
+
+/// \return The mean of a metric over the results, NaN if no result has it.
+double
+Mean(const std::vector<const SweepResult*>& results, const std::string& metric)
+{
+    double sum = 0;
+    uint32_t count = 0;
+    for (const SweepResult* result : results)
+    {
+        auto it = result->metrics.find(metric);
+        if (it != result->metrics.end())
+        {
+            sum += it->second;
+            ++count;
+        }
+    }
+    return count > 0 ? sum / count : std::numeric_limits<double>::quiet_NaN();
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    std::string program;
+    std::string carriers = "1,2,3,4,5";
+    std::string managers = "ns3::LoadAwareComponentCarrierManager,ns3::RrComponentCarrierManager,"
+                           "ns3::NoOpComponentCarrierManager";
+    std::string fixedArgs = "--simTime=5";
+    std::string outputDir = "ca-benchmark";
+    std::string table = "ca-benchmark.csv";
+    uint32_t runs = 1;
+    uint32_t threads = 1;
+
+    CommandLine cmd;
+    cmd.AddValue("program", "lte-full-v2-complete binary", program);
+    cmd.AddValue("carriers", "Comma separated numbers of component carriers", carriers);
+    cmd.AddValue("managers", "Comma separated component carrier manager types", managers);
+    cmd.AddValue("args", "Space separated arguments passed to every run", fixedArgs);
+    cmd.AddValue("outputDir", "Directory holding one sub-directory per run", outputDir);
+    cmd.AddValue("table", "Full result table", table);
+    cmd.AddValue("runs", "Number of RngRun values per point", runs);
+    cmd.AddValue("threads", "Parallel runs (1 keeps the cost columns comparable)", threads);
+    cmd.Parse(argc, argv);
+
+    ParameterSweep sweep;
+    if (program.empty() ||
+        !sweep.AddGrid("numberOfCarriers=" + carriers + ";ccManager=" + managers))
+    {
+        std::cerr << "A --program and valid --carriers and --managers are required\n";
+        return 1;
+    }
+    sweep.SetProgram(program);
+    sweep.SetOutputDirectory(outputDir);
+    sweep.SetRuns(1, runs);
+    sweep.SetThreads(threads);
+    // Only the simulation itself is measured: no pcaps, animation or XML
+    for (const char* arg :
+         {"--useCa=true", "--pcapMode=none", "--animFormat=none", "--flowmonFormat=columnar"})
+    {
+        sweep.AddFixedArgument(arg);
+    }
+    std::istringstream args(fixedArgs);
+    for (std::string arg; args >> arg;)
+    {
+        sweep.AddFixedArgument(arg);
+    }
+
+    std::vector<SweepResult> results = sweep.Run(sweep.Expand());
+    ParameterSweep::WriteTable(results, table);
+
+    // Average the seeds of every point
+    std::map<std::vector<std::pair<std::string, std::string>>, std::vector<const SweepResult*>>
+        points;
+    uint32_t failed = 0;
+    for (const auto& result : results)
+    {
+        if (result.exitCode != 0)
+        {
+            ++failed;
+            continue;
+        }
+        points[result.point.params].push_back(&result);
+    }
+
+    std::cout << std::left << std::setw(6) << "CCs" << std::setw(40) << "manager" << std::right
+              << std::setw(14) << "DL kb/s" << std::setw(14) << "UL kb/s" << std::setw(14)
+              << "events/s" << std::setw(12) << "RSS KiB" << std::setw(10) << "wall s"
+              << "\n";
+    for (const auto& [params, point] : points)
+    {
+        std::cout << std::left << std::setw(6) << params[0].second << std::setw(40)
+                  << params[1].second << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(14) << Mean(point, "ccDlThroughputKbps_all") << std::setw(14)
+                  << Mean(point, "ccUlThroughputKbps_all") << std::setw(14)
+                  << Mean(point, "eventsPerWallSecond") << std::setw(12)
+                  << Mean(point, "peakRssKb") << std::setprecision(2) << std::setw(10)
+                  << Mean(point, "runWallSeconds") << "\n";
+        std::cout.unsetf(std::ios::floatfield);
+    }
+    std::cout << results.size() << " runs, " << failed << " failed, per-carrier columns in "
+              << table << "\n";
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,198 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "cached-propagation-loss-model.h"
+
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/object-factory.h"
+#include "ns3/type-id.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("CachedPropagationLossModel");
+
+NS_OBJECT_ENSURE_REGISTERED(CachedPropagationLossModel);
+
+TypeId
+CachedPropagationLossModel::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::CachedPropagationLossModel")
+            .SetParent<PropagationLossModel>()
+            .SetGroupName("Propagation")
+            .AddConstructor<CachedPropagationLossModel>()
+            .AddAttribute("ModelType",
+                          "Type of the deterministic model computing the losses.",
+                          TypeIdValue(FriisPropagationLossModel::GetTypeId()),
+                          MakeTypeIdAccessor(&CachedPropagationLossModel::m_modelType),
+                          MakeTypeIdChecker())
+            .AddAttribute("Frequency",
+                          "Carrier frequency [Hz] passed on to the model, if it has such an "
+                          "attribute; 0 keeps the default of the model.",
+                          DoubleValue(0),
+                          MakeDoubleAccessor(&CachedPropagationLossModel::SetFrequency,
+                                             &CachedPropagationLossModel::GetFrequency),
+                          MakeDoubleChecker<double>(0));
+    return tid;
+}
+
+CachedPropagationLossModel::CachedPropagationLossModel()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+CachedPropagationLossModel::~CachedPropagationLossModel()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+CachedPropagationLossModel::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_model = nullptr;
+    m_cache.clear();
+    for (auto& [key, node] : m_nodes)
+    {
+        node.mobility->TraceDisconnectWithoutContext(
+            "CourseChange",
+            MakeCallback(&CachedPropagationLossModel::CourseChanged, this));
+    }
+    m_nodes.clear();
+    PropagationLossModel::DoDispose();
+}
+
+void
+CachedPropagationLossModel::SetFrequency(double frequency)
+{
+    NS_LOG_FUNCTION(this << frequency);
+    m_frequency = frequency;
+    if (m_model && m_frequency > 0)
+    {
+        m_model->SetAttributeFailSafe("Frequency", DoubleValue(m_frequency));
+        m_cache.clear();
+    }
+}
+
+double
+CachedPropagationLossModel::GetFrequency() const
+{
+    return m_frequency;
+}
+
+Ptr<PropagationLossModel>
+CachedPropagationLossModel::GetModel() const
+{
+    if (!m_model)
+    {
+        ObjectFactory factory;
+        factory.SetTypeId(m_modelType);
+        m_model = factory.Create<PropagationLossModel>();
+        if (m_frequency > 0 &&
+            !m_model->SetAttributeFailSafe("Frequency", DoubleValue(m_frequency)))
+        {
+            NS_LOG_WARN(m_modelType.GetName() << " has no Frequency attribute");
+        }
+    }
+    return m_model;
+}
+
+uint64_t
+CachedPropagationLossModel::GetHits() const
+{
+    return m_hits;
+}
+
+uint64_t
+CachedPropagationLossModel::GetMisses() const
+{
+    return m_misses;
+}
+
+bool
+CachedPropagationLossModel::IsStatic(Ptr<const MobilityModel> mobility)
+{
+    const Vector velocity = mobility->GetVelocity();
+    return velocity.x == 0 && velocity.y == 0 && velocity.z == 0;
+}
+
+const CachedPropagationLossModel::Node*
+CachedPropagationLossModel::GetNode(Ptr<MobilityModel> mobility) const
+{
+    auto [it, inserted] = m_nodes.try_emplace(PeekPointer(mobility));
+    if (inserted)
+    {
+        it->second.mobility = mobility;
+        mobility->TraceConnectWithoutContext(
+            "CourseChange",
+            MakeCallback(&CachedPropagationLossModel::CourseChanged, this));
+    }
+    return &it->second;
+}
+
+void
+CachedPropagationLossModel::CourseChanged(Ptr<const MobilityModel> mobility) const
+{
+    // Entries of the node no longer match its generation; they are
+    // overwritten when the pair is next computed
+    auto it = m_nodes.find(PeekPointer(mobility));
+    if (it != m_nodes.end())
+    {
+        ++it->second.generation;
+    }
+}
+
+double
+CachedPropagationLossModel::DoCalcRxPower(double txPowerDbm,
+                                          Ptr<MobilityModel> a,
+                                          Ptr<MobilityModel> b) const
+{
+    if (!IsStatic(a) || !IsStatic(b))
+    {
+        ++m_misses;
+        return GetModel()->CalcRxPower(txPowerDbm, a, b);
+    }
+    // One lookup per call: the entry points at the records of both nodes,
+    // whose addresses are stable in the node-based map
+    Entry& entry = m_cache[{PeekPointer(a), PeekPointer(b)}];
+    if (entry.nodeA && entry.generationA == entry.nodeA->generation &&
+        entry.generationB == entry.nodeB->generation)
+    {
+        ++m_hits;
+        return txPowerDbm - entry.lossDb;
+    }
+    ++m_misses;
+    if (!entry.nodeA)
+    {
+        entry.nodeA = GetNode(a);
+        entry.nodeB = GetNode(b);
+    }
+    const double rxPowerDbm = GetModel()->CalcRxPower(txPowerDbm, a, b);
+    entry.lossDb = txPowerDbm - rxPowerDbm;
+    entry.generationA = entry.nodeA->generation;
+    entry.generationB = entry.nodeB->generation;
+    return rxPowerDbm;
+}
+
+int64_t
+CachedPropagationLossModel::DoAssignStreams(int64_t stream)
+{
+    return GetModel()->AssignStreams(stream);
+}
+
+} // namespace ns3
@@ -0,0 +1,141 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef CACHED_PROPAGATION_LOSS_MODEL_H
+#define CACHED_PROPAGATION_LOSS_MODEL_H
+
+#include "ns3/mobility-model.h"
+#include "ns3/propagation-loss-model.h"
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+namespace ns3
+{
+
+/**
+ * Propagation loss model that remembers the loss of every pair of static
+ * nodes, so a spectrum channel computes it once per pair instead of once per
+ * transmission and receiver.
+ *
+ * The loss is computed by a model of type ModelType, created with its default
+ * attributes; a Frequency set on the cache, as LteHelper does for the uplink
+ * and downlink pathloss models, is passed on to it. A cached loss is reused as
+ * long as neither node reports a CourseChange; a node with a non-zero velocity
+ * moves between course changes, so its pairs bypass the cache. The inner model
+ * must be deterministic for a given pair of positions: Friis, log-distance,
+ * the Okumura-Hata and COST-231 models or BuildingsPropagationLossModel
+ * subclasses, whose shadowing is already fixed per pair.
+ */
+class CachedPropagationLossModel : public PropagationLossModel
+{
+  public:
+    CachedPropagationLossModel();
+    ~CachedPropagationLossModel() override;
+
+    /**
+     * Register this type.
+     * \return The TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /// \return The model computing the losses.
+    Ptr<PropagationLossModel> GetModel() const;
+
+    /// \return The number of losses served from the cache.
+    uint64_t GetHits() const;
+
+    /// \return The number of losses computed by the model.
+    uint64_t GetMisses() const;
+
+  private:
+    void DoDispose() override;
+    double DoCalcRxPower(double txPowerDbm,
+                         Ptr<MobilityModel> a,
+                         Ptr<MobilityModel> b) const override;
+    int64_t DoAssignStreams(int64_t stream) override;
+
+    /// A node subscribed to, and the number of its course changes.
+    struct Node
+    {
+        Ptr<MobilityModel> mobility; //!< The node, disconnected on dispose.
+        uint64_t generation{0};      //!< Course changes since the subscription.
+    };
+
+    /// A cached loss and the course generations of the pair it was computed for.
+    struct Entry
+    {
+        const Node* nodeA{nullptr}; //!< Transmitter, null until the loss is computed.
+        const Node* nodeB{nullptr}; //!< Receiver, null until the loss is computed.
+        double lossDb{0};           //!< Loss of the pair [dB].
+        uint64_t generationA{0};    //!< Generation of the transmitter.
+        uint64_t generationB{0};    //!< Generation of the receiver.
+    };
+
+    /// Key of a pair of nodes, transmitter first.
+    using Pair = std::pair<const MobilityModel*, const MobilityModel*>;
+
+    /// Hash of a pair of nodes.
+    struct PairHash
+    {
+        /**
+         * \param pair A pair of nodes.
+         * \return The hash of the pair.
+         */
+        std::size_t operator()(const Pair& pair) const
+        {
+            const std::hash<const void*> hash;
+            return hash(pair.first) ^ (hash(pair.second) * 0x9e3779b97f4a7c15ULL);
+        }
+    };
+
+    /**
+     * \param frequency Carrier frequency [Hz], 0 keeps the one of the model.
+     */
+    void SetFrequency(double frequency);
+    /// \return The carrier frequency [Hz].
+    double GetFrequency() const;
+
+    /**
+     * \param mobility A node.
+     * \return The record of the node; the first call subscribes to its
+     *         course changes. The record stays at the same address until
+     *         DoDispose.
+     */
+    const Node* GetNode(Ptr<MobilityModel> mobility) const;
+
+    /// CourseChange sink.
+    void CourseChanged(Ptr<const MobilityModel> mobility) const;
+
+    /// \return Whether the node is at rest.
+    static bool IsStatic(Ptr<const MobilityModel> mobility);
+
+    TypeId m_modelType;                        //!< Type of the inner model.
+    double m_frequency;                        //!< Frequency passed to the inner model.
+    mutable Ptr<PropagationLossModel> m_model; //!< Inner model, created on first use.
+    /// Nodes subscribed to, by mobility model.
+    mutable std::unordered_map<const MobilityModel*, Node> m_nodes;
+    /// Cached losses by transmitter and receiver.
+    mutable std::unordered_map<Pair, Entry, PairHash> m_cache;
+    mutable uint64_t m_hits{0};   //!< Losses served from the cache.
+    mutable uint64_t m_misses{0}; //!< Losses computed by the model.
+};
+
+} // namespace ns3
+
+#endif /* CACHED_PROPAGATION_LOSS_MODEL_H */
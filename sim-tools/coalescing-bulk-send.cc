@@ -0,0 +1,262 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "coalescing-bulk-send.h"
+
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("CoalescingBulkSendApplication");
+
+NS_OBJECT_ENSURE_REGISTERED(CoalescingBulkSendApplication);
+
+TypeId
+CoalescingBulkSendApplication::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::CoalescingBulkSendApplication")
+            .SetParent<Application>()
+            .AddConstructor<CoalescingBulkSendApplication>()
+            .AddAttribute("Remote",
+                          "The address of the destination.",
+                          AddressValue(),
+                          MakeAddressAccessor(&CoalescingBulkSendApplication::m_peer),
+                          MakeAddressChecker())
+            .AddAttribute("Local",
+                          "The address to bind to, any if not set.",
+                          AddressValue(),
+                          MakeAddressAccessor(&CoalescingBulkSendApplication::m_local),
+                          MakeAddressChecker())
+            .AddAttribute("Protocol",
+                          "The type of protocol to use.",
+                          TypeIdValue(TcpSocketFactory::GetTypeId()),
+                          MakeTypeIdAccessor(&CoalescingBulkSendApplication::m_tid),
+                          MakeTypeIdChecker())
+            .AddAttribute("MaxBytes",
+                          "The total number of bytes to send, 0 for no limit.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&CoalescingBulkSendApplication::m_maxBytes),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("WriteSize",
+                          "The largest socket write [bytes], also the payload buffer size.",
+                          UintegerValue(65536),
+                          MakeUintegerAccessor(&CoalescingBulkSendApplication::m_writeSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("MinWriteSize",
+                          "Wait until the socket takes this many bytes before writing "
+                          "[bytes], at most WriteSize; the last write of MaxBytes may be smaller.",
+                          UintegerValue(1448),
+                          MakeUintegerAccessor(&CoalescingBulkSendApplication::m_minWriteSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddTraceSource("Tx",
+                            "A write to the socket.",
+                            MakeTraceSourceAccessor(&CoalescingBulkSendApplication::m_txTrace),
+                            "ns3::Packet::TracedCallback");
+    return tid;
+}
+
+CoalescingBulkSendApplication::CoalescingBulkSendApplication()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+CoalescingBulkSendApplication::~CoalescingBulkSendApplication()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+Ptr<Socket>
+CoalescingBulkSendApplication::GetSocket() const
+{
+    return m_socket;
+}
+
+uint64_t
+CoalescingBulkSendApplication::GetTotalBytes() const
+{
+    return m_totBytes;
+}
+
+uint64_t
+CoalescingBulkSendApplication::GetWrites() const
+{
+    return m_writes;
+}
+
+void
+CoalescingBulkSendApplication::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_socket = nullptr;
+    m_payload = nullptr;
+    Application::DoDispose();
+}
+
+void
+CoalescingBulkSendApplication::StartApplication()
+{
+    NS_LOG_FUNCTION(this);
+    // Below MinWriteSize every write but the last would be held back forever
+    NS_ABORT_MSG_IF(m_minWriteSize > m_writeSize,
+                    "MinWriteSize (" << m_minWriteSize << ") exceeds WriteSize (" << m_writeSize
+                                     << ")");
+    if (!m_socket)
+    {
+        m_socket = Socket::CreateSocket(GetNode(), m_tid);
+        int ret;
+        if (!m_local.IsInvalid())
+        {
+            ret = m_socket->Bind(m_local);
+        }
+        else if (Inet6SocketAddress::IsMatchingType(m_peer))
+        {
+            ret = m_socket->Bind6();
+        }
+        else
+        {
+            ret = m_socket->Bind();
+        }
+        NS_ABORT_MSG_IF(ret == -1, "Failed to bind socket");
+
+        m_socket->Connect(m_peer);
+        m_socket->ShutdownRecv();
+        m_socket->SetConnectCallback(
+            MakeCallback(&CoalescingBulkSendApplication::ConnectionSucceeded, this),
+            MakeCallback(&CoalescingBulkSendApplication::ConnectionFailed, this));
+        m_socket->SetSendCallback(MakeCallback(&CoalescingBulkSendApplication::DataSend, this));
+        m_payload = Create<Packet>(m_writeSize);
+    }
+    if (m_connected)
+    {
+        SendData();
+    }
+}
+
+void
+CoalescingBulkSendApplication::StopApplication()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_socket)
+    {
+        m_socket->Close();
+        m_connected = false;
+    }
+}
+
+void
+CoalescingBulkSendApplication::SendData()
+{
+    NS_LOG_FUNCTION(this);
+    while (m_maxBytes == 0 || m_totBytes < m_maxBytes)
+    {
+        uint64_t size = std::min<uint64_t>(m_socket->GetTxAvailable(), m_writeSize);
+        const bool last = m_maxBytes > 0 && m_maxBytes - m_totBytes <= size;
+        if (m_maxBytes > 0)
+        {
+            size = std::min(size, m_maxBytes - m_totBytes);
+        }
+        if (size == 0 || (size < m_minWriteSize && !last))
+        {
+            // DataSend calls back once TCP has freed more of the buffer
+            break;
+        }
+
+        Ptr<Packet> packet = m_payload->CreateFragment(0, size);
+        int actual = m_socket->Send(packet);
+        if (actual <= 0)
+        {
+            NS_LOG_DEBUG("Send of " << size << " bytes refused, errno " << m_socket->GetErrno());
+            break;
+        }
+        m_txTrace(packet);
+        m_totBytes += actual;
+        ++m_writes;
+    }
+
+    if (m_maxBytes > 0 && m_totBytes >= m_maxBytes && m_connected)
+    {
+        m_socket->Close();
+        m_connected = false;
+    }
+}
+
+void
+CoalescingBulkSendApplication::ConnectionSucceeded(Ptr<Socket> socket)
+{
+    NS_LOG_FUNCTION(this << socket);
+    m_connected = true;
+    SendData();
+}
+
+void
+CoalescingBulkSendApplication::ConnectionFailed(Ptr<Socket> socket)
+{
+    NS_LOG_FUNCTION(this << socket);
+    NS_LOG_WARN("Connection of node " << GetNode()->GetId() << " failed");
+}
+
+void
+CoalescingBulkSendApplication::DataSend(Ptr<Socket> socket, uint32_t available)
+{
+    NS_LOG_FUNCTION(this << socket << available);
+    if (m_connected)
+    {
+        SendData();
+    }
+}
+
+CoalescingBulkSendHelper::CoalescingBulkSendHelper(const std::string& protocol,
+                                                   const Address& address)
+{
+    m_factory.SetTypeId(CoalescingBulkSendApplication::GetTypeId());
+    m_factory.Set("Protocol", TypeIdValue(TypeId::LookupByName(protocol)));
+    m_factory.Set("Remote", AddressValue(address));
+}
+
+void
+CoalescingBulkSendHelper::SetAttribute(const std::string& name, const AttributeValue& value)
+{
+    m_factory.Set(name, value);
+}
+
+ApplicationContainer
+CoalescingBulkSendHelper::Install(NodeContainer nodes) const
+{
+    ApplicationContainer apps;
+    for (auto it = nodes.Begin(); it != nodes.End(); ++it)
+    {
+        apps.Add(Install(*it));
+    }
+    return apps;
+}
+
+ApplicationContainer
+CoalescingBulkSendHelper::Install(Ptr<Node> node) const
+{
+    Ptr<Application> app = m_factory.Create<Application>();
+    node->AddApplication(app);
+    return ApplicationContainer(app);
+}
+
+} // namespace ns3
@@ -0,0 +1,135 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef COALESCING_BULK_SEND_H
+#define COALESCING_BULK_SEND_H
+
+#include "ns3/address.h"
+#include "ns3/application-container.h"
+#include "ns3/application.h"
+#include "ns3/node-container.h"
+#include "ns3/object-factory.h"
+#include "ns3/packet.h"
+#include "ns3/socket.h"
+#include "ns3/traced-callback.h"
+
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * Bulk transfer like BulkSendApplication, with fewer and larger socket
+ * writes.
+ *
+ * BulkSendApplication writes SendSize bytes at a time, each in a freshly
+ * allocated packet. This application waits until the socket can take at
+ * least MinWriteSize bytes, then writes as much as it takes, up to
+ * WriteSize. Every write is a fragment of one payload packet created at
+ * start, so the writes share its reference-counted zero-filled buffer
+ * instead of allocating their own. The segments on the wire are cut by
+ * TCP and do not depend on the write sizes.
+ */
+class CoalescingBulkSendApplication : public Application
+{
+  public:
+    CoalescingBulkSendApplication();
+    ~CoalescingBulkSendApplication() override;
+
+    /**
+     * Register this type.
+     * \return The TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /// \return The socket, null before the application starts.
+    Ptr<Socket> GetSocket() const;
+
+    /// \return The bytes written to the socket so far.
+    uint64_t GetTotalBytes() const;
+
+    /// \return The number of socket writes so far.
+    uint64_t GetWrites() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    void StartApplication() override;
+    void StopApplication() override;
+
+    /// Write to the socket until it is full or everything is sent.
+    void SendData();
+
+    /// Connection established.
+    void ConnectionSucceeded(Ptr<Socket> socket);
+    /// Connection failed.
+    void ConnectionFailed(Ptr<Socket> socket);
+    /// Send buffer space freed.
+    void DataSend(Ptr<Socket> socket, uint32_t available);
+
+    Address m_peer;          //!< Remote address.
+    Address m_local;         //!< Local address to bind to.
+    TypeId m_tid;            //!< Socket factory type.
+    uint64_t m_maxBytes;     //!< Bytes to send, 0 for unlimited.
+    uint32_t m_writeSize;    //!< Largest write.
+    uint32_t m_minWriteSize; //!< Smallest write, except the last.
+    Ptr<Socket> m_socket;    //!< The socket.
+    Ptr<Packet> m_payload;   //!< Shared payload of every write.
+    bool m_connected{false}; //!< True once connected.
+    uint64_t m_totBytes{0};  //!< Bytes written.
+    uint64_t m_writes{0};    //!< Socket writes.
+
+    TracedCallback<Ptr<const Packet>> m_txTrace; //!< Every write.
+};
+
+/**
+ * Installs CoalescingBulkSendApplication, like BulkSendHelper.
+ */
+class CoalescingBulkSendHelper
+{
+  public:
+    /**
+     * \param protocol The socket factory type, e.g. ns3::TcpSocketFactory.
+     * \param address The remote address.
+     */
+    CoalescingBulkSendHelper(const std::string& protocol, const Address& address);
+
+    /**
+     * Set an attribute of the applications to install.
+     * \param name The attribute name.
+     * \param value The attribute value.
+     */
+    void SetAttribute(const std::string& name, const AttributeValue& value);
+
+    /**
+     * \param nodes The nodes.
+     * \return One application per node.
+     */
+    ApplicationContainer Install(NodeContainer nodes) const;
+
+    /**
+     * \param node The node.
+     * \return The application.
+     */
+    ApplicationContainer Install(Ptr<Node> node) const;
+
+  private:
+    ObjectFactory m_factory; //!< Application factory.
+};
+
+} // namespace ns3
+
+#endif /* COALESCING_BULK_SEND_H */
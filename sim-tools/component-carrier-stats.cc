@@ -0,0 +1,119 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "component-carrier-stats.h"
+
+#include "ns3/config.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <limits>
+#include <numeric>
+#include <string>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ComponentCarrierStats");
+
+NS_OBJECT_ENSURE_REGISTERED(ComponentCarrierStats);
+
+TypeId
+ComponentCarrierStats::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::ComponentCarrierStats")
+                            .SetParent<Object>()
+                            .AddConstructor<ComponentCarrierStats>();
+    return tid;
+}
+
+ComponentCarrierStats::ComponentCarrierStats()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+ComponentCarrierStats::~ComponentCarrierStats()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+ComponentCarrierStats::Install()
+{
+    NS_LOG_FUNCTION(this);
+    m_start = Simulator::Now();
+    const std::string macs = "/NodeList/*/DeviceList/*/ComponentCarrierMap/*/LteEnbMac/";
+    Config::ConnectWithoutContext(macs + "DlScheduling",
+                                  MakeCallback(&ComponentCarrierStats::DlScheduling, this));
+    Config::ConnectWithoutContext(macs + "UlScheduling",
+                                  MakeCallback(&ComponentCarrierStats::UlScheduling, this));
+}
+
+void
+ComponentCarrierStats::Count(std::vector<uint64_t>& bytes,
+                             uint8_t componentCarrierId,
+                             uint32_t size)
+{
+    if (componentCarrierId >= bytes.size())
+    {
+        bytes.resize(componentCarrierId + 1, 0);
+    }
+    bytes[componentCarrierId] += size;
+}
+
+void
+ComponentCarrierStats::DlScheduling(DlSchedulingCallbackInfo info)
+{
+    Count(m_dlBytes, info.componentCarrierId, info.sizeTb1 + info.sizeTb2);
+}
+
+void
+ComponentCarrierStats::UlScheduling(uint32_t,
+                                    uint32_t,
+                                    uint16_t,
+                                    uint8_t,
+                                    uint16_t size,
+                                    uint8_t componentCarrierId)
+{
+    Count(m_ulBytes, componentCarrierId, size);
+}
+
+void
+ComponentCarrierStats::AddToSummary(RunSummary& summary, uint32_t cells) const
+{
+    const double seconds = (Simulator::Now() - m_start).GetSeconds();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    auto kbps = [seconds, nan](uint64_t bytes) {
+        return seconds > 0 ? bytes * 8.0 / seconds / 1024 : nan;
+    };
+
+    const std::pair<const char*, const std::vector<uint64_t>*> directions[] = {
+        {"Dl", &m_dlBytes},
+        {"Ul", &m_ulBytes},
+    };
+    for (const auto& [direction, bytes] : directions)
+    {
+        const std::string prefix = std::string("cc") + direction;
+        for (uint32_t cc = 0; cc < bytes->size(); ++cc)
+        {
+            summary.Set(prefix + "ThroughputKbps_" + std::to_string(cc), kbps((*bytes)[cc]));
+        }
+        const uint64_t total = std::accumulate(bytes->begin(), bytes->end(), uint64_t(0));
+        summary.Set(prefix + "ThroughputKbps_all", kbps(total));
+        summary.Set(prefix + "ThroughputKbps_perCell", cells > 0 ? kbps(total) / cells : nan);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,84 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef COMPONENT_CARRIER_STATS_H
+#define COMPONENT_CARRIER_STATS_H
+
+#include "run-summary.h"
+
+#include "ns3/lte-enb-mac.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Bytes scheduled by the eNB MACs on every component carrier, from the
+ * DlScheduling and UlScheduling traces, i.e. the cell throughput each carrier
+ * contributes.
+ */
+class ComponentCarrierStats : public Object
+{
+  public:
+    ComponentCarrierStats();
+    ~ComponentCarrierStats() override;
+
+    /**
+     * Register this type.
+     * \return The TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /// Connect to the MAC of every component carrier of every eNB.
+    void Install();
+
+    /**
+     * Add the downlink and uplink throughput of every carrier, their sum
+     * and the sum per cell to a run summary.
+     * \param summary The run summary.
+     * \param cells Number of eNBs.
+     */
+    void AddToSummary(RunSummary& summary, uint32_t cells) const;
+
+  private:
+    /// DlScheduling sink.
+    void DlScheduling(DlSchedulingCallbackInfo info);
+    /// UlScheduling sink.
+    void UlScheduling(uint32_t frameNo,
+                      uint32_t subframeNo,
+                      uint16_t rnti,
+                      uint8_t mcs,
+                      uint16_t size,
+                      uint8_t componentCarrierId);
+
+    /**
+     * Add bytes to a carrier.
+     * \param bytes The per-carrier counters.
+     * \param componentCarrierId The carrier.
+     * \param size The bytes.
+     */
+    static void Count(std::vector<uint64_t>& bytes, uint8_t componentCarrierId, uint32_t size);
+
+    Time m_start;                    //!< When the counting started.
+    std::vector<uint64_t> m_dlBytes; //!< Downlink bytes per carrier.
+    std::vector<uint64_t> m_ulBytes; //!< Uplink bytes per carrier.
+};
+
+} // namespace ns3
+
+#endif /* COMPONENT_CARRIER_STATS_H */
@@ -0,0 +1,99 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "fixed-bucket-histogram.h"
+
+#include "bucket-quantile.h"
+
+#include "ns3/abort.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+FixedBucketHistogram::FixedBucketHistogram(double bucketWidth, uint32_t buckets)
+    : m_bucketWidth(bucketWidth),
+      m_counts(buckets, 0)
+{
+    NS_ABORT_MSG_IF(bucketWidth <= 0 || buckets == 0, "Invalid histogram geometry");
+}
+
+void
+FixedBucketHistogram::Add(double value)
+{
+    const double position = std::max(0.0, value / m_bucketWidth);
+    const uint32_t last = m_counts.size() - 1;
+    const uint32_t index = position < last ? static_cast<uint32_t>(position) : last;
+    ++m_counts[index];
+    ++m_count;
+    m_sum += value;
+    m_max = m_count == 1 ? value : std::max(m_max, value);
+}
+
+uint64_t
+FixedBucketHistogram::GetCount() const
+{
+    return m_count;
+}
+
+double
+FixedBucketHistogram::GetMean() const
+{
+    return m_count > 0 ? m_sum / m_count : 0;
+}
+
+double
+FixedBucketHistogram::GetMax() const
+{
+    return m_max;
+}
+
+double
+FixedBucketHistogram::GetQuantile(double q) const
+{
+    return GetBucketQuantile(m_counts, m_count, m_max, q, [this](uint32_t i) {
+        return i * m_bucketWidth;
+    });
+}
+
+double
+FixedBucketHistogram::GetBucketWidth() const
+{
+    return m_bucketWidth;
+}
+
+uint32_t
+FixedBucketHistogram::GetNBuckets() const
+{
+    return m_counts.size();
+}
+
+uint64_t
+FixedBucketHistogram::GetBucketCount(uint32_t index) const
+{
+    return m_counts.at(index);
+}
+
+void
+FixedBucketHistogram::Reset()
+{
+    std::fill(m_counts.begin(), m_counts.end(), 0);
+    m_count = 0;
+    m_sum = 0;
+    m_max = 0;
+}
+
+} // namespace ns3
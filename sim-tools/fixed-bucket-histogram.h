@@ -0,0 +1,84 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FIXED_BUCKET_HISTOGRAM_H
+#define FIXED_BUCKET_HISTOGRAM_H
+
+#include <cstdint>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Histogram with a fixed number of equal-width buckets, allocated once.
+ *
+ * Unlike ns3::Histogram it never grows: values beyond the last bucket are
+ * counted in it, so Add() is an index computation and an increment. Quantiles
+ * are interpolated within a bucket and are exact to one bucket width.
+ */
+class FixedBucketHistogram
+{
+  public:
+    /**
+     * \param bucketWidth Width of a bucket.
+     * \param buckets Number of buckets; the last one also holds the overflow.
+     */
+    FixedBucketHistogram(double bucketWidth, uint32_t buckets);
+
+    /// \param value A sample; negative values go to the first bucket.
+    void Add(double value);
+
+    /// \return The number of samples.
+    uint64_t GetCount() const;
+
+    /// \return The mean of the samples, 0 without samples.
+    double GetMean() const;
+
+    /// \return The largest sample.
+    double GetMax() const;
+
+    /**
+     * \param q The quantile, in [0, 1].
+     * \return The estimated quantile, 0 without samples.
+     */
+    double GetQuantile(double q) const;
+
+    /// \return The width of a bucket.
+    double GetBucketWidth() const;
+
+    /// \return The number of buckets.
+    uint32_t GetNBuckets() const;
+
+    /**
+     * \param index The bucket.
+     * \return The number of samples in the bucket.
+     */
+    uint64_t GetBucketCount(uint32_t index) const;
+
+    /// Forget all samples.
+    void Reset();
+
+  private:
+    double m_bucketWidth;           //!< Width of a bucket.
+    std::vector<uint64_t> m_counts; //!< Samples per bucket.
+    uint64_t m_count{0};            //!< Number of samples.
+    double m_sum{0};                //!< Sum of the samples.
+    double m_max{0};                //!< Largest sample.
+};
+
+} // namespace ns3
+
+#endif /* FIXED_BUCKET_HISTOGRAM_H */
@@ -0,0 +1,401 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "flow-delay-quantiles.h"
+
+#include "ns3/abort.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/log.h"
+#include "ns3/lte-ue-rrc.h"
+#include "ns3/simulator.h"
+#include "ns3/tag.h"
+#include "ns3/tcp-header.h"
+#include "ns3/udp-header.h"
+#include "ns3/uinteger.h"
+
+#include <fstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("FlowDelayQuantiles");
+
+NS_OBJECT_ENSURE_REGISTERED(FlowDelayQuantiles);
+
+namespace
+{
+
+const uint8_t TCP_PROT_NUMBER = 6;  //!< TCP protocol number.
+const uint8_t UDP_PROT_NUMBER = 17; //!< UDP protocol number.
+
+} // namespace
+
+/**
+ * Send time of a packet, and the addresses of the header it was sent with so
+ * that the delivery of an outer tunnel header is not taken for its own.
+ */
+class FlowDelayTag : public Tag
+{
+  public:
+    /**
+     * Register this type.
+     * \return The TypeId.
+     */
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("ns3::FlowDelayTag")
+                                .SetParent<Tag>()
+                                .AddConstructor<FlowDelayTag>();
+        return tid;
+    }
+
+    TypeId GetInstanceTypeId() const override
+    {
+        return GetTypeId();
+    }
+
+    uint32_t GetSerializedSize() const override
+    {
+        return 8 + 4 + 4;
+    }
+
+    void Serialize(TagBuffer buffer) const override
+    {
+        buffer.WriteU64(sent);
+        buffer.WriteU32(source);
+        buffer.WriteU32(destination);
+    }
+
+    void Deserialize(TagBuffer buffer) override
+    {
+        sent = buffer.ReadU64();
+        source = buffer.ReadU32();
+        destination = buffer.ReadU32();
+    }
+
+    void Print(std::ostream& os) const override
+    {
+        os << "sent=" << sent << " src=" << Ipv4Address(source)
+           << " dst=" << Ipv4Address(destination);
+    }
+
+    uint64_t sent{0};        //!< Send time, in time steps.
+    uint32_t source{0};      //!< Source address of the IP header.
+    uint32_t destination{0}; //!< Destination address of the IP header.
+};
+
+NS_OBJECT_ENSURE_REGISTERED(FlowDelayTag);
+
+TypeId
+FlowDelayQuantiles::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::FlowDelayQuantiles")
+            .SetParent<Object>()
+            .AddConstructor<FlowDelayQuantiles>()
+            .AddAttribute("Resolution",
+                          "Smallest distinguishable delay.",
+                          TimeValue(MicroSeconds(10)),
+                          MakeTimeAccessor(&FlowDelayQuantiles::m_resolution),
+                          MakeTimeChecker(NanoSeconds(1)))
+            .AddAttribute("Highest",
+                          "Largest delay told apart; longer ones fall in the last bucket.",
+                          TimeValue(Seconds(10)),
+                          MakeTimeAccessor(&FlowDelayQuantiles::m_highest),
+                          MakeTimeChecker(MicroSeconds(1)))
+            .AddAttribute("SubBuckets",
+                          "Buckets per power of two, the inverse of the relative error.",
+                          UintegerValue(64),
+                          MakeUintegerAccessor(&FlowDelayQuantiles::m_subBuckets),
+                          MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+FlowDelayQuantiles::FlowDelayQuantiles()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+FlowDelayQuantiles::~FlowDelayQuantiles()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+FlowDelayQuantiles::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_ues.clear();
+    Object::DoDispose();
+}
+
+FlowDelayQuantiles::Distributions::Distributions(double resolution,
+                                                 double highest,
+                                                 uint32_t subBuckets)
+    : delay(resolution, highest, subBuckets),
+      jitter(resolution, highest, subBuckets)
+{
+}
+
+std::unique_ptr<FlowDelayQuantiles::Distributions>
+FlowDelayQuantiles::MakeDistributions() const
+{
+    return std::make_unique<Distributions>(m_resolution.GetSeconds() * 1000,
+                                           m_highest.GetSeconds() * 1000,
+                                           m_subBuckets);
+}
+
+void
+FlowDelayQuantiles::Install(NodeContainer nodes)
+{
+    NS_LOG_FUNCTION(this << nodes.GetN());
+    if (!m_all)
+    {
+        m_all = MakeDistributions();
+    }
+    for (auto it = nodes.Begin(); it != nodes.End(); ++it)
+    {
+        Ptr<Node> node = *it;
+        Ptr<Ipv4L3Protocol> ipv4 = node->GetObject<Ipv4L3Protocol>();
+        if (!ipv4)
+        {
+            continue;
+        }
+        ipv4->TraceConnectWithoutContext("SendOutgoing",
+                                         MakeCallback(&FlowDelayQuantiles::SendOutgoing, this));
+        ipv4->TraceConnectWithoutContext("LocalDeliver",
+                                         MakeCallback(&FlowDelayQuantiles::LocalDeliver, this));
+
+        Ptr<LteUeNetDevice> ueDevice;
+        for (uint32_t d = 0; d < node->GetNDevices() && !ueDevice; ++d)
+        {
+            ueDevice = DynamicCast<LteUeNetDevice>(node->GetDevice(d));
+        }
+        if (!ueDevice)
+        {
+            continue;
+        }
+        for (uint32_t i = 0; i < ipv4->GetNInterfaces(); ++i)
+        {
+            for (uint32_t a = 0; a < ipv4->GetNAddresses(i); ++a)
+            {
+                m_ues[ipv4->GetAddress(i, a).GetLocal().Get()] = ueDevice;
+            }
+        }
+    }
+}
+
+Ipv4FlowClassifier::FiveTuple
+FlowDelayQuantiles::GetFiveTuple(const Ipv4Header& header, Ptr<const Packet> packet)
+{
+    Ipv4FlowClassifier::FiveTuple tuple;
+    tuple.sourceAddress = header.GetSource();
+    tuple.destinationAddress = header.GetDestination();
+    tuple.protocol = header.GetProtocol();
+    tuple.sourcePort = 0;
+    tuple.destinationPort = 0;
+    // Only the first fragment holds the ports
+    if (header.GetFragmentOffset() != 0)
+    {
+        return tuple;
+    }
+    if (tuple.protocol == UDP_PROT_NUMBER)
+    {
+        UdpHeader udp;
+        if (packet->PeekHeader(udp))
+        {
+            tuple.sourcePort = udp.GetSourcePort();
+            tuple.destinationPort = udp.GetDestinationPort();
+        }
+    }
+    else if (tuple.protocol == TCP_PROT_NUMBER)
+    {
+        TcpHeader tcp;
+        if (packet->PeekHeader(tcp))
+        {
+            tuple.sourcePort = tcp.GetSourcePort();
+            tuple.destinationPort = tcp.GetDestinationPort();
+        }
+    }
+    return tuple;
+}
+
+uint16_t
+FlowDelayQuantiles::GetCellId(const Ipv4FlowClassifier::FiveTuple& flow) const
+{
+    for (Ipv4Address address : {flow.destinationAddress, flow.sourceAddress})
+    {
+        auto it = m_ues.find(address.Get());
+        if (it != m_ues.end())
+        {
+            return it->second->GetRrc()->GetCellId();
+        }
+    }
+    return 0;
+}
+
+void
+FlowDelayQuantiles::SendOutgoing(const Ipv4Header& header,
+                                 Ptr<const Packet> packet,
+                                 uint32_t /* interface */)
+{
+    FlowDelayTag tag;
+    if (packet->PeekPacketTag(tag))
+    {
+        // Tunnelled by a gateway: the inner header keeps its send time
+        return;
+    }
+    tag.sent = Simulator::Now().GetTimeStep();
+    tag.source = header.GetSource().Get();
+    tag.destination = header.GetDestination().Get();
+    packet->AddPacketTag(tag);
+}
+
+void
+FlowDelayQuantiles::LocalDeliver(const Ipv4Header& header,
+                                 Ptr<const Packet> packet,
+                                 uint32_t /* interface */)
+{
+    FlowDelayTag tag;
+    if (!packet->PeekPacketTag(tag) || tag.source != header.GetSource().Get() ||
+        tag.destination != header.GetDestination().Get())
+    {
+        return;
+    }
+    const Time delay = Simulator::Now() - TimeStep(tag.sent);
+    const Ipv4FlowClassifier::FiveTuple tuple = GetFiveTuple(header, packet);
+
+    FlowState& flow = m_flows[tuple];
+    const bool first = !flow.distributions;
+    if (first)
+    {
+        flow.distributions = MakeDistributions();
+    }
+    auto& cell = m_cells[GetCellId(tuple)];
+    if (!cell)
+    {
+        cell = MakeDistributions();
+    }
+
+    const double delayMs = delay.GetSeconds() * 1000;
+    const double jitterMs = Abs(delay - flow.lastDelay).GetSeconds() * 1000;
+    for (Distributions* d : {flow.distributions.get(), cell.get(), m_all.get()})
+    {
+        d->delay.Add(delayMs);
+        if (!first)
+        {
+            d->jitter.Add(jitterMs);
+        }
+    }
+    flow.lastDelay = delay;
+}
+
+const FlowDelayQuantiles::Distributions*
+FlowDelayQuantiles::GetFlow(const Ipv4FlowClassifier::FiveTuple& flow) const
+{
+    auto it = m_flows.find(flow);
+    return it != m_flows.end() ? it->second.distributions.get() : nullptr;
+}
+
+std::vector<uint16_t>
+FlowDelayQuantiles::GetCellIds() const
+{
+    std::vector<uint16_t> cells;
+    for (const auto& [cell, d] : m_cells)
+    {
+        cells.push_back(cell);
+    }
+    return cells;
+}
+
+const FlowDelayQuantiles::Distributions*
+FlowDelayQuantiles::GetCell(uint16_t cellId) const
+{
+    auto it = m_cells.find(cellId);
+    return it != m_cells.end() ? it->second.get() : nullptr;
+}
+
+namespace
+{
+
+/// Write the quantiles of a histogram as one CSV row.
+void
+WriteRow(std::ostream& os,
+         const std::string& scope,
+         uint32_t id,
+         const std::string& metric,
+         const LogBucketHistogram& h)
+{
+    os << scope << ',' << id << ',' << metric << ',' << h.GetCount() << ',' << h.GetMean()
+       << ',' << h.GetQuantile(0.5) << ',' << h.GetQuantile(0.95) << ',' << h.GetQuantile(0.99)
+       << ',' << h.GetQuantile(0.999) << ',' << h.GetMax() << '\n';
+}
+
+} // namespace
+
+void
+FlowDelayQuantiles::Write(const std::string& fileName,
+                          Ptr<FlowMonitor> monitor,
+                          Ptr<Ipv4FlowClassifier> classifier) const
+{
+    NS_LOG_FUNCTION(this << fileName);
+    std::ofstream os(fileName, std::ios::out | std::ios::trunc);
+    NS_ABORT_MSG_IF(!os.is_open(), "Unable to open " << fileName);
+    os << "scope,id,metric,count,mean_ms,p50_ms,p95_ms,p99_ms,p999_ms,max_ms\n";
+
+    auto writeScope = [&os](const std::string& scope, uint32_t id, const Distributions& d) {
+        WriteRow(os, scope, id, "delay", d.delay);
+        WriteRow(os, scope, id, "jitter", d.jitter);
+    };
+    for (const auto& [flowId, stats] : monitor->GetFlowStats())
+    {
+        if (const Distributions* d = GetFlow(classifier->FindFlow(flowId)))
+        {
+            writeScope("flow", flowId, *d);
+        }
+    }
+    for (const auto& [cell, d] : m_cells)
+    {
+        writeScope("cell", cell, *d);
+    }
+    if (m_all)
+    {
+        writeScope("all", 0, *m_all);
+    }
+}
+
+void
+FlowDelayQuantiles::AddToSummary(RunSummary& summary) const
+{
+    if (!m_all)
+    {
+        return;
+    }
+    const std::pair<const char*, const LogBucketHistogram*> metrics[] = {
+        {"delay", &m_all->delay},
+        {"jitter", &m_all->jitter},
+    };
+    for (const auto& [metric, h] : metrics)
+    {
+        const std::string prefix = metric;
+        summary.Set(prefix + "P50Ms", h->GetQuantile(0.5));
+        summary.Set(prefix + "P95Ms", h->GetQuantile(0.95));
+        summary.Set(prefix + "P99Ms", h->GetQuantile(0.99));
+        summary.Set(prefix + "P999Ms", h->GetQuantile(0.999));
+        summary.Set(prefix + "MaxMs", h->GetMax());
+    }
+}
+
+} // namespace ns3
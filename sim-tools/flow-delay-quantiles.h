@@ -0,0 +1,161 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLOW_DELAY_QUANTILES_H
+#define FLOW_DELAY_QUANTILES_H
+
+#include "log-bucket-histogram.h"
+#include "run-summary.h"
+
+#include "ns3/flow-monitor.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/lte-ue-net-device.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Delay and jitter quantiles per flow, per serving cell and overall.
+ *
+ * Probes on the Ipv4L3Protocol of the nodes, the SendOutgoing and
+ * LocalDeliver traces FlowMonitor listens to, tag every packet with its send
+ * time and record its one-way delay when it is delivered; deliveries of an
+ * outer tunnel header (GTP-U in the EPC) are recognised by their addresses
+ * and ignored. The jitter is the difference between the delays of two
+ * consecutive packets of a flow, as in FlowMonitor. Samples go into
+ * LogBucketHistograms, so the memory of a flow is constant and p99.9 is
+ * exact to 1 / SubBuckets of its value.
+ *
+ * The cell of a flow is the one serving its UE endpoint when the packet is
+ * delivered, or 0 when neither endpoint is an LTE UE.
+ */
+class FlowDelayQuantiles : public Object
+{
+  public:
+    /// Delay and jitter distributions [ms].
+    struct Distributions
+    {
+        /**
+         * \param resolution Smallest distinguishable value [ms].
+         * \param highest Largest value tracked without overflowing [ms].
+         * \param subBuckets Buckets per power of two.
+         */
+        Distributions(double resolution, double highest, uint32_t subBuckets);
+
+        LogBucketHistogram delay;  //!< One-way delays [ms].
+        LogBucketHistogram jitter; //!< Delay variations [ms].
+    };
+
+    FlowDelayQuantiles();
+    ~FlowDelayQuantiles() override;
+
+    /**
+     * Register this type.
+     * \return The TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * Probe the IPv4 stack of every node a flow starts or ends at; the UE
+     * addresses must already be assigned.
+     * \param nodes The nodes.
+     */
+    void Install(NodeContainer nodes);
+
+    /**
+     * \param flow The five-tuple of a flow.
+     * \return Its distributions, null if no packet of it was delivered.
+     */
+    const Distributions* GetFlow(const Ipv4FlowClassifier::FiveTuple& flow) const;
+
+    /// \return The cells with delivered packets, in increasing order; 0 for non-LTE flows.
+    std::vector<uint16_t> GetCellIds() const;
+
+    /**
+     * \param cellId A cell, 0 for the flows without an LTE UE endpoint.
+     * \return Its distributions, null if no packet of it was delivered.
+     */
+    const Distributions* GetCell(uint16_t cellId) const;
+
+    /**
+     * Write the quantiles of every flow of a monitor, by FlowId, of every
+     * cell and overall.
+     * \param fileName The CSV file.
+     * \param monitor The flow monitor whose flows to list.
+     * \param classifier Classifier of the monitor.
+     */
+    void Write(const std::string& fileName,
+               Ptr<FlowMonitor> monitor,
+               Ptr<Ipv4FlowClassifier> classifier) const;
+
+    /**
+     * Add the overall quantiles to a run summary.
+     * \param summary The run summary.
+     */
+    void AddToSummary(RunSummary& summary) const;
+
+  private:
+    void DoDispose() override;
+
+    /// Distributions of a flow and the delay of its last packet.
+    struct FlowState
+    {
+        std::unique_ptr<Distributions> distributions; //!< Delay and jitter.
+        Time lastDelay;                               //!< Delay of the last packet.
+    };
+
+    /// SendOutgoing sink: tag a packet leaving its source.
+    void SendOutgoing(const Ipv4Header& header, Ptr<const Packet> packet, uint32_t interface);
+    /// LocalDeliver sink: record the delay of a packet reaching its destination.
+    void LocalDeliver(const Ipv4Header& header, Ptr<const Packet> packet, uint32_t interface);
+
+    /**
+     * \param header The IP header.
+     * \param packet The IP payload.
+     * \return The five-tuple of the packet.
+     */
+    static Ipv4FlowClassifier::FiveTuple GetFiveTuple(const Ipv4Header& header,
+                                                      Ptr<const Packet> packet);
+
+    /**
+     * \param flow A five-tuple.
+     * \return The cell serving its UE endpoint, 0 if none.
+     */
+    uint16_t GetCellId(const Ipv4FlowClassifier::FiveTuple& flow) const;
+
+    /// \return New, empty distributions with the configured geometry.
+    std::unique_ptr<Distributions> MakeDistributions() const;
+
+    Time m_resolution;                                          //!< Smallest distinguishable value.
+    Time m_highest;                                             //!< Largest tracked value.
+    uint32_t m_subBuckets;                                      //!< Buckets per power of two.
+    std::map<Ipv4FlowClassifier::FiveTuple, FlowState> m_flows; //!< State per flow.
+    std::map<uint16_t, std::unique_ptr<Distributions>> m_cells; //!< Distributions per cell.
+    std::unique_ptr<Distributions> m_all;                       //!< Distributions of all flows.
+    std::map<uint32_t, Ptr<LteUeNetDevice>> m_ues;              //!< UE devices by address.
+};
+
+} // namespace ns3
+
+#endif /* FLOW_DELAY_QUANTILES_H */
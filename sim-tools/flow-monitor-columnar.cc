@@ -0,0 +1,388 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "flow-monitor-columnar.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <cstring>
+#include <numeric>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("FlowMonitorColumnar");
+
+namespace
+{
+
+const char COLUMNAR_MAGIC[8] = {'N', 'S', '3', 'F', 'M', 'C', 'O', 'L'};
+const uint32_t COLUMNAR_VERSION = 1;
+const uint64_t HEADER_SIZE = 64;
+const uint64_t DIRECTORY_ENTRY_SIZE = 40;
+const uint64_t NAME_SIZE = 24;
+const uint64_t TUPLE_SIZE = 16;
+
+/// File header, see the layout in the header file.
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t columnCount;
+    uint64_t flowCount;
+    uint64_t directoryOffset;
+    uint64_t tupleOffset;
+    uint64_t histogramOffset;
+    uint64_t histogramSize;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(FileHeader) == HEADER_SIZE, "Unexpected columnar header size");
+
+/// A column and how to extract it from FlowStats.
+struct ColumnSpec
+{
+    const char* name;
+    FlowColumnType type;
+    int64_t (*get)(const FlowMonitor::FlowStats&);
+};
+
+const ColumnSpec COLUMNS[] = {
+    {"timeFirstTxPacket",
+     FlowColumnType::NANOSECONDS,
+     [](const FlowMonitor::FlowStats& s) { return s.timeFirstTxPacket.GetNanoSeconds(); }},
+    {"timeFirstRxPacket",
+     FlowColumnType::NANOSECONDS,
+     [](const FlowMonitor::FlowStats& s) { return s.timeFirstRxPacket.GetNanoSeconds(); }},
+    {"timeLastTxPacket",
+     FlowColumnType::NANOSECONDS,
+     [](const FlowMonitor::FlowStats& s) { return s.timeLastTxPacket.GetNanoSeconds(); }},
+    {"timeLastRxPacket",
+     FlowColumnType::NANOSECONDS,
+     [](const FlowMonitor::FlowStats& s) { return s.timeLastRxPacket.GetNanoSeconds(); }},
+    {"delaySum",
+     FlowColumnType::NANOSECONDS,
+     [](const FlowMonitor::FlowStats& s) { return s.delaySum.GetNanoSeconds(); }},
+    {"jitterSum",
+     FlowColumnType::NANOSECONDS,
+     [](const FlowMonitor::FlowStats& s) { return s.jitterSum.GetNanoSeconds(); }},
+    {"lastDelay",
+     FlowColumnType::NANOSECONDS,
+     [](const FlowMonitor::FlowStats& s) { return s.lastDelay.GetNanoSeconds(); }},
+    {"txBytes",
+     FlowColumnType::COUNT,
+     [](const FlowMonitor::FlowStats& s) { return static_cast<int64_t>(s.txBytes); }},
+    {"rxBytes",
+     FlowColumnType::COUNT,
+     [](const FlowMonitor::FlowStats& s) { return static_cast<int64_t>(s.rxBytes); }},
+    {"txPackets",
+     FlowColumnType::COUNT,
+     [](const FlowMonitor::FlowStats& s) { return static_cast<int64_t>(s.txPackets); }},
+    {"rxPackets",
+     FlowColumnType::COUNT,
+     [](const FlowMonitor::FlowStats& s) { return static_cast<int64_t>(s.rxPackets); }},
+    {"lostPackets",
+     FlowColumnType::COUNT,
+     [](const FlowMonitor::FlowStats& s) { return static_cast<int64_t>(s.lostPackets); }},
+    {"timesForwarded",
+     FlowColumnType::COUNT,
+     [](const FlowMonitor::FlowStats& s) { return static_cast<int64_t>(s.timesForwarded); }},
+    {"packetsDropped",
+     FlowColumnType::COUNT,
+     [](const FlowMonitor::FlowStats& s) {
+         return static_cast<int64_t>(
+             std::accumulate(s.packetsDropped.begin(), s.packetsDropped.end(), uint64_t(0)));
+     }},
+    {"bytesDropped",
+     FlowColumnType::COUNT,
+     [](const FlowMonitor::FlowStats& s) {
+         return static_cast<int64_t>(
+             std::accumulate(s.bytesDropped.begin(), s.bytesDropped.end(), uint64_t(0)));
+     }},
+};
+
+const uint32_t COLUMN_COUNT = sizeof(COLUMNS) / sizeof(COLUMNS[0]);
+
+template <typename T>
+void
+WriteRaw(std::ofstream& os, const T& value)
+{
+    os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool
+ReadRaw(std::ifstream& is, T& value)
+{
+    return static_cast<bool>(is.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+/**
+ * Append one histogram to the histogram block, skipping empty bins.
+ * \return The number of bytes written.
+ */
+uint64_t
+WriteHistogram(std::ofstream& os, FlowId flowId, FlowHistogramKind kind, const Histogram& h)
+{
+    uint32_t nonEmpty = 0;
+    for (uint32_t i = 0; i < h.GetNBins(); ++i)
+    {
+        nonEmpty += h.GetBinCount(i) > 0 ? 1 : 0;
+    }
+    if (nonEmpty == 0)
+    {
+        return 0;
+    }
+
+    const uint8_t pad[3] = {0, 0, 0};
+    WriteRaw(os, static_cast<uint32_t>(flowId));
+    WriteRaw(os, static_cast<uint8_t>(kind));
+    os.write(reinterpret_cast<const char*>(pad), sizeof(pad));
+    WriteRaw(os, h.GetBinWidth(0));
+    WriteRaw(os, nonEmpty);
+    WriteRaw(os, uint32_t(0));
+    for (uint32_t i = 0; i < h.GetNBins(); ++i)
+    {
+        if (h.GetBinCount(i) > 0)
+        {
+            WriteRaw(os, i);
+            WriteRaw(os, h.GetBinCount(i));
+        }
+    }
+    return 24 + uint64_t(nonEmpty) * 8;
+}
+
+} // namespace
+
+void
+SerializeFlowMonitorToColumnarFile(Ptr<FlowMonitor> monitor,
+                                   Ptr<Ipv4FlowClassifier> classifier,
+                                   const std::string& fileName,
+                                   bool enableHistograms)
+{
+    NS_LOG_FUNCTION(monitor << classifier << fileName << enableHistograms);
+    const FlowMonitor::FlowStatsContainer& stats = monitor->GetFlowStats();
+    std::ofstream os(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    NS_ABORT_MSG_IF(!os.is_open(), "Unable to open " << fileName);
+
+    const uint64_t flowCount = stats.size();
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC));
+    header.version = COLUMNAR_VERSION;
+    header.columnCount = COLUMN_COUNT + 1; // plus the flowId column
+    header.flowCount = flowCount;
+    header.directoryOffset = HEADER_SIZE;
+    const uint64_t columnsOffset = HEADER_SIZE + header.columnCount * DIRECTORY_ENTRY_SIZE;
+    header.tupleOffset = columnsOffset + header.columnCount * flowCount * sizeof(int64_t);
+    header.histogramOffset = header.tupleOffset + flowCount * TUPLE_SIZE;
+    header.histogramSize = 0; // patched once the histograms are written
+    WriteRaw(os, header);
+
+    auto writeDirectoryEntry = [&os](const char* name, FlowColumnType type, uint64_t offset) {
+        char padded[NAME_SIZE];
+        std::memset(padded, 0, sizeof(padded));
+        std::strncpy(padded, name, NAME_SIZE - 1);
+        os.write(padded, sizeof(padded));
+        const uint8_t typeAndPad[8] = {static_cast<uint8_t>(type), 0, 0, 0, 0, 0, 0, 0};
+        os.write(reinterpret_cast<const char*>(typeAndPad), sizeof(typeAndPad));
+        WriteRaw(os, offset);
+    };
+    writeDirectoryEntry("flowId", FlowColumnType::COUNT, columnsOffset);
+    for (uint32_t c = 0; c < COLUMN_COUNT; ++c)
+    {
+        writeDirectoryEntry(COLUMNS[c].name,
+                            COLUMNS[c].type,
+                            columnsOffset + (c + 1) * flowCount * sizeof(int64_t));
+    }
+
+    for (const auto& entry : stats)
+    {
+        WriteRaw(os, static_cast<int64_t>(entry.first));
+    }
+    for (uint32_t c = 0; c < COLUMN_COUNT; ++c)
+    {
+        for (const auto& entry : stats)
+        {
+            WriteRaw(os, COLUMNS[c].get(entry.second));
+        }
+    }
+
+    const uint8_t pad[3] = {0, 0, 0};
+    for (const auto& entry : stats)
+    {
+        Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(entry.first);
+        WriteRaw(os, t.sourceAddress.Get());
+        WriteRaw(os, t.destinationAddress.Get());
+        WriteRaw(os, t.sourcePort);
+        WriteRaw(os, t.destinationPort);
+        WriteRaw(os, t.protocol);
+        os.write(reinterpret_cast<const char*>(pad), sizeof(pad));
+    }
+
+    if (enableHistograms)
+    {
+        uint64_t histogramSize = 0;
+        for (const auto& [flowId, flow] : stats)
+        {
+            histogramSize +=
+                WriteHistogram(os, flowId, FlowHistogramKind::DELAY, flow.delayHistogram);
+            histogramSize +=
+                WriteHistogram(os, flowId, FlowHistogramKind::JITTER, flow.jitterHistogram);
+            histogramSize += WriteHistogram(os,
+                                            flowId,
+                                            FlowHistogramKind::PACKET_SIZE,
+                                            flow.packetSizeHistogram);
+            histogramSize += WriteHistogram(os,
+                                            flowId,
+                                            FlowHistogramKind::FLOW_INTERRUPTIONS,
+                                            flow.flowInterruptionsHistogram);
+        }
+        header.histogramSize = histogramSize;
+        os.seekp(0);
+        WriteRaw(os, header);
+    }
+    os.close();
+}
+
+bool
+FlowMonitorColumnarReader::Open(const std::string& fileName)
+{
+    NS_LOG_FUNCTION(this << fileName);
+    m_file.open(fileName, std::ios::in | std::ios::binary);
+    FileHeader header;
+    if (!m_file.is_open() || !ReadRaw(m_file, header) ||
+        std::memcmp(header.magic, COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC)) != 0 ||
+        header.version != COLUMNAR_VERSION)
+    {
+        NS_LOG_WARN(fileName << " is not a columnar flow monitor file");
+        return false;
+    }
+    m_flowCount = header.flowCount;
+    m_tupleOffset = header.tupleOffset;
+    m_histogramOffset = header.histogramOffset;
+    m_histogramSize = header.histogramSize;
+
+    m_file.seekg(header.directoryOffset);
+    for (uint32_t c = 0; c < header.columnCount; ++c)
+    {
+        char name[NAME_SIZE];
+        uint8_t typeAndPad[8];
+        Column column;
+        if (!m_file.read(name, sizeof(name)) ||
+            !m_file.read(reinterpret_cast<char*>(typeAndPad), sizeof(typeAndPad)) ||
+            !ReadRaw(m_file, column.offset))
+        {
+            return false;
+        }
+        name[NAME_SIZE - 1] = '\0';
+        column.type = static_cast<FlowColumnType>(typeAndPad[0]);
+        m_columnNames.emplace_back(name);
+        m_columns[name] = column;
+    }
+    return true;
+}
+
+uint64_t
+FlowMonitorColumnarReader::GetFlowCount() const
+{
+    return m_flowCount;
+}
+
+std::vector<std::string>
+FlowMonitorColumnarReader::GetColumnNames() const
+{
+    return m_columnNames;
+}
+
+std::map<std::string, std::vector<int64_t>>
+FlowMonitorColumnarReader::ReadColumns(const std::vector<std::string>& names)
+{
+    NS_LOG_FUNCTION(this);
+    std::map<std::string, std::vector<int64_t>> values;
+    for (const auto& name : names)
+    {
+        auto it = m_columns.find(name);
+        if (it == m_columns.end())
+        {
+            NS_LOG_WARN("No column named " << name);
+            continue;
+        }
+        std::vector<int64_t>& column = values[name];
+        column.resize(m_flowCount);
+        m_file.clear();
+        m_file.seekg(it->second.offset);
+        m_file.read(reinterpret_cast<char*>(column.data()), m_flowCount * sizeof(int64_t));
+    }
+    return values;
+}
+
+std::vector<FlowMonitorColumnarReader::Tuple>
+FlowMonitorColumnarReader::ReadTuples()
+{
+    NS_LOG_FUNCTION(this);
+    std::vector<Tuple> tuples(m_flowCount);
+    m_file.clear();
+    m_file.seekg(m_tupleOffset);
+    for (auto& t : tuples)
+    {
+        uint8_t pad[3];
+        ReadRaw(m_file, t.sourceAddress);
+        ReadRaw(m_file, t.destinationAddress);
+        ReadRaw(m_file, t.sourcePort);
+        ReadRaw(m_file, t.destinationPort);
+        ReadRaw(m_file, t.protocol);
+        m_file.read(reinterpret_cast<char*>(pad), sizeof(pad));
+    }
+    return tuples;
+}
+
+std::vector<FlowMonitorColumnarReader::Histogram>
+FlowMonitorColumnarReader::ReadHistograms()
+{
+    NS_LOG_FUNCTION(this);
+    std::vector<Histogram> histograms;
+    m_file.clear();
+    m_file.seekg(m_histogramOffset);
+    uint64_t consumed = 0;
+    while (consumed < m_histogramSize)
+    {
+        Histogram h;
+        uint8_t kind;
+        uint8_t pad[3];
+        uint32_t nonEmpty;
+        uint32_t reserved;
+        if (!ReadRaw(m_file, h.flowId) || !ReadRaw(m_file, kind) ||
+            !m_file.read(reinterpret_cast<char*>(pad), sizeof(pad)) ||
+            !ReadRaw(m_file, h.binWidth) || !ReadRaw(m_file, nonEmpty) ||
+            !ReadRaw(m_file, reserved))
+        {
+            break;
+        }
+        h.kind = static_cast<FlowHistogramKind>(kind);
+        h.bins.resize(nonEmpty);
+        for (auto& bin : h.bins)
+        {
+            ReadRaw(m_file, bin.first);
+            ReadRaw(m_file, bin.second);
+        }
+        consumed += 24 + uint64_t(nonEmpty) * 8;
+        histograms.push_back(std::move(h));
+    }
+    return histograms;
+}
+
+} // namespace ns3
@@ -0,0 +1,150 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLOW_MONITOR_COLUMNAR_H
+#define FLOW_MONITOR_COLUMNAR_H
+
+#include "ns3/flow-monitor.h"
+#include "ns3/ipv4-flow-classifier.h"
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+// Layout of a columnar FlowMonitor file. All integers are little endian and
+// every block starts on an 8 byte boundary, so the file can be memory-mapped
+// and each column used in place as an array of int64_t.
+//
+//   header      magic "NS3FMCOL", version, column count, flow count and the
+//               offsets/sizes of the blocks below
+//   directory   one entry per column: 24 byte name, type, offset
+//   columns     flow count int64_t values per column, one row per flow
+//   tuples      FiveTuple dictionary, one 16 byte entry per row
+//   histograms  optional sparse histograms (delay, jitter, packet size,
+//               flow interruptions) of every flow
+
+namespace ns3
+{
+
+/// Values stored in a column.
+enum class FlowColumnType : uint8_t
+{
+    COUNT = 1,      //!< Packet/byte counter.
+    NANOSECONDS = 2 //!< Time in nanoseconds.
+};
+
+/// Histograms stored in the histogram block.
+enum class FlowHistogramKind : uint8_t
+{
+    DELAY = 0,             //!< Delay histogram (seconds).
+    JITTER = 1,            //!< Jitter histogram (seconds).
+    PACKET_SIZE = 2,       //!< Packet size histogram (bytes).
+    FLOW_INTERRUPTIONS = 3 //!< Flow interruption histogram (seconds).
+};
+
+/**
+ * Write the statistics of a flow monitor as a columnar binary file.
+ *
+ * This is a compact alternative to FlowMonitor::SerializeToXmlFile. Per-probe
+ * statistics are not exported; the per-reason drop vectors are folded into
+ * the packetsDropped/bytesDropped columns.
+ *
+ * \param monitor The flow monitor.
+ * \param classifier The classifier used to build the FiveTuple dictionary.
+ * \param fileName The output file.
+ * \param enableHistograms Whether to append the histogram block.
+ */
+void SerializeFlowMonitorToColumnarFile(Ptr<FlowMonitor> monitor,
+                                        Ptr<Ipv4FlowClassifier> classifier,
+                                        const std::string& fileName,
+                                        bool enableHistograms);
+
+/**
+ * Reader of the files written by SerializeFlowMonitorToColumnarFile.
+ *
+ * Only the header and the column directory are read on Open; columns, tuples
+ * and histograms are loaded on demand, so tools pay only for what they select.
+ */
+class FlowMonitorColumnarReader
+{
+  public:
+    /// FiveTuple dictionary entry, in row order.
+    struct Tuple
+    {
+        uint32_t sourceAddress;      //!< IPv4 source address (host order).
+        uint32_t destinationAddress; //!< IPv4 destination address (host order).
+        uint16_t sourcePort;         //!< Source port.
+        uint16_t destinationPort;    //!< Destination port.
+        uint8_t protocol;            //!< IP protocol number.
+    };
+
+    /// One sparse histogram.
+    struct Histogram
+    {
+        uint32_t flowId;                                  //!< Flow of the histogram.
+        FlowHistogramKind kind;                           //!< What is histogrammed.
+        double binWidth;                                  //!< Width of a bin.
+        std::vector<std::pair<uint32_t, uint32_t>> bins;  //!< Non-empty (bin, count) pairs.
+    };
+
+    /**
+     * Open a file and read its column directory.
+     * \param fileName The file.
+     * \return False if the file cannot be read or is not a columnar file.
+     */
+    bool Open(const std::string& fileName);
+
+    /// \return The number of flows (rows) in the file.
+    uint64_t GetFlowCount() const;
+
+    /// \return The names of the columns, in file order.
+    std::vector<std::string> GetColumnNames() const;
+
+    /**
+     * Load a set of columns.
+     * \param names The columns to load.
+     * \return The values of each requested column; unknown names are skipped.
+     */
+    std::map<std::string, std::vector<int64_t>> ReadColumns(
+        const std::vector<std::string>& names);
+
+    /// \return The FiveTuple dictionary, in row order.
+    std::vector<Tuple> ReadTuples();
+
+    /// \return All histograms, empty if the file was written without them.
+    std::vector<Histogram> ReadHistograms();
+
+  private:
+    /// Column directory entry.
+    struct Column
+    {
+        FlowColumnType type; //!< Value type.
+        uint64_t offset;     //!< Offset of the first value.
+    };
+
+    std::ifstream m_file;                      //!< The open file.
+    uint64_t m_flowCount{0};                   //!< Number of rows.
+    uint64_t m_tupleOffset{0};                 //!< Offset of the tuple block.
+    uint64_t m_histogramOffset{0};             //!< Offset of the histogram block.
+    uint64_t m_histogramSize{0};               //!< Size of the histogram block.
+    std::vector<std::string> m_columnNames;    //!< Column names, in file order.
+    std::map<std::string, Column> m_columns;   //!< Column directory.
+};
+
+} // namespace ns3
+
+#endif /* FLOW_MONITOR_COLUMNAR_H */
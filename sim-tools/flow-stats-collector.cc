@@ -0,0 +1,334 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "flow-stats-collector.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("FlowStatsCollector");
+
+NS_OBJECT_ENSURE_REGISTERED(FlowStatsCollector);
+
+TypeId
+FlowStatsCollector::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::FlowStatsCollector")
+            .SetParent<Object>()
+            .AddConstructor<FlowStatsCollector>()
+            .AddAttribute("Interval",
+                          "Length of a collection window.",
+                          TimeValue(Seconds(1)),
+                          MakeTimeAccessor(&FlowStatsCollector::m_interval),
+                          MakeTimeChecker(MilliSeconds(1)))
+            .AddAttribute("BinWidth",
+                          "Length of a bin of the in-memory series (0 disables them).",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&FlowStatsCollector::m_binWidth),
+                          MakeTimeChecker(Seconds(0)))
+            .AddAttribute("Bins",
+                          "Number of bins kept per flow; older bins are overwritten.",
+                          UintegerValue(600),
+                          MakeUintegerAccessor(&FlowStatsCollector::m_capacity),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("MaxDelay",
+                          "Packets in flight for longer than this are counted as lost "
+                          "and released from the monitor at every sample.",
+                          TimeValue(Seconds(10)),
+                          MakeTimeAccessor(&FlowStatsCollector::m_maxDelay),
+                          MakeTimeChecker());
+    return tid;
+}
+
+FlowStatsCollector::FlowStatsCollector()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+FlowStatsCollector::~FlowStatsCollector()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+FlowStatsCollector::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_collectEvent.Cancel();
+    if (m_file.is_open())
+    {
+        m_file.close();
+    }
+    m_monitor = nullptr;
+    m_classifier = nullptr;
+    Object::DoDispose();
+}
+
+void
+FlowStatsCollector::Install(Ptr<FlowMonitor> monitor,
+                            Ptr<Ipv4FlowClassifier> classifier,
+                            const std::string& fileName)
+{
+    NS_LOG_FUNCTION(this << monitor << classifier << fileName);
+    NS_ABORT_MSG_IF(fileName.empty() && m_binWidth.IsZero(),
+                    "Neither a file nor a BinWidth: nothing to collect");
+    m_monitor = monitor;
+    m_classifier = classifier;
+    if (!fileName.empty())
+    {
+        m_file.open(fileName, std::ios::out | std::ios::trunc);
+        NS_ABORT_MSG_IF(!m_file.is_open(), "Unable to open " << fileName);
+
+        m_file << "time_s,flow,src,sport,dst,dport,proto,txPackets,txBytes,rxPackets,rxBytes,"
+                  "delaySum_ms,jitterSum_ms,lostPackets\n";
+        m_file.flush();
+    }
+
+    m_windowStart = Simulator::Now();
+    m_binStart = Simulator::Now();
+    const Time period = m_binWidth.IsStrictlyPositive() ? m_binWidth : m_interval;
+    m_collectEvent = Simulator::Schedule(period, &FlowStatsCollector::Collect, this);
+}
+
+void
+FlowStatsCollector::Flush()
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_monitor)
+    {
+        return;
+    }
+    m_collectEvent.Cancel();
+    Sample(true);
+    if (m_file.is_open())
+    {
+        m_file.close();
+    }
+}
+
+void
+FlowStatsCollector::Collect()
+{
+    NS_LOG_FUNCTION(this);
+    Sample(false);
+    const Time period = m_binWidth.IsStrictlyPositive() ? m_binWidth : m_interval;
+    m_collectEvent = Simulator::Schedule(period, &FlowStatsCollector::Collect, this);
+}
+
+void
+FlowStatsCollector::Sample(bool flush)
+{
+    const Time now = Simulator::Now();
+    if (now == m_binStart && now == m_windowStart)
+    {
+        return;
+    }
+    // Also purges the packets the monitor still tracks in flight, which keeps
+    // its own memory bounded on long runs
+    m_monitor->CheckForLostPackets(m_maxDelay);
+
+    if (m_binWidth.IsStrictlyPositive() && now > m_binStart)
+    {
+        CloseBin();
+    }
+    if (m_file.is_open() && now > m_windowStart &&
+        (flush || now - m_windowStart >= m_interval))
+    {
+        WriteWindow();
+    }
+}
+
+void
+FlowStatsCollector::WriteWindow()
+{
+    NS_LOG_FUNCTION(this);
+    const double now = Simulator::Now().GetSeconds();
+    const FlowMonitor::FlowStatsContainer& stats = m_monitor->GetFlowStats();
+    for (const auto& [flowId, flow] : stats)
+    {
+        if (flowId >= m_snapshots.size())
+        {
+            m_snapshots.resize(flowId + 1);
+        }
+        FlowSnapshot& last = m_snapshots[flowId];
+        if (flow.txPackets == last.txPackets && flow.rxPackets == last.rxPackets &&
+            flow.lostPackets == last.lostPackets)
+        {
+            continue;
+        }
+
+        Ipv4FlowClassifier::FiveTuple t = m_classifier->FindFlow(flowId);
+        m_file << now << ',' << flowId << ',' << t.sourceAddress << ',' << t.sourcePort << ','
+               << t.destinationAddress << ',' << t.destinationPort << ','
+               << static_cast<uint32_t>(t.protocol) << ',' << flow.txPackets - last.txPackets
+               << ',' << flow.txBytes - last.txBytes << ',' << flow.rxPackets - last.rxPackets
+               << ',' << flow.rxBytes - last.rxBytes << ','
+               << (flow.delaySum - last.delaySum).GetSeconds() * 1000 << ','
+               << (flow.jitterSum - last.jitterSum).GetSeconds() * 1000 << ','
+               << flow.lostPackets - last.lostPackets << '\n';
+
+        last.txBytes = flow.txBytes;
+        last.rxBytes = flow.rxBytes;
+        last.txPackets = flow.txPackets;
+        last.rxPackets = flow.rxPackets;
+        last.lostPackets = flow.lostPackets;
+        last.delaySum = flow.delaySum;
+        last.jitterSum = flow.jitterSum;
+    }
+    m_file.flush();
+    m_windowStart = Simulator::Now();
+}
+
+void
+FlowStatsCollector::CloseBin()
+{
+    NS_LOG_FUNCTION(this);
+    const FlowMonitor::FlowStatsContainer& stats = m_monitor->GetFlowStats();
+    for (const auto& [flowId, flow] : stats)
+    {
+        if (flowId >= m_rings.size())
+        {
+            m_rings.resize(flowId + 1);
+        }
+        Ring& ring = m_rings[flowId];
+        Bin bin;
+        bin.start = m_binStart;
+        bin.txBytes = flow.txBytes - ring.total.txBytes;
+        bin.rxBytes = flow.rxBytes - ring.total.rxBytes;
+        bin.rxPackets = flow.rxPackets - ring.total.rxPackets;
+        bin.lostPackets = flow.lostPackets - ring.total.lostPackets;
+        bin.delaySum = flow.delaySum - ring.total.delaySum;
+
+        if (ring.bins.size() < m_capacity)
+        {
+            ring.bins.reserve(m_capacity);
+            ring.bins.push_back(bin);
+        }
+        else
+        {
+            ring.bins[ring.next] = bin;
+            ring.next = (ring.next + 1) % m_capacity;
+        }
+
+        ring.total.txBytes = flow.txBytes;
+        ring.total.rxBytes = flow.rxBytes;
+        ring.total.rxPackets = flow.rxPackets;
+        ring.total.lostPackets = flow.lostPackets;
+        ring.total.delaySum = flow.delaySum;
+    }
+    m_binStart = Simulator::Now();
+}
+
+std::vector<FlowStatsCollector::Bin>
+FlowStatsCollector::GetSeries(FlowId flowId) const
+{
+    if (flowId >= m_rings.size())
+    {
+        return {};
+    }
+    const Ring& ring = m_rings[flowId];
+    std::vector<Bin> series;
+    series.reserve(ring.bins.size());
+    series.insert(series.end(), ring.bins.begin() + ring.next, ring.bins.end());
+    series.insert(series.end(), ring.bins.begin(), ring.bins.begin() + ring.next);
+    return series;
+}
+
+FlowStatsCollector::Bin
+FlowStatsCollector::Sum(FlowId flowId, Time window, Time& duration) const
+{
+    Bin sum;
+    duration = Time();
+    if (flowId >= m_rings.size() || m_rings[flowId].bins.empty())
+    {
+        return sum;
+    }
+    const Ring& ring = m_rings[flowId];
+    const std::size_t size = ring.bins.size();
+    // Walk back from the newest bin until the window is covered
+    for (std::size_t i = 0; i < size && duration < window; ++i)
+    {
+        const Bin& bin = ring.bins[(ring.next + size - 1 - i) % size];
+        sum.txBytes += bin.txBytes;
+        sum.rxBytes += bin.rxBytes;
+        sum.rxPackets += bin.rxPackets;
+        sum.lostPackets += bin.lostPackets;
+        sum.delaySum += bin.delaySum;
+        sum.start = bin.start;
+        duration = m_binStart - bin.start;
+    }
+    return sum;
+}
+
+double
+FlowStatsCollector::GetThroughputKbps(FlowId flowId, Time window) const
+{
+    Time duration;
+    const Bin sum = Sum(flowId, window, duration);
+    return duration.IsStrictlyPositive() ? sum.rxBytes * 8.0 / duration.GetSeconds() / 1024
+                                         : 0;
+}
+
+Time
+FlowStatsCollector::GetMeanDelay(FlowId flowId, Time window) const
+{
+    Time duration;
+    const Bin sum = Sum(flowId, window, duration);
+    return sum.rxPackets > 0 ? sum.delaySum / static_cast<int64_t>(sum.rxPackets) : Time();
+}
+
+bool
+FlowStatsCollector::WriteSeries(const std::string& fileName) const
+{
+    NS_LOG_FUNCTION(this << fileName);
+    std::ofstream os(fileName, std::ios::out | std::ios::trunc);
+    if (!os)
+    {
+        NS_LOG_ERROR("Unable to open " << fileName);
+        return false;
+    }
+    os << "time_s,flow,src,dst,txBytes,rxBytes,throughput_kbps,rxPackets,meanDelay_ms,"
+          "lostPackets\n";
+    for (FlowId flowId = 0; flowId < m_rings.size(); ++flowId)
+    {
+        const std::vector<Bin> series = GetSeries(flowId);
+        if (series.empty())
+        {
+            continue;
+        }
+        const Ipv4FlowClassifier::FiveTuple t = m_classifier->FindFlow(flowId);
+        for (std::size_t i = 0; i < series.size(); ++i)
+        {
+            const Bin& bin = series[i];
+            const Time end = i + 1 < series.size() ? series[i + 1].start : m_binStart;
+            const double seconds = (end - bin.start).GetSeconds();
+            os << bin.start.GetSeconds() << ',' << flowId << ',' << t.sourceAddress << ','
+               << t.destinationAddress << ',' << bin.txBytes << ',' << bin.rxBytes << ','
+               << (seconds > 0 ? bin.rxBytes * 8.0 / seconds / 1024 : 0) << ','
+               << bin.rxPackets << ','
+               << (bin.rxPackets > 0 ? bin.delaySum.GetSeconds() * 1000 / bin.rxPackets : 0)
+               << ',' << bin.lostPackets << '\n';
+        }
+    }
+    return static_cast<bool>(os);
+}
+
+} // namespace ns3
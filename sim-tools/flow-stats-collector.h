@@ -0,0 +1,175 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FLOW_STATS_COLLECTOR_H
+#define FLOW_STATS_COLLECTOR_H
+
+#include "ns3/event-id.h"
+#include "ns3/flow-monitor.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Streams per-flow FlowMonitor deltas to a CSV file while the simulation runs,
+ * and keeps per-flow throughput and delay series in memory.
+ *
+ * Every Interval the collector walks the monitor's FlowStatsContainer in place
+ * (no copy), subtracts the counters it saw in the previous window and writes one
+ * line per flow that changed. Only the last cumulative counters of each flow are
+ * kept, so memory does not grow with the simulated time. The file is flushed at
+ * the end of every window, so a run that gets killed still leaves all completed
+ * windows on disk.
+ *
+ * With a BinWidth, the monitor is sampled every bin instead and the deltas of
+ * every flow are also appended to a ring of Bins entries, which can be queried
+ * while the simulation runs and exported at the end. Once a ring is full the
+ * oldest bin is overwritten, so the memory of a flow is fixed whatever the
+ * simulated time. The CSV windows then end on the first bin boundary at or
+ * after each Interval. Either output can be used alone: without a file name
+ * only the series are kept.
+ */
+class FlowStatsCollector : public Object
+{
+  public:
+    /// Counters of a flow over one bin.
+    struct Bin
+    {
+        Time start;              //!< Start of the bin.
+        uint64_t txBytes{0};     //!< Transmitted bytes.
+        uint64_t rxBytes{0};     //!< Received bytes.
+        uint32_t rxPackets{0};   //!< Received packets.
+        uint32_t lostPackets{0}; //!< Packets declared lost.
+        Time delaySum;           //!< Sum of the delays of the received packets.
+    };
+
+    FlowStatsCollector();
+    ~FlowStatsCollector() override;
+
+    /**
+     * Register this type.
+     * \return The TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * Start collecting from the given monitor.
+     * \param monitor The flow monitor to sample.
+     * \param classifier The classifier used to resolve the five-tuple of each flow.
+     * \param fileName The CSV file the windows are written to, empty to only
+     *        keep the series.
+     */
+    void Install(Ptr<FlowMonitor> monitor,
+                 Ptr<Ipv4FlowClassifier> classifier,
+                 const std::string& fileName);
+
+    /// Write the last, possibly partial, window and bin and close the file.
+    void Flush();
+
+    /**
+     * \param flowId The flow.
+     * \return The bins still held for the flow, oldest first.
+     */
+    std::vector<Bin> GetSeries(FlowId flowId) const;
+
+    /**
+     * \param flowId The flow.
+     * \param window How far back to look; it is rounded up to whole bins.
+     * \return The received throughput [kbit/s] over the window, 0 for an
+     *         unknown flow.
+     */
+    double GetThroughputKbps(FlowId flowId, Time window) const;
+
+    /**
+     * \param flowId The flow.
+     * \param window How far back to look; it is rounded up to whole bins.
+     * \return The mean delay of the packets received in the window, zero if
+     *         there is none.
+     */
+    Time GetMeanDelay(FlowId flowId, Time window) const;
+
+    /**
+     * Write every bin still held, one "time_s,flow,src,dst,..." line per flow
+     * and bin.
+     * \param fileName The CSV file.
+     * \return False if the file cannot be written.
+     */
+    bool WriteSeries(const std::string& fileName) const;
+
+  private:
+    void DoDispose() override;
+
+    /// Last cumulative counters seen for a flow.
+    struct FlowSnapshot
+    {
+        uint64_t txBytes{0};     //!< Transmitted bytes.
+        uint64_t rxBytes{0};     //!< Received bytes.
+        uint32_t txPackets{0};   //!< Transmitted packets.
+        uint32_t rxPackets{0};   //!< Received packets.
+        uint32_t lostPackets{0}; //!< Lost packets.
+        Time delaySum;           //!< Sum of the end-to-end delays.
+        Time jitterSum;          //!< Sum of the delay variations.
+    };
+
+    /// Bins of one flow and its counters at the last sample.
+    struct Ring
+    {
+        std::vector<Bin> bins; //!< At most m_capacity bins.
+        std::size_t next{0};   //!< Slot of the next bin once full.
+        Bin total;             //!< Cumulative counters at the last sample.
+    };
+
+    /// Sample the monitor and schedule the next sample.
+    void Collect();
+    /// Release the packets lost in flight, then close the bin and, when due, the window.
+    void Sample(bool flush);
+    /// Write the deltas accumulated since the previous window.
+    void WriteWindow();
+    /// Append the deltas since the previous sample to the series.
+    void CloseBin();
+
+    /**
+     * Sum the last bins of a flow.
+     * \param flowId The flow.
+     * \param window How far back to look.
+     * \param[out] duration Time covered by the summed bins.
+     * \return The sum.
+     */
+    Bin Sum(FlowId flowId, Time window, Time& duration) const;
+
+    Ptr<FlowMonitor> m_monitor;            //!< The sampled flow monitor.
+    Ptr<Ipv4FlowClassifier> m_classifier;  //!< Classifier of the monitor.
+    std::ofstream m_file;                  //!< The output file.
+    std::vector<FlowSnapshot> m_snapshots; //!< Previous counters, indexed by FlowId.
+    std::vector<Ring> m_rings;             //!< Bins, indexed by FlowId.
+    Time m_interval;                       //!< Length of a window.
+    Time m_binWidth;                       //!< Length of a bin, 0 without series.
+    uint32_t m_capacity;                   //!< Bins kept per flow.
+    Time m_maxDelay;                       //!< Age after which a packet is counted as lost.
+    Time m_windowStart;                    //!< Start of the current window.
+    Time m_binStart;                       //!< Start of the current bin.
+    EventId m_collectEvent;                //!< Next collection.
+};
+
+} // namespace ns3
+
+#endif /* FLOW_STATS_COLLECTOR_H */
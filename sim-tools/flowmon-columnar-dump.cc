@@ -0,0 +1,109 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Prints selected columns of a columnar flow monitor file as CSV, e.g.
+//
+//   ./ns3 run "flowmon-columnar-dump --file=project.flowcol --columns=rxBytes,delaySum"
+//
+// Only the requested columns are read from the file.
+
+#include "flow-monitor-columnar.h"
+
+#include "ns3/core-module.h"
+#include "ns3/ipv4-address.h"
+
+#include <iostream>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("FlowmonColumnarDump");
+
+int
+main(int argc, char* argv[])
+{
+    std::string fileName;
+    std::string columns;
+    bool tuples = true;
+
+    CommandLine cmd;
+    cmd.AddValue("file", "Columnar flow monitor file", fileName);
+    cmd.AddValue("columns", "Comma separated list of columns (empty lists them)", columns);
+    cmd.AddValue("tuples", "Print the five-tuple of every flow", tuples);
+    cmd.Parse(argc, argv);
+
+    FlowMonitorColumnarReader reader;
+    if (!reader.Open(fileName))
+    {
+        std::cerr << "Cannot read " << fileName << "\n";
+        return 1;
+    }
+
+    if (columns.empty())
+    {
+        for (const auto& name : reader.GetColumnNames())
+        {
+            std::cout << name << "\n";
+        }
+        return 0;
+    }
+
+    std::vector<std::string> names{"flowId"};
+    std::istringstream list(columns);
+    for (std::string name; std::getline(list, name, ',');)
+    {
+        names.push_back(name);
+    }
+    auto values = reader.ReadColumns(names);
+    std::vector<FlowMonitorColumnarReader::Tuple> tupleList;
+    if (tuples)
+    {
+        tupleList = reader.ReadTuples();
+    }
+
+    std::cout << "flowId";
+    if (tuples)
+    {
+        std::cout << ",src,sport,dst,dport,proto";
+    }
+    for (std::size_t c = 1; c < names.size(); ++c)
+    {
+        std::cout << "," << names[c];
+    }
+    std::cout << "\n";
+
+    for (uint64_t row = 0; row < reader.GetFlowCount(); ++row)
+    {
+        std::cout << values["flowId"][row];
+        if (tuples)
+        {
+            const auto& t = tupleList[row];
+            std::cout << "," << Ipv4Address(t.sourceAddress) << "," << t.sourcePort << ","
+                      << Ipv4Address(t.destinationAddress) << "," << t.destinationPort << ","
+                      << static_cast<uint32_t>(t.protocol);
+        }
+        for (std::size_t c = 1; c < names.size(); ++c)
+        {
+            auto it = values.find(names[c]);
+            std::cout << ",";
+            if (it != values.end())
+            {
+                std::cout << it->second[row];
+            }
+        }
+        std::cout << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,295 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "http-metrics-collector.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("HttpMetricsCollector");
+
+NS_OBJECT_ENSURE_REGISTERED(HttpMetricsCollector);
+
+TypeId
+HttpMetricsCollector::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::HttpMetricsCollector")
+            .SetParent<Object>()
+            .AddConstructor<HttpMetricsCollector>()
+            .AddAttribute("Interval",
+                          "Period of the summaries (0 only writes the final one).",
+                          TimeValue(Seconds(1)),
+                          MakeTimeAccessor(&HttpMetricsCollector::m_interval),
+                          MakeTimeChecker(Seconds(0)));
+    return tid;
+}
+
+HttpMetricsCollector::HttpMetricsCollector()
+    : m_objectSize(4096, 256),
+      m_packetDelay(1, 1000),
+      m_pageLoad(10, 1000)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+HttpMetricsCollector::~HttpMetricsCollector()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+HttpMetricsCollector::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_summaryEvent.Cancel();
+    if (m_file.is_open())
+    {
+        m_file.close();
+    }
+    Object::DoDispose();
+}
+
+void
+HttpMetricsCollector::Install(const ApplicationContainer& apps)
+{
+    NS_LOG_FUNCTION(this << apps.GetN());
+    for (uint32_t i = 0; i < apps.GetN(); ++i)
+    {
+        Ptr<Application> app = apps.Get(i);
+        const uint32_t nodeId = app->GetNode()->GetId();
+        Ptr<ThreeGppHttpServer> server = DynamicCast<ThreeGppHttpServer>(app);
+        Ptr<ThreeGppHttpClient> client = DynamicCast<ThreeGppHttpClient>(app);
+        if (!server && !client)
+        {
+            continue;
+        }
+
+        if (nodeId >= m_nodes.size())
+        {
+            m_nodes.resize(nodeId + 1);
+        }
+        m_nodes[nodeId].installed = true;
+        m_sinks.push_back(std::make_unique<AppSink>(this, nodeId));
+        AppSink* sink = m_sinks.back().get();
+
+        if (server)
+        {
+            server->TraceConnectWithoutContext("ConnectionEstablished",
+                                               MakeCallback(&AppSink::ServerConnection, sink));
+            server->TraceConnectWithoutContext("MainObject",
+                                               MakeCallback(&AppSink::ServerMainObject, sink));
+            server->TraceConnectWithoutContext("EmbeddedObject",
+                                               MakeCallback(&AppSink::ServerEmbeddedObject, sink));
+            server->TraceConnectWithoutContext("Tx", MakeCallback(&AppSink::ServerTx, sink));
+        }
+        else
+        {
+            client->TraceConnectWithoutContext("RxMainObject",
+                                               MakeCallback(&AppSink::ClientMainObject, sink));
+            client->TraceConnectWithoutContext("RxEmbeddedObject",
+                                               MakeCallback(&AppSink::ClientEmbeddedObject, sink));
+            client->TraceConnectWithoutContext("Rx", MakeCallback(&AppSink::ClientRx, sink));
+            client->TraceConnectWithoutContext("RxDelay",
+                                               MakeCallback(&AppSink::ClientDelay, sink));
+            client->TraceConnectWithoutContext("RxPage", MakeCallback(&AppSink::ClientPage, sink));
+        }
+    }
+}
+
+void
+HttpMetricsCollector::Start(const std::string& fileName)
+{
+    NS_LOG_FUNCTION(this << fileName);
+    m_file.open(fileName, std::ios::out | std::ios::trunc);
+    NS_ABORT_MSG_IF(!m_file.is_open(), "Unable to open " << fileName);
+    m_file << "time_s,node,metric,value\n";
+    if (m_interval.IsStrictlyPositive())
+    {
+        m_summaryEvent =
+            Simulator::Schedule(m_interval, &HttpMetricsCollector::PeriodicSummary, this);
+    }
+}
+
+void
+HttpMetricsCollector::Flush()
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_file.is_open())
+    {
+        return;
+    }
+    m_summaryEvent.Cancel();
+    WriteSummary();
+    m_file.close();
+}
+
+void
+HttpMetricsCollector::AddToSummary(RunSummary& summary) const
+{
+    NodeCounters total;
+    for (const auto& node : m_nodes)
+    {
+        total.connections += node.connections;
+        total.txBytes += node.txBytes;
+        total.rxBytes += node.rxBytes;
+        total.pages += node.pages;
+    }
+    summary.Set("httpConnections", total.connections);
+    summary.Set("httpServerTxBytes", total.txBytes);
+    summary.Set("httpClientRxBytes", total.rxBytes);
+    summary.Set("httpPages", total.pages);
+    summary.Set("httpObjectSizeMeanBytes", m_objectSize.GetMean());
+    summary.Set("httpPacketDelayMeanMs", m_packetDelay.GetMean());
+    summary.Set("httpPacketDelayP95Ms", m_packetDelay.GetQuantile(0.95));
+    summary.Set("httpPageLoadMeanMs", m_pageLoad.GetMean());
+    summary.Set("httpPageLoadP95Ms", m_pageLoad.GetQuantile(0.95));
+}
+
+void
+HttpMetricsCollector::PeriodicSummary()
+{
+    WriteSummary();
+    m_summaryEvent = Simulator::Schedule(m_interval, &HttpMetricsCollector::PeriodicSummary, this);
+}
+
+void
+HttpMetricsCollector::WriteSummary()
+{
+    NS_LOG_FUNCTION(this);
+    const double now = Simulator::Now().GetSeconds();
+    for (uint32_t id = 0; id < m_nodes.size(); ++id)
+    {
+        const NodeCounters& c = m_nodes[id];
+        if (!c.installed)
+        {
+            continue;
+        }
+        const std::pair<const char*, uint64_t> counters[] = {
+            {"connections", c.connections},
+            {"txPackets", c.txPackets},
+            {"txBytes", c.txBytes},
+            {"rxPackets", c.rxPackets},
+            {"rxBytes", c.rxBytes},
+            {"mainObjects", c.mainObjects},
+            {"embeddedObjects", c.embeddedObjects},
+            {"pages", c.pages},
+        };
+        for (const auto& [metric, value] : counters)
+        {
+            m_file << now << ',' << id << ',' << metric << ',' << value << '\n';
+        }
+    }
+
+    const std::pair<const char*, const FixedBucketHistogram*> histograms[] = {
+        {"objectSize_bytes", &m_objectSize},
+        {"packetDelay_ms", &m_packetDelay},
+        {"pageLoad_ms", &m_pageLoad},
+    };
+    for (const auto& [name, histogram] : histograms)
+    {
+        m_file << now << ",all," << name << "_count," << histogram->GetCount() << '\n';
+        m_file << now << ",all," << name << "_mean," << histogram->GetMean() << '\n';
+        m_file << now << ",all," << name << "_p50," << histogram->GetQuantile(0.5) << '\n';
+        m_file << now << ",all," << name << "_p95," << histogram->GetQuantile(0.95) << '\n';
+        m_file << now << ",all," << name << "_p99," << histogram->GetQuantile(0.99) << '\n';
+        m_file << now << ",all," << name << "_max," << histogram->GetMax() << '\n';
+    }
+    m_file.flush();
+}
+
+HttpMetricsCollector::AppSink::AppSink(HttpMetricsCollector* owner, uint32_t nodeId)
+    : m_owner(owner),
+      m_nodeId(nodeId)
+{
+}
+
+HttpMetricsCollector::NodeCounters&
+HttpMetricsCollector::AppSink::Counters()
+{
+    return m_owner->m_nodes[m_nodeId];
+}
+
+void
+HttpMetricsCollector::AppSink::ServerConnection(Ptr<const ThreeGppHttpServer>, Ptr<Socket>)
+{
+    ++Counters().connections;
+}
+
+void
+HttpMetricsCollector::AppSink::ServerMainObject(uint32_t size)
+{
+    ++Counters().mainObjects;
+    m_owner->m_objectSize.Add(size);
+}
+
+void
+HttpMetricsCollector::AppSink::ServerEmbeddedObject(uint32_t size)
+{
+    ++Counters().embeddedObjects;
+    m_owner->m_objectSize.Add(size);
+}
+
+void
+HttpMetricsCollector::AppSink::ServerTx(Ptr<const Packet> packet)
+{
+    NodeCounters& c = Counters();
+    ++c.txPackets;
+    c.txBytes += packet->GetSize();
+}
+
+void
+HttpMetricsCollector::AppSink::ClientMainObject(Ptr<const ThreeGppHttpClient>, Ptr<const Packet>)
+{
+    ++Counters().mainObjects;
+}
+
+void
+HttpMetricsCollector::AppSink::ClientEmbeddedObject(Ptr<const ThreeGppHttpClient>,
+                                                    Ptr<const Packet>)
+{
+    ++Counters().embeddedObjects;
+}
+
+void
+HttpMetricsCollector::AppSink::ClientRx(Ptr<const Packet> packet, const Address&)
+{
+    NodeCounters& c = Counters();
+    ++c.rxPackets;
+    c.rxBytes += packet->GetSize();
+}
+
+void
+HttpMetricsCollector::AppSink::ClientDelay(const Time& delay, const Address&)
+{
+    m_owner->m_packetDelay.Add(delay.GetSeconds() * 1000);
+}
+
+void
+HttpMetricsCollector::AppSink::ClientPage(Ptr<const ThreeGppHttpClient>,
+                                          const Time& time,
+                                          uint32_t,
+                                          uint32_t)
+{
+    ++Counters().pages;
+    m_owner->m_pageLoad.Add(time.GetSeconds() * 1000);
+}
+
+} // namespace ns3
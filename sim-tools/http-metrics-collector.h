@@ -0,0 +1,157 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef HTTP_METRICS_COLLECTOR_H
+#define HTTP_METRICS_COLLECTOR_H
+
+#include "fixed-bucket-histogram.h"
+#include "run-summary.h"
+
+#include "ns3/address.h"
+#include "ns3/application-container.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/packet.h"
+#include "ns3/socket.h"
+#include "ns3/three-gpp-http-client.h"
+#include "ns3/three-gpp-http-server.h"
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Counters and histograms of ThreeGppHttpServer and ThreeGppHttpClient
+ * applications, as a replacement for trace sinks that log every packet.
+ *
+ * The trace sinks only increment per-node counters and add to fixed-bucket
+ * histograms of object sizes, packet delays and page load times; nothing is
+ * formatted until a summary is written, every Interval and on Flush().
+ */
+class HttpMetricsCollector : public Object
+{
+  public:
+    HttpMetricsCollector();
+    ~HttpMetricsCollector() override;
+
+    /**
+     * Register this type.
+     * \return The TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * Connect to every HTTP server and client in a container; other
+     * applications are ignored.
+     * \param apps The applications.
+     */
+    void Install(const ApplicationContainer& apps);
+
+    /**
+     * Start writing a summary every Interval; the summaries keep the
+     * simulation going, so a stop time is needed.
+     * \param fileName The CSV file, in "time_s,node,metric,value" rows.
+     */
+    void Start(const std::string& fileName);
+
+    /// Write the final summary and close the file.
+    void Flush();
+
+    /**
+     * Add the totals and the histogram statistics to a run summary.
+     * \param summary The run summary.
+     */
+    void AddToSummary(RunSummary& summary) const;
+
+  private:
+    void DoDispose() override;
+
+    /// Counters of the HTTP applications of one node.
+    struct NodeCounters
+    {
+        bool installed{false};       //!< Whether the node has an HTTP application.
+        uint64_t connections{0};     //!< Connections accepted by a server.
+        uint64_t txPackets{0};       //!< Packets sent by a server.
+        uint64_t txBytes{0};         //!< Bytes sent by a server.
+        uint64_t rxPackets{0};       //!< Packets received by a client.
+        uint64_t rxBytes{0};         //!< Bytes received by a client.
+        uint64_t mainObjects{0};     //!< Main objects generated or received.
+        uint64_t embeddedObjects{0}; //!< Embedded objects generated or received.
+        uint64_t pages{0};           //!< Complete pages received by a client.
+    };
+
+    /// Trace sinks of one application, bound to its node.
+    class AppSink
+    {
+      public:
+        /**
+         * \param owner The collector.
+         * \param nodeId The node of the application.
+         */
+        AppSink(HttpMetricsCollector* owner, uint32_t nodeId);
+
+        /// ConnectionEstablished sink of a server.
+        void ServerConnection(Ptr<const ThreeGppHttpServer> server, Ptr<Socket> socket);
+        /// MainObject sink of a server.
+        void ServerMainObject(uint32_t size);
+        /// EmbeddedObject sink of a server.
+        void ServerEmbeddedObject(uint32_t size);
+        /// Tx sink of a server.
+        void ServerTx(Ptr<const Packet> packet);
+        /// RxMainObject sink of a client.
+        void ClientMainObject(Ptr<const ThreeGppHttpClient> client, Ptr<const Packet> packet);
+        /// RxEmbeddedObject sink of a client.
+        void ClientEmbeddedObject(Ptr<const ThreeGppHttpClient> client, Ptr<const Packet> packet);
+        /// Rx sink of a client.
+        void ClientRx(Ptr<const Packet> packet, const Address& from);
+        /// RxDelay sink of a client.
+        void ClientDelay(const Time& delay, const Address& from);
+        /// RxPage sink of a client.
+        void ClientPage(Ptr<const ThreeGppHttpClient> client,
+                        const Time& time,
+                        uint32_t objects,
+                        uint32_t bytes);
+
+      private:
+        /// \return The counters of the node.
+        NodeCounters& Counters();
+
+        HttpMetricsCollector* m_owner; //!< The collector.
+        uint32_t m_nodeId;             //!< Node of the application.
+    };
+
+    /// Write the summary rows of the current time.
+    void WriteSummary();
+    /// Write a summary and schedule the next one.
+    void PeriodicSummary();
+
+    Time m_interval;                               //!< Summary period.
+    std::vector<NodeCounters> m_nodes;             //!< Counters, indexed by node id.
+    std::vector<std::unique_ptr<AppSink>> m_sinks; //!< Sinks of the connected applications.
+    FixedBucketHistogram m_objectSize;             //!< Generated object sizes [bytes].
+    FixedBucketHistogram m_packetDelay;            //!< Client packet delays [ms].
+    FixedBucketHistogram m_pageLoad;               //!< Page load times [ms].
+    std::ofstream m_file;                          //!< Summary file.
+    EventId m_summaryEvent;                        //!< Next summary.
+};
+
+} // namespace ns3
+
+#endif /* HTTP_METRICS_COLLECTOR_H */
@@ -0,0 +1,269 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "http-qoe-tracker.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/lte-ue-rrc.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <fstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("HttpQoeTracker");
+
+NS_OBJECT_ENSURE_REGISTERED(HttpQoeTracker);
+
+namespace
+{
+
+/// Write the statistics of one histogram as a CSV row.
+void
+WriteRow(std::ostream& os,
+         const std::string& scope,
+         uint32_t id,
+         const std::string& metric,
+         const FixedBucketHistogram& histogram)
+{
+    os << scope << ',' << id << ',' << metric << ',' << histogram.GetCount() << ','
+       << histogram.GetMean() << ',' << histogram.GetQuantile(0.5) << ','
+       << histogram.GetQuantile(0.95) << ',' << histogram.GetQuantile(0.99) << ','
+       << histogram.GetMax() << '\n';
+}
+
+} // namespace
+
+TypeId
+HttpQoeTracker::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::HttpQoeTracker")
+            .SetParent<Object>()
+            .AddConstructor<HttpQoeTracker>()
+            .AddAttribute("PageLoadResolution",
+                          "Bucket width of the page load time histograms.",
+                          TimeValue(MilliSeconds(10)),
+                          MakeTimeAccessor(&HttpQoeTracker::m_pageLoadBucket),
+                          MakeTimeChecker(MicroSeconds(1)))
+            .AddAttribute("ObjectLatencyResolution",
+                          "Bucket width of the object latency histograms.",
+                          TimeValue(MilliSeconds(1)),
+                          MakeTimeAccessor(&HttpQoeTracker::m_objectLatencyBucket),
+                          MakeTimeChecker(MicroSeconds(1)))
+            .AddAttribute("Buckets",
+                          "Buckets per histogram; longer times fall in the last one.",
+                          UintegerValue(1000),
+                          MakeUintegerAccessor(&HttpQoeTracker::m_buckets),
+                          MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+HttpQoeTracker::HttpQoeTracker()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+HttpQoeTracker::~HttpQoeTracker()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+HttpQoeTracker::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_sinks.clear();
+    Object::DoDispose();
+}
+
+HttpQoeTracker::Distributions::Distributions(double pageLoadBucket,
+                                             double objectLatencyBucket,
+                                             uint32_t buckets)
+    : pageLoad(pageLoadBucket, buckets),
+      objectLatency(objectLatencyBucket, buckets)
+{
+}
+
+HttpQoeTracker::Distributions
+HttpQoeTracker::MakeDistributions() const
+{
+    return Distributions(m_pageLoadBucket.GetSeconds() * 1000,
+                         m_objectLatencyBucket.GetSeconds() * 1000,
+                         m_buckets);
+}
+
+void
+HttpQoeTracker::Install(const ApplicationContainer& apps)
+{
+    NS_LOG_FUNCTION(this << apps.GetN());
+    if (!m_all)
+    {
+        m_all = std::make_unique<Distributions>(MakeDistributions());
+    }
+    for (uint32_t i = 0; i < apps.GetN(); ++i)
+    {
+        Ptr<ThreeGppHttpClient> client = DynamicCast<ThreeGppHttpClient>(apps.Get(i));
+        if (!client)
+        {
+            continue;
+        }
+        Ptr<Node> node = client->GetNode();
+        Ptr<LteUeNetDevice> ueDevice;
+        for (uint32_t d = 0; d < node->GetNDevices() && !ueDevice; ++d)
+        {
+            ueDevice = DynamicCast<LteUeNetDevice>(node->GetDevice(d));
+        }
+        m_ues.try_emplace(node->GetId(), MakeDistributions());
+
+        m_sinks.push_back(std::make_unique<ClientSink>(this, node->GetId(), ueDevice));
+        ClientSink* sink = m_sinks.back().get();
+        client->TraceConnectWithoutContext("RxMainObject",
+                                           MakeCallback(&ClientSink::MainObject, sink));
+        client->TraceConnectWithoutContext("RxEmbeddedObject",
+                                           MakeCallback(&ClientSink::EmbeddedObject, sink));
+        client->TraceConnectWithoutContext("StateTransition",
+                                           MakeCallback(&ClientSink::StateTransition, sink));
+    }
+}
+
+template <typename F>
+void
+HttpQoeTracker::ForEachScope(uint32_t nodeId, uint16_t cellId, F f)
+{
+    f(m_ues.at(nodeId));
+    f(m_cells.try_emplace(cellId, MakeDistributions()).first->second);
+    f(*m_all);
+}
+
+void
+HttpQoeTracker::Write(const std::string& fileName) const
+{
+    NS_LOG_FUNCTION(this << fileName);
+    std::ofstream os(fileName, std::ios::out | std::ios::trunc);
+    NS_ABORT_MSG_IF(!os.is_open(), "Unable to open " << fileName);
+    os << "scope,id,metric,count,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+
+    auto writeScope = [&os](const std::string& scope, uint32_t id, const Distributions& d) {
+        WriteRow(os, scope, id, "pageLoad", d.pageLoad);
+        WriteRow(os, scope, id, "objectLatency", d.objectLatency);
+        os << scope << ',' << id << ",malformedObjects," << d.malformed << ",,,,,\n";
+    };
+    for (const auto& [node, d] : m_ues)
+    {
+        writeScope("ue", node, d);
+    }
+    for (const auto& [cell, d] : m_cells)
+    {
+        writeScope("cell", cell, d);
+    }
+    if (m_all)
+    {
+        writeScope("all", 0, *m_all);
+    }
+}
+
+void
+HttpQoeTracker::AddToSummary(RunSummary& summary) const
+{
+    if (!m_all)
+    {
+        return;
+    }
+    summary.Set("qoePages", m_all->pageLoad.GetCount());
+    summary.Set("qoePageLoadMeanMs", m_all->pageLoad.GetMean());
+    summary.Set("qoePageLoadP50Ms", m_all->pageLoad.GetQuantile(0.5));
+    summary.Set("qoePageLoadP95Ms", m_all->pageLoad.GetQuantile(0.95));
+    summary.Set("qoeObjectLatencyMeanMs", m_all->objectLatency.GetMean());
+    summary.Set("qoeObjectLatencyP95Ms", m_all->objectLatency.GetQuantile(0.95));
+    summary.Set("qoeMalformedObjects", m_all->malformed);
+}
+
+HttpQoeTracker::ClientSink::ClientSink(HttpQoeTracker* owner,
+                                       uint32_t nodeId,
+                                       Ptr<LteUeNetDevice> ueDevice)
+    : m_owner(owner),
+      m_nodeId(nodeId),
+      m_ueDevice(ueDevice)
+{
+}
+
+uint16_t
+HttpQoeTracker::ClientSink::GetCellId() const
+{
+    return m_ueDevice ? m_ueDevice->GetRrc()->GetCellId() : 0;
+}
+
+bool
+HttpQoeTracker::ClientSink::RecordObject(Ptr<const Packet> packet,
+                                         ThreeGppHttpHeader::ContentType_t type,
+                                         Time& requested)
+{
+    ThreeGppHttpHeader header;
+    const uint32_t headerSize = packet->PeekHeader(header);
+    const bool valid = headerSize > 0 && header.GetContentType() == type &&
+                       header.GetContentLength() == packet->GetSize() - headerSize;
+    if (!valid)
+    {
+        m_owner->ForEachScope(m_nodeId, GetCellId(), [](Distributions& d) { ++d.malformed; });
+        return false;
+    }
+    requested = header.GetClientTs();
+    const double latency = (Simulator::Now() - requested).GetSeconds() * 1000;
+    m_owner->ForEachScope(m_nodeId, GetCellId(), [latency](Distributions& d) {
+        d.objectLatency.Add(latency);
+    });
+    return true;
+}
+
+void
+HttpQoeTracker::ClientSink::MainObject(Ptr<const ThreeGppHttpClient>, Ptr<const Packet> packet)
+{
+    Time requested;
+    m_loadingPage = RecordObject(packet, ThreeGppHttpHeader::MAIN_OBJECT, requested);
+    if (m_loadingPage)
+    {
+        m_pageStart = requested;
+    }
+}
+
+void
+HttpQoeTracker::ClientSink::EmbeddedObject(Ptr<const ThreeGppHttpClient>,
+                                           Ptr<const Packet> packet)
+{
+    Time requested;
+    RecordObject(packet, ThreeGppHttpHeader::EMBEDDED_OBJECT, requested);
+}
+
+void
+HttpQoeTracker::ClientSink::StateTransition(const std::string&, const std::string& newState)
+{
+    // The client reads once the main object and all its embedded objects are in
+    if (newState != "READING" || !m_loadingPage)
+    {
+        return;
+    }
+    m_loadingPage = false;
+    const double pageLoad = (Simulator::Now() - m_pageStart).GetSeconds() * 1000;
+    m_owner->ForEachScope(m_nodeId, GetCellId(), [pageLoad](Distributions& d) {
+        d.pageLoad.Add(pageLoad);
+    });
+}
+
+} // namespace ns3
@@ -0,0 +1,163 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef HTTP_QOE_TRACKER_H
+#define HTTP_QOE_TRACKER_H
+
+#include "fixed-bucket-histogram.h"
+#include "run-summary.h"
+
+#include "ns3/application-container.h"
+#include "ns3/lte-ue-net-device.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/packet.h"
+#include "ns3/three-gpp-http-client.h"
+#include "ns3/three-gpp-http-header.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Page load time and object latency of ThreeGppHttpClient applications, per
+ * UE and per serving cell.
+ *
+ * Received objects are validated by peeking at their ThreeGppHttpHeader, the
+ * packet is neither copied nor deserialized. The latency of an object runs
+ * from the request (the client timestamp of the header) to its last byte; a
+ * page starts with the request of its main object and ends when the client
+ * goes to the READING state, after its last embedded object.
+ *
+ * The cell is the one serving the UE when the object or the page completes,
+ * or 0 when the client node has no LteUeNetDevice.
+ */
+class HttpQoeTracker : public Object
+{
+  public:
+    HttpQoeTracker();
+    ~HttpQoeTracker() override;
+
+    /**
+     * Register this type.
+     * \return The TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * Connect to every HTTP client in a container; other applications are
+     * ignored.
+     * \param apps The applications.
+     */
+    void Install(const ApplicationContainer& apps);
+
+    /**
+     * Write the distributions per UE, per cell and overall.
+     * \param fileName The CSV file.
+     */
+    void Write(const std::string& fileName) const;
+
+    /**
+     * Add the overall distributions to a run summary.
+     * \param summary The run summary.
+     */
+    void AddToSummary(RunSummary& summary) const;
+
+  private:
+    void DoDispose() override;
+
+    /// Distributions of one UE, one cell or all clients.
+    struct Distributions
+    {
+        /**
+         * \param pageLoadBucket Bucket width of the page load times [ms].
+         * \param objectLatencyBucket Bucket width of the object latencies [ms].
+         * \param buckets Number of buckets of both histograms.
+         */
+        Distributions(double pageLoadBucket, double objectLatencyBucket, uint32_t buckets);
+
+        FixedBucketHistogram pageLoad;      //!< Page load times [ms].
+        FixedBucketHistogram objectLatency; //!< Object latencies [ms].
+        uint64_t malformed{0};              //!< Objects whose header did not match.
+    };
+
+    /// Trace sinks of one client, and the page it is loading.
+    class ClientSink
+    {
+      public:
+        /**
+         * \param owner The tracker.
+         * \param nodeId The node of the client.
+         * \param ueDevice The LTE device of the node, if any.
+         */
+        ClientSink(HttpQoeTracker* owner, uint32_t nodeId, Ptr<LteUeNetDevice> ueDevice);
+
+        /// RxMainObject sink.
+        void MainObject(Ptr<const ThreeGppHttpClient> client, Ptr<const Packet> packet);
+        /// RxEmbeddedObject sink.
+        void EmbeddedObject(Ptr<const ThreeGppHttpClient> client, Ptr<const Packet> packet);
+        /// StateTransition sink.
+        void StateTransition(const std::string& oldState, const std::string& newState);
+
+      private:
+        /**
+         * Validate an object and record its latency.
+         * \param packet The object, with its header.
+         * \param type The expected content type.
+         * \param [out] requested The client timestamp of the object.
+         * \return Whether the object is valid.
+         */
+        bool RecordObject(Ptr<const Packet> packet,
+                          ThreeGppHttpHeader::ContentType_t type,
+                          Time& requested);
+
+        /// \return The cell serving the UE, 0 if unknown.
+        uint16_t GetCellId() const;
+
+        HttpQoeTracker* m_owner;        //!< The tracker.
+        uint32_t m_nodeId;              //!< Node of the client.
+        Ptr<LteUeNetDevice> m_ueDevice; //!< LTE device of the node, may be null.
+        Time m_pageStart;               //!< Request of the main object of the page.
+        bool m_loadingPage{false};      //!< Whether a main object has been received.
+    };
+
+    /**
+     * Apply a function to the distributions of a UE, its cell and all clients.
+     * \param nodeId The node of the UE.
+     * \param cellId The serving cell.
+     * \param f The function.
+     */
+    template <typename F>
+    void ForEachScope(uint32_t nodeId, uint16_t cellId, F f);
+
+    /// \return New, empty distributions with the configured geometry.
+    Distributions MakeDistributions() const;
+
+    Time m_pageLoadBucket;                            //!< Bucket width of the page load times.
+    Time m_objectLatencyBucket;                       //!< Bucket width of the object latencies.
+    uint32_t m_buckets;                               //!< Buckets per histogram.
+    std::map<uint32_t, Distributions> m_ues;          //!< Distributions per UE node.
+    std::map<uint16_t, Distributions> m_cells;        //!< Distributions per cell.
+    std::unique_ptr<Distributions> m_all;             //!< Distributions of all clients.
+    std::vector<std::unique_ptr<ClientSink>> m_sinks; //!< Sinks of the connected clients.
+};
+
+} // namespace ns3
+
+#endif /* HTTP_QOE_TRACKER_H */
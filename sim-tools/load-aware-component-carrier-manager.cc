@@ -0,0 +1,242 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "load-aware-component-carrier-manager.h"
+
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/lte-common.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LoadAwareComponentCarrierManager");
+
+NS_OBJECT_ENSURE_REGISTERED(LoadAwareComponentCarrierManager);
+
+namespace
+{
+
+/// Number of RSRQ report values (TS 36.133 9.1.7).
+const double RSRQ_RANGE = 35;
+
+} // namespace
+
+TypeId
+LoadAwareComponentCarrierManager::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::LoadAwareComponentCarrierManager")
+            .SetParent<RrComponentCarrierManager>()
+            .SetGroupName("Lte")
+            .AddConstructor<LoadAwareComponentCarrierManager>()
+            .AddAttribute("LoadSmoothing",
+                          "Weight of a new PRB occupancy report in the carrier load average.",
+                          DoubleValue(0.2),
+                          MakeDoubleAccessor(&LoadAwareComponentCarrierManager::m_smoothing),
+                          MakeDoubleChecker<double>(0, 1))
+            .AddAttribute("MinCarrierShare",
+                          "Free PRB share assumed for a fully loaded carrier, so it keeps "
+                          "getting traffic and its load keeps being measured.",
+                          DoubleValue(0.05),
+                          MakeDoubleAccessor(&LoadAwareComponentCarrierManager::m_minShare),
+                          MakeDoubleChecker<double>(0.001, 1))
+            .AddAttribute("SplitThreshold",
+                          "Buffers smaller than this [bytes] go whole to the best carrier.",
+                          UintegerValue(3000),
+                          MakeUintegerAccessor(&LoadAwareComponentCarrierManager::m_splitThreshold),
+                          MakeUintegerChecker<uint32_t>());
+    return tid;
+}
+
+LoadAwareComponentCarrierManager::LoadAwareComponentCarrierManager()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+LoadAwareComponentCarrierManager::~LoadAwareComponentCarrierManager()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+uint32_t
+LoadAwareComponentCarrierManager::GetCarriers(uint16_t rnti) const
+{
+    auto it = m_ueInfo.find(rnti);
+    NS_ASSERT_MSG(it != m_ueInfo.end(), "UE with provided RNTI not found. RNTI:" << rnti);
+    return std::max<uint32_t>(it->second.m_enabledComponentCarrier, 1);
+}
+
+std::vector<double>
+LoadAwareComponentCarrierManager::GetWeights(uint16_t rnti) const
+{
+    const uint32_t carriers = GetCarriers(rnti);
+    auto quality = m_quality.find(rnti);
+    std::vector<double> weights(carriers);
+    double sum = 0;
+    for (uint8_t cc = 0; cc < carriers; ++cc)
+    {
+        auto load = m_load.find(cc);
+        double weight = std::max(1 - (load != m_load.end() ? load->second : 0), m_minShare);
+        if (quality != m_quality.end())
+        {
+            // A carrier the UE has not reported on is assumed average
+            auto q = quality->second.find(cc);
+            weight *= q != quality->second.end() ? q->second : 0.5;
+        }
+        weights[cc] = weight;
+        sum += weight;
+    }
+    for (double& weight : weights)
+    {
+        weight /= sum;
+    }
+    return weights;
+}
+
+std::vector<uint32_t>
+LoadAwareComponentCarrierManager::Split(uint32_t bytes, const std::vector<double>& weights) const
+{
+    const auto best = std::max_element(weights.begin(), weights.end()) - weights.begin();
+    std::vector<uint32_t> shares(weights.size(), 0);
+    if (bytes < m_splitThreshold)
+    {
+        shares[best] = bytes;
+        return shares;
+    }
+    uint32_t assigned = 0;
+    for (std::size_t cc = 0; cc < weights.size(); ++cc)
+    {
+        shares[cc] = static_cast<uint32_t>(bytes * weights[cc]);
+        assigned += shares[cc];
+    }
+    shares[best] += bytes - assigned;
+    return shares;
+}
+
+void
+LoadAwareComponentCarrierManager::DoReportBufferStatus(
+    LteMacSapProvider::ReportBufferStatusParameters params)
+{
+    NS_LOG_FUNCTION(this);
+    const uint32_t carriers = GetCarriers(params.rnti);
+    if (params.lcid == 0 || params.lcid == 1 || carriers == 1)
+    {
+        // Signalling bearers stay on the primary carrier
+        RrComponentCarrierManager::DoReportBufferStatus(params);
+        return;
+    }
+
+    const std::vector<double> weights = GetWeights(params.rnti);
+    const std::vector<uint32_t> tx = Split(params.txQueueSize, weights);
+    const std::vector<uint32_t> retx = Split(params.retxQueueSize, weights);
+    const std::vector<uint32_t> status = Split(params.statusPduSize, weights);
+    for (uint8_t cc = 0; cc < carriers; ++cc)
+    {
+        LteMacSapProvider::ReportBufferStatusParameters share = params;
+        share.txQueueSize = tx[cc];
+        share.retxQueueSize = retx[cc];
+        share.statusPduSize = status[cc];
+        auto it = m_macSapProvidersMap.find(cc);
+        NS_ASSERT_MSG(it != m_macSapProvidersMap.end(), "Carrier " << +cc << " has no MAC");
+        it->second->ReportBufferStatus(share);
+    }
+}
+
+void
+LoadAwareComponentCarrierManager::DoUlReceiveMacCe(MacCeListElement_s bsr,
+                                                   uint8_t componentCarrierId)
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT_MSG(bsr.m_macCeType == MacCeListElement_s::BSR,
+                  "Received a Control Message not allowed " << bsr.m_macCeType);
+    const uint32_t carriers = GetCarriers(bsr.m_rnti);
+    const std::vector<double> weights = GetWeights(bsr.m_rnti);
+
+    // The buffer sizes are BSR indexes: expand, split and compress again
+    std::vector<MacCeListElement_s> shares(carriers, bsr);
+    for (std::size_t group = 0; group < bsr.m_macCeValue.m_bufferStatus.size(); ++group)
+    {
+        const uint32_t buffer =
+            BufferSizeLevelBsr::BsrId2BufferSize(bsr.m_macCeValue.m_bufferStatus[group]);
+        const std::vector<uint32_t> split = Split(buffer, weights);
+        for (uint8_t cc = 0; cc < carriers; ++cc)
+        {
+            shares[cc].m_macCeValue.m_bufferStatus[group] =
+                BufferSizeLevelBsr::BufferSize2BsrId(split[cc]);
+        }
+    }
+    for (uint8_t cc = 0; cc < carriers; ++cc)
+    {
+        auto it = m_ccmMacSapProviderMap.find(cc);
+        NS_ASSERT_MSG(it != m_ccmMacSapProviderMap.end(), "Carrier " << +cc << " has no MAC");
+        it->second->ReportMacCeToScheduler(shares[cc]);
+    }
+}
+
+void
+LoadAwareComponentCarrierManager::DoUlReceiveSr(uint16_t rnti, uint8_t componentCarrierId)
+{
+    NS_LOG_FUNCTION(this << rnti << +componentCarrierId);
+    const std::vector<double> weights = GetWeights(rnti);
+    const uint8_t best = std::max_element(weights.begin(), weights.end()) - weights.begin();
+    m_ccmMacSapProviderMap.at(best)->ReportSrToScheduler(rnti);
+}
+
+void
+LoadAwareComponentCarrierManager::DoNotifyPrbOccupancy(double prbOccupancy,
+                                                       uint8_t componentCarrierId)
+{
+    NS_LOG_FUNCTION(this << prbOccupancy << +componentCarrierId);
+    auto [it, inserted] = m_load.emplace(componentCarrierId, prbOccupancy);
+    if (!inserted)
+    {
+        it->second += m_smoothing * (prbOccupancy - it->second);
+    }
+    RrComponentCarrierManager::DoNotifyPrbOccupancy(prbOccupancy, componentCarrierId);
+}
+
+void
+LoadAwareComponentCarrierManager::DoReportUeMeas(uint16_t rnti, LteRrcSap::MeasResults measResults)
+{
+    NS_LOG_FUNCTION(this << rnti << +measResults.measId);
+    std::map<uint8_t, double>& quality = m_quality[rnti];
+    quality[0] = (measResults.measResultPCell.rsrqResult + 1) / RSRQ_RANGE;
+    if (measResults.haveMeasResultServFreqList)
+    {
+        for (const auto& servFreq : measResults.measResultServFreqList)
+        {
+            if (servFreq.haveMeasResultSCell)
+            {
+                quality[servFreq.servFreqId] =
+                    (servFreq.measResultSCell.rsrqResult + 1) / RSRQ_RANGE;
+            }
+        }
+    }
+    RrComponentCarrierManager::DoReportUeMeas(rnti, measResults);
+}
+
+void
+LoadAwareComponentCarrierManager::DoRemoveUe(uint16_t rnti)
+{
+    NS_LOG_FUNCTION(this << rnti);
+    m_quality.erase(rnti);
+    RrComponentCarrierManager::DoRemoveUe(rnti);
+}
+
+} // namespace ns3
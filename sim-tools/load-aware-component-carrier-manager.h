@@ -0,0 +1,90 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LOAD_AWARE_COMPONENT_CARRIER_MANAGER_H
+#define LOAD_AWARE_COMPONENT_CARRIER_MANAGER_H
+
+#include "ns3/no-op-component-carrier-manager.h"
+
+#include <map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Component carrier manager that splits the buffers of a UE in proportion to
+ * the spare capacity of every carrier and the link quality of the UE on it,
+ * instead of in equal parts like RrComponentCarrierManager.
+ *
+ * The weight of a carrier for a UE is its smoothed free PRB share (from the
+ * PRB occupancy the MACs report, at least MinCarrierShare) times the RSRQ the
+ * UE last reported on it. Downlink buffer status and uplink BSRs are split by
+ * these weights. A buffer below SplitThreshold, typically a periodic UDP
+ * packet, is not split: it goes whole to the best carrier of the UE, so a
+ * small flow is not fragmented into transport blocks on every carrier and
+ * waits only for the least loaded one. Scheduling requests go to the best
+ * carrier as well.
+ */
+class LoadAwareComponentCarrierManager : public RrComponentCarrierManager
+{
+  public:
+    LoadAwareComponentCarrierManager();
+    ~LoadAwareComponentCarrierManager() override;
+
+    /**
+     * Register this type.
+     * \return The TypeId.
+     */
+    static TypeId GetTypeId();
+
+  protected:
+    void DoReportBufferStatus(LteMacSapProvider::ReportBufferStatusParameters params) override;
+    void DoUlReceiveMacCe(MacCeListElement_s bsr, uint8_t componentCarrierId) override;
+    void DoUlReceiveSr(uint16_t rnti, uint8_t componentCarrierId) override;
+    void DoNotifyPrbOccupancy(double prbOccupancy, uint8_t componentCarrierId) override;
+    void DoReportUeMeas(uint16_t rnti, LteRrcSap::MeasResults measResults) override;
+    void DoRemoveUe(uint16_t rnti) override;
+
+  private:
+    /**
+     * \param rnti The UE.
+     * \return The weight of every carrier enabled for the UE; they sum to 1.
+     */
+    std::vector<double> GetWeights(uint16_t rnti) const;
+
+    /**
+     * Split a byte count by weights; the rounding remainder goes to the
+     * heaviest carrier, and a small count goes whole to it.
+     * \param bytes The byte count.
+     * \param weights The carrier weights.
+     * \return The bytes of every carrier.
+     */
+    std::vector<uint32_t> Split(uint32_t bytes, const std::vector<double>& weights) const;
+
+    /// \return The number of carriers enabled for a UE.
+    uint32_t GetCarriers(uint16_t rnti) const;
+
+    double m_smoothing;               //!< EWMA weight of a new PRB report.
+    double m_minShare;                //!< Floor of the free PRB share.
+    uint32_t m_splitThreshold;        //!< Smaller buffers are not split.
+    std::map<uint8_t, double> m_load; //!< Smoothed PRB occupancy per carrier.
+    /// Last RSRQ per UE and carrier, scaled to (0, 1].
+    std::map<uint16_t, std::map<uint8_t, double>> m_quality;
+};
+
+} // namespace ns3
+
+#endif /* LOAD_AWARE_COMPONENT_CARRIER_MANAGER_H */
@@ -0,0 +1,135 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "log-bucket-histogram.h"
+
+#include "bucket-quantile.h"
+
+#include "ns3/abort.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3
+{
+
+LogBucketHistogram::LogBucketHistogram(double resolution, double highest, uint32_t subBuckets)
+    : m_resolution(resolution),
+      m_subBuckets(subBuckets)
+{
+    NS_ABORT_MSG_IF(resolution <= 0 || highest < resolution || subBuckets == 0,
+                    "Invalid histogram geometry");
+    // [0, r) and one group per power of two up to highest
+    const uint32_t groups = 1 + static_cast<uint32_t>(std::ceil(std::log2(highest / resolution)));
+    m_counts.assign((groups + 1) * subBuckets, 0);
+}
+
+void
+LogBucketHistogram::Add(double value)
+{
+    const double scaled = std::max(0.0, value / m_resolution);
+    uint32_t index;
+    if (scaled < 1)
+    {
+        index = static_cast<uint32_t>(scaled * m_subBuckets);
+    }
+    else
+    {
+        // scaled = mantissa * 2^exponent with mantissa in [0.5, 1)
+        int exponent;
+        const double mantissa = std::frexp(scaled, &exponent);
+        index = exponent * m_subBuckets + static_cast<uint32_t>((2 * mantissa - 1) * m_subBuckets);
+    }
+    ++m_counts[std::min<uint32_t>(index, m_counts.size() - 1)];
+    ++m_count;
+    m_sum += value;
+    m_max = m_count == 1 ? value : std::max(m_max, value);
+}
+
+void
+LogBucketHistogram::Merge(const LogBucketHistogram& other)
+{
+    NS_ABORT_MSG_IF(other.m_counts.size() != m_counts.size() ||
+                        other.m_resolution != m_resolution ||
+                        other.m_subBuckets != m_subBuckets,
+                    "Merging histograms of different geometries");
+    if (other.m_count == 0)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < m_counts.size(); ++i)
+    {
+        m_counts[i] += other.m_counts[i];
+    }
+    m_max = m_count == 0 ? other.m_max : std::max(m_max, other.m_max);
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+}
+
+uint64_t
+LogBucketHistogram::GetCount() const
+{
+    return m_count;
+}
+
+double
+LogBucketHistogram::GetMean() const
+{
+    return m_count > 0 ? m_sum / m_count : 0;
+}
+
+double
+LogBucketHistogram::GetMax() const
+{
+    return m_max;
+}
+
+double
+LogBucketHistogram::GetBucketStart(uint32_t index) const
+{
+    const uint32_t group = index / m_subBuckets;
+    const uint32_t sub = index % m_subBuckets;
+    if (group == 0)
+    {
+        return m_resolution * sub / m_subBuckets;
+    }
+    const double groupStart = std::ldexp(m_resolution, group - 1);
+    return groupStart + groupStart * sub / m_subBuckets;
+}
+
+double
+LogBucketHistogram::GetQuantile(double q) const
+{
+    return GetBucketQuantile(m_counts, m_count, m_max, q, [this](uint32_t i) {
+        return GetBucketStart(i);
+    });
+}
+
+uint32_t
+LogBucketHistogram::GetNBuckets() const
+{
+    return m_counts.size();
+}
+
+void
+LogBucketHistogram::Reset()
+{
+    std::fill(m_counts.begin(), m_counts.end(), 0);
+    m_count = 0;
+    m_sum = 0;
+    m_max = 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,92 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LOG_BUCKET_HISTOGRAM_H
+#define LOG_BUCKET_HISTOGRAM_H
+
+#include <cstdint>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Histogram with logarithmic buckets of constant relative width, in the
+ * style of HdrHistogram, allocated once.
+ *
+ * Every power of two of the resolution, [r * 2^k, r * 2^(k+1)), is split in
+ * subBuckets equal buckets, and [0, r) in subBuckets more, so a quantile is
+ * exact to 1 / subBuckets of its value over the whole range, from
+ * microseconds to seconds, with a few hundred counters. Values beyond the
+ * highest trackable one are counted in the last bucket.
+ */
+class LogBucketHistogram
+{
+  public:
+    /**
+     * \param resolution Smallest distinguishable value, the width of [0, r).
+     * \param highest Largest value tracked without overflowing.
+     * \param subBuckets Buckets per power of two.
+     */
+    LogBucketHistogram(double resolution, double highest, uint32_t subBuckets);
+
+    /// \param value A sample; negative values go to the first bucket.
+    void Add(double value);
+
+    /**
+     * Add the samples of another histogram of the same geometry.
+     * \param other The histogram.
+     */
+    void Merge(const LogBucketHistogram& other);
+
+    /// \return The number of samples.
+    uint64_t GetCount() const;
+
+    /// \return The mean of the samples, 0 without samples.
+    double GetMean() const;
+
+    /// \return The largest sample.
+    double GetMax() const;
+
+    /**
+     * \param q The quantile, in [0, 1].
+     * \return The estimated quantile, 0 without samples.
+     */
+    double GetQuantile(double q) const;
+
+    /// \return The number of buckets.
+    uint32_t GetNBuckets() const;
+
+    /// Forget all samples.
+    void Reset();
+
+  private:
+    /**
+     * \param index A bucket.
+     * \return The lower edge of the bucket.
+     */
+    double GetBucketStart(uint32_t index) const;
+
+    double m_resolution;            //!< Width of the first power of two.
+    uint32_t m_subBuckets;          //!< Buckets per power of two.
+    std::vector<uint64_t> m_counts; //!< Samples per bucket.
+    uint64_t m_count{0};            //!< Number of samples.
+    double m_sum{0};                //!< Sum of the samples.
+    double m_max{0};                //!< Largest sample.
+};
+
+} // namespace ns3
+
+#endif /* LOG_BUCKET_HISTOGRAM_H */
@@ -0,0 +1,80 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+// Prints an LTE KPI trace as CSV, one line per record, e.g.
+//
+//   ./ns3 run "lte-kpi-dump --file=lte-full.kpi --imsi=3"
+//
+// Every KPI has a count, min, mean and max column; a KPI without samples in
+// the interval has a count of 0.
+
+#include "lte-kpi-tracer.h"
+
+#include "ns3/core-module.h"
+
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("LteKpiDump");
+
+int
+main(int argc, char* argv[])
+{
+    std::string fileName;
+    uint64_t imsi = 0;
+    uint16_t cellId = 0;
+
+    CommandLine cmd;
+    cmd.AddValue("file", "LTE KPI trace", fileName);
+    cmd.AddValue("imsi", "Print only this UE (0 prints all)", imsi);
+    cmd.AddValue("cellId", "Print only this cell (0 prints all)", cellId);
+    cmd.Parse(argc, argv);
+
+    LteKpiReader reader;
+    if (!reader.Open(fileName))
+    {
+        std::cerr << "Cannot read " << fileName << "\n";
+        return 1;
+    }
+
+    std::cout << "time_s,imsi,cellId,rnti";
+    for (std::size_t k = 0; k < LTE_KPI_COUNT; ++k)
+    {
+        const std::string name = GetLteKpiName(static_cast<LteKpi>(k));
+        std::cout << "," << name << "Count," << name << "Min," << name << "Mean," << name
+                  << "Max";
+    }
+    std::cout << "\n";
+
+    LteKpiRecord record;
+    while (reader.Next(record))
+    {
+        if ((imsi != 0 && record.imsi != imsi) || (cellId != 0 && record.cellId != cellId))
+        {
+            continue;
+        }
+        std::cout << record.time.GetSeconds() << "," << record.imsi << "," << record.cellId
+                  << "," << record.rnti;
+        for (const LteKpiSummary& kpi : record.kpis)
+        {
+            std::cout << "," << kpi.count << "," << kpi.min << "," << kpi.mean << ","
+                      << kpi.max;
+        }
+        std::cout << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,468 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "lte-kpi-tracer.h"
+
+#include "ns3/abort.h"
+#include "ns3/config.h"
+#include "ns3/log.h"
+#include "ns3/lte-enb-net-device.h"
+#include "ns3/lte-pdcp.h"
+#include "ns3/lte-radio-bearer-info.h"
+#include "ns3/lte-rlc.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/object-map.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LteKpiTracer");
+
+NS_OBJECT_ENSURE_REGISTERED(LteKpiTracer);
+
+namespace
+{
+
+/// Magic number at the start of a trace.
+const char KPI_MAGIC[8] = {'N', 'S', '3', 'L', 'T', 'K', 'P', 'I'};
+/// Version of the record layout.
+const uint32_t KPI_VERSION = 1;
+/// Size of the writer buffers.
+const std::size_t KPI_BUFFER_SIZE = 256 * 1024;
+/// Number of writer buffers that may wait for the disk.
+const uint32_t KPI_BUFFERS = 8;
+/// Target BER of the CQI mapping, as in LteAmc::CreateCqiFeedbacks.
+const double KPI_CQI_BER = 0.00005;
+
+/// \return The key of a UE in a cell.
+uint32_t
+UeKey(uint16_t cellId, uint16_t rnti)
+{
+    return (static_cast<uint32_t>(cellId) << 16) | rnti;
+}
+
+/// Append the bytes of a value to a record.
+template <typename T>
+void
+Put(std::vector<uint8_t>& record, T value)
+{
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+    record.insert(record.end(), bytes, bytes + sizeof(T));
+}
+
+/// Read a value written by Put.
+template <typename T>
+bool
+Get(std::ifstream& is, T& value)
+{
+    return static_cast<bool>(is.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+} // namespace
+
+const char*
+GetLteKpiName(LteKpi kpi)
+{
+    switch (kpi)
+    {
+    case LteKpi::RSRP:
+        return "rsrp";
+    case LteKpi::SINR:
+        return "sinr";
+    case LteKpi::CQI:
+        return "cqi";
+    case LteKpi::MCS:
+        return "mcs";
+    case LteKpi::RLC_BUFFER:
+        return "rlcBuffer";
+    }
+    return "unknown";
+}
+
+void
+LteKpiTracer::Aggregate::Add(double value)
+{
+    min = count == 0 ? value : std::min(min, value);
+    max = count == 0 ? value : std::max(max, value);
+    sum += value;
+    ++count;
+}
+
+TypeId
+LteKpiTracer::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::LteKpiTracer")
+                            .SetParent<Object>()
+                            .AddConstructor<LteKpiTracer>()
+                            .AddAttribute("Interval",
+                                          "Period over which the KPIs of a UE are aggregated "
+                                          "into one record.",
+                                          TimeValue(MilliSeconds(100)),
+                                          MakeTimeAccessor(&LteKpiTracer::m_interval),
+                                          MakeTimeChecker(MilliSeconds(1)));
+    return tid;
+}
+
+LteKpiTracer::LteKpiTracer()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+LteKpiTracer::~LteKpiTracer()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+LteKpiTracer::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    Close();
+    for (const auto& connection : m_connections)
+    {
+        connection.source->TraceDisconnectWithoutContext(connection.name, connection.callback);
+    }
+    m_connections.clear();
+    m_ueDevices.clear();
+    m_amc = nullptr;
+    Object::DoDispose();
+}
+
+void
+LteKpiTracer::Start(const std::string& fileName)
+{
+    NS_LOG_FUNCTION(this << fileName);
+    NS_ABORT_MSG_IF(m_writer.IsOpen(), "The KPI trace is already started");
+    m_writer.Open(fileName, KPI_BUFFER_SIZE, KPI_BUFFERS);
+    m_record.clear();
+    m_record.insert(m_record.end(), KPI_MAGIC, KPI_MAGIC + sizeof(KPI_MAGIC));
+    Put(m_record, KPI_VERSION);
+    Put(m_record, uint32_t(0));
+    Put(m_record, static_cast<int64_t>(m_interval.GetNanoSeconds()));
+    m_writer.Write(m_record.data(), m_record.size());
+    m_amc = CreateObject<LteAmc>();
+
+    const std::string phys = "/NodeList/*/DeviceList/*/ComponentCarrierMapUe/*/LteUePhy/";
+    Config::ConnectWithoutContext(phys + "ReportCurrentCellRsrpSinr",
+                                  MakeCallback(&LteKpiTracer::ReportRsrpSinr, this));
+    Config::ConnectWithoutContext(phys + "DlSpectrumPhy/DlPhyReception",
+                                  MakeCallback(&LteKpiTracer::DlPhyReception, this));
+
+    for (uint32_t n = 0; n < NodeList::GetNNodes(); ++n)
+    {
+        Ptr<Node> node = NodeList::GetNode(n);
+        for (uint32_t d = 0; d < node->GetNDevices(); ++d)
+        {
+            // The bearers exist once the RRC has configured them, and again
+            // after a handover
+            if (Ptr<LteUeNetDevice> ue = DynamicCast<LteUeNetDevice>(node->GetDevice(d)))
+            {
+                m_ueDevices.push_back(ue);
+                Ptr<LteUeRrc> rrc = ue->GetRrc();
+                for (const char* name : {"ConnectionReconfiguration", "HandoverEndOk"})
+                {
+                    Connect(rrc,
+                            name,
+                            MakeBoundCallback(&LteKpiTracer::UeBearersChanged, this, rrc));
+                }
+            }
+            if (Ptr<LteEnbNetDevice> enb = DynamicCast<LteEnbNetDevice>(node->GetDevice(d)))
+            {
+                Ptr<LteEnbRrc> rrc = enb->GetRrc();
+                for (const char* name : {"ConnectionReconfiguration", "HandoverEndOk"})
+                {
+                    Connect(rrc,
+                            name,
+                            MakeBoundCallback(&LteKpiTracer::EnbBearersChanged, this, rrc));
+                }
+            }
+        }
+    }
+    m_writeEvent = Simulator::Schedule(m_interval, &LteKpiTracer::WriteInterval, this);
+}
+
+void
+LteKpiTracer::Close()
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_writer.IsOpen())
+    {
+        return;
+    }
+    m_writeEvent.Cancel();
+    WriteRecords();
+    m_writer.Close();
+}
+
+LteKpiTracer::UeKpis&
+LteKpiTracer::GetUe(uint16_t cellId, uint16_t rnti)
+{
+    return m_ues[UeKey(cellId, rnti)];
+}
+
+void
+LteKpiTracer::ReportRsrpSinr(uint16_t cellId,
+                             uint16_t rnti,
+                             double rsrp,
+                             double sinr,
+                             uint8_t /* componentCarrierId */)
+{
+    UeKpis& ue = GetUe(cellId, rnti);
+    ue.kpis[static_cast<std::size_t>(LteKpi::RSRP)].Add(rsrp);
+    if (sinr <= 0)
+    {
+        return;
+    }
+    ue.kpis[static_cast<std::size_t>(LteKpi::SINR)].Add(10 * std::log10(sinr));
+    // Wideband CQI of a flat channel at this SINR, with the mapping of LteAmc
+    const double gap = -std::log(5 * KPI_CQI_BER) / 1.5;
+    const double spectralEfficiency = std::log2(1 + sinr / gap);
+    ue.kpis[static_cast<std::size_t>(LteKpi::CQI)].Add(
+        m_amc->GetCqiFromSpectralEfficiency(spectralEfficiency));
+}
+
+void
+LteKpiTracer::DlPhyReception(PhyReceptionStatParameters params)
+{
+    UeKpis& ue = GetUe(params.m_cellId, params.m_rnti);
+    ue.imsi = params.m_imsi;
+    ue.kpis[static_cast<std::size_t>(LteKpi::MCS)].Add(params.m_mcs);
+}
+
+void
+LteKpiTracer::Connect(Ptr<Object> source, const std::string& name, const CallbackBase& callback)
+{
+    // A UE is reconfigured more than once with the same bearers
+    for (const auto& connection : m_connections)
+    {
+        if (connection.source == source && connection.name == name)
+        {
+            return;
+        }
+    }
+    if (!source->TraceConnectWithoutContext(name, callback))
+    {
+        NS_LOG_WARN("No " << name << " trace source in " << source->GetInstanceTypeId().GetName());
+        return;
+    }
+    m_connections.push_back({source, name, callback});
+}
+
+void
+LteKpiTracer::ConnectEnbBearers(Ptr<LteEnbRrc> rrc, uint16_t cellId, uint16_t rnti)
+{
+    if (!rrc->HasUeManager(rnti))
+    {
+        return;
+    }
+    ObjectMapValue bearers;
+    rrc->GetUeManager(rnti)->GetAttribute("DataRadioBearerMap", bearers);
+    for (auto it = bearers.Begin(); it != bearers.End(); ++it)
+    {
+        Ptr<LteDataRadioBearerInfo> bearer = DynamicCast<LteDataRadioBearerInfo>(it->second);
+        const uint8_t lcid = bearer->m_logicalChannelIdentity;
+        Connect(bearer->m_pdcp,
+                "TxPDU",
+                MakeBoundCallback(&LteKpiTracer::PdcpTx, this, cellId));
+        Connect(bearer->m_rlc,
+                "TxDrop",
+                MakeBoundCallback(&LteKpiTracer::RlcDrop, this, cellId, rnti, lcid));
+    }
+}
+
+void
+LteKpiTracer::ConnectUeBearers(Ptr<LteUeRrc> rrc)
+{
+    ObjectMapValue bearers;
+    rrc->GetAttribute("DataRadioBearerMap", bearers);
+    for (auto it = bearers.Begin(); it != bearers.End(); ++it)
+    {
+        Ptr<LteDataRadioBearerInfo> bearer = DynamicCast<LteDataRadioBearerInfo>(it->second);
+        Connect(bearer->m_pdcp, "RxPDU", MakeBoundCallback(&LteKpiTracer::PdcpRx, this, rrc));
+    }
+}
+
+void
+LteKpiTracer::AddBacklog(uint16_t cellId, uint16_t rnti, uint8_t lcid, int64_t bytes)
+{
+    // A PDU lost over the air is never received, so keep the count from
+    // drifting below zero on the way back
+    std::map<uint8_t, int64_t>& channels = m_backlogs[UeKey(cellId, rnti)];
+    int64_t& backlog = channels[lcid];
+    backlog = std::max<int64_t>(0, backlog + bytes);
+    int64_t total = 0;
+    for (const auto& [channel, channelBytes] : channels)
+    {
+        total += channelBytes;
+    }
+    GetUe(cellId, rnti).kpis[static_cast<std::size_t>(LteKpi::RLC_BUFFER)].Add(total);
+}
+
+void
+LteKpiTracer::EnbBearersChanged(LteKpiTracer* tracer,
+                                Ptr<LteEnbRrc> rrc,
+                                uint64_t /* imsi */,
+                                uint16_t cellId,
+                                uint16_t rnti)
+{
+    // The trace fires before the RRC has finished setting up the bearers
+    Simulator::ScheduleNow(&LteKpiTracer::ConnectEnbBearers, tracer, rrc, cellId, rnti);
+}
+
+void
+LteKpiTracer::UeBearersChanged(LteKpiTracer* tracer,
+                               Ptr<LteUeRrc> rrc,
+                               uint64_t /* imsi */,
+                               uint16_t /* cellId */,
+                               uint16_t /* rnti */)
+{
+    Simulator::ScheduleNow(&LteKpiTracer::ConnectUeBearers, tracer, rrc);
+}
+
+void
+LteKpiTracer::PdcpTx(LteKpiTracer* tracer,
+                     uint16_t cellId,
+                     uint16_t rnti,
+                     uint8_t lcid,
+                     uint32_t bytes)
+{
+    tracer->AddBacklog(cellId, rnti, lcid, bytes);
+}
+
+void
+LteKpiTracer::RlcDrop(LteKpiTracer* tracer,
+                      uint16_t cellId,
+                      uint16_t rnti,
+                      uint8_t lcid,
+                      Ptr<const Packet> packet)
+{
+    tracer->AddBacklog(cellId, rnti, lcid, -static_cast<int64_t>(packet->GetSize()));
+}
+
+void
+LteKpiTracer::PdcpRx(LteKpiTracer* tracer,
+                     Ptr<LteUeRrc> rrc,
+                     uint16_t rnti,
+                     uint8_t lcid,
+                     uint32_t bytes,
+                     uint64_t /* delay */)
+{
+    // The cell of the UE at reception, which changes on a handover
+    tracer->AddBacklog(rrc->GetCellId(), rnti, lcid, -static_cast<int64_t>(bytes));
+}
+
+void
+LteKpiTracer::WriteInterval()
+{
+    WriteRecords();
+    m_writeEvent = Simulator::Schedule(m_interval, &LteKpiTracer::WriteInterval, this);
+}
+
+void
+LteKpiTracer::WriteRecords()
+{
+    if (m_ues.empty())
+    {
+        return;
+    }
+    // IMSIs of the UEs whose reception has not been seen, from their RRC
+    std::map<uint32_t, uint64_t> imsis;
+    for (const auto& device : m_ueDevices)
+    {
+        Ptr<LteUeRrc> rrc = device->GetRrc();
+        imsis[UeKey(rrc->GetCellId(), rrc->GetRnti())] = device->GetImsi();
+    }
+
+    const int64_t now = Simulator::Now().GetNanoSeconds();
+    for (const auto& [key, ue] : m_ues)
+    {
+        uint64_t imsi = ue.imsi;
+        if (imsi == 0)
+        {
+            auto it = imsis.find(key);
+            imsi = it != imsis.end() ? it->second : 0;
+        }
+        m_record.clear();
+        Put(m_record, now);
+        Put(m_record, imsi);
+        Put(m_record, static_cast<uint16_t>(key >> 16));
+        Put(m_record, static_cast<uint16_t>(key & 0xffff));
+        for (const Aggregate& kpi : ue.kpis)
+        {
+            const uint32_t count = std::min<uint32_t>(kpi.count, 0xffff);
+            Put(m_record, static_cast<uint16_t>(count));
+            Put(m_record, static_cast<float>(kpi.min));
+            Put(m_record, static_cast<float>(kpi.count > 0 ? kpi.sum / kpi.count : 0));
+            Put(m_record, static_cast<float>(kpi.max));
+        }
+        m_writer.Write(m_record.data(), m_record.size());
+    }
+    m_ues.clear();
+}
+
+bool
+LteKpiReader::Open(const std::string& fileName)
+{
+    m_file.open(fileName, std::ios::in | std::ios::binary);
+    char magic[sizeof(KPI_MAGIC)];
+    uint32_t version = 0;
+    uint32_t reserved = 0;
+    int64_t interval = 0;
+    if (!m_file.read(magic, sizeof(magic)) ||
+        std::memcmp(magic, KPI_MAGIC, sizeof(magic)) != 0 || !Get(m_file, version) ||
+        version != KPI_VERSION || !Get(m_file, reserved) || !Get(m_file, interval))
+    {
+        return false;
+    }
+    m_interval = NanoSeconds(interval);
+    return true;
+}
+
+Time
+LteKpiReader::GetInterval() const
+{
+    return m_interval;
+}
+
+bool
+LteKpiReader::Next(LteKpiRecord& record)
+{
+    int64_t time = 0;
+    if (!Get(m_file, time) || !Get(m_file, record.imsi) || !Get(m_file, record.cellId) ||
+        !Get(m_file, record.rnti))
+    {
+        return false;
+    }
+    record.time = NanoSeconds(time);
+    for (LteKpiSummary& kpi : record.kpis)
+    {
+        if (!Get(m_file, kpi.count) || !Get(m_file, kpi.min) || !Get(m_file, kpi.mean) ||
+            !Get(m_file, kpi.max))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace ns3
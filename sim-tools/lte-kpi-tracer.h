@@ -0,0 +1,279 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef LTE_KPI_TRACER_H
+#define LTE_KPI_TRACER_H
+
+#include "async-file-writer.h"
+
+#include "ns3/event-id.h"
+#include "ns3/lte-amc.h"
+#include "ns3/lte-common.h"
+#include "ns3/lte-enb-rrc.h"
+#include "ns3/lte-ue-net-device.h"
+#include "ns3/lte-ue-rrc.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/packet.h"
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+// Layout of an LTE KPI trace. All values are little endian.
+//
+//   header  magic "NS3LTKPI", version (uint32), reserved (uint32),
+//           interval in nanoseconds (int64)
+//   record  end of the interval in nanoseconds (int64), imsi (uint64),
+//           cell id (uint16), rnti (uint16), then for every KPI in LteKpi
+//           order the sample count (uint16) and min, mean, max (float32)
+//
+// Records are 90 bytes; a UE gets one per interval and serving cell in which
+// it has samples.
+
+namespace ns3
+{
+
+/// KPIs of an LTE KPI trace, in record order.
+enum class LteKpi : uint8_t
+{
+    RSRP = 0,      //!< RSRP of the serving cell [dBm].
+    SINR = 1,      //!< Average downlink SINR [dB].
+    CQI = 2,       //!< Wideband CQI matching the SINR.
+    MCS = 3,       //!< MCS of the received downlink transport blocks.
+    RLC_BUFFER = 4 //!< Downlink RLC backlog of the UE [bytes].
+};
+
+/// Number of KPIs of a record.
+constexpr std::size_t LTE_KPI_COUNT = 5;
+
+/// Aggregate of one KPI over an interval.
+struct LteKpiSummary
+{
+    uint16_t count{0}; //!< Samples; saturates at 65535.
+    float min{0};      //!< Smallest sample.
+    float mean{0};     //!< Mean of the samples.
+    float max{0};      //!< Largest sample.
+};
+
+/// One record of an LTE KPI trace.
+struct LteKpiRecord
+{
+    Time time;                                     //!< End of the interval.
+    uint64_t imsi{0};                              //!< UE, 0 if it could not be resolved.
+    uint16_t cellId{0};                            //!< Serving cell.
+    uint16_t rnti{0};                              //!< RNTI of the UE in the cell.
+    std::array<LteKpiSummary, LTE_KPI_COUNT> kpis; //!< Aggregates, indexed by LteKpi.
+};
+
+/**
+ * Sampled per-UE LTE KPIs, a lightweight alternative to
+ * LteHelper::EnableTraces for large runs.
+ *
+ * Instead of a text line per TTI and UE for every layer, the tracer keeps the
+ * count, min, mean and max of the RSRP, SINR, CQI, MCS and RLC buffer of
+ * every UE over each Interval and writes them as one fixed-size binary record
+ * through an AsyncFileWriter, so the trace is under a kilobyte per UE and
+ * second at the default Interval and the simulation thread never waits for
+ * the disk.
+ *
+ * The radio samples come from the UE PHY (ReportCurrentCellRsrpSinr,
+ * DlPhyReception). No RLC entity traces its buffer, so the RLC KPI is the
+ * downlink backlog of the data radio bearers, from their PDCP and RLC traces:
+ * the bytes the eNB PDCP handed to RLC, less those the RLC dropped and those
+ * the UE PDCP received. It counts the bytes queued at the eNB and those still
+ * in HARQ or reordering, and is sampled on every change. The bearer traces
+ * are connected as the bearers are set up, with the cell bound in the
+ * callback, and disconnected on disposal; the simulated stack is left as it
+ * is. With carrier aggregation a UE has a record per serving cell and its
+ * backlog is in the record of its primary cell. The trace is converted to CSV
+ * offline by lte-kpi-dump.
+ */
+class LteKpiTracer : public Object
+{
+  public:
+    LteKpiTracer();
+    ~LteKpiTracer() override;
+
+    /**
+     * Register this type.
+     * \return The TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * Open the trace and connect to the UEs and eNBs. Call once all LTE
+     * devices are installed.
+     * \param fileName The trace file.
+     */
+    void Start(const std::string& fileName);
+
+    /// Write the last, possibly partial, interval and close the trace.
+    void Close();
+
+  private:
+    void DoDispose() override;
+
+    /// Count, sum and range of one KPI over an interval.
+    struct Aggregate
+    {
+        uint32_t count{0}; //!< Samples.
+        double sum{0};     //!< Sum of the samples.
+        double min{0};     //!< Smallest sample.
+        double max{0};     //!< Largest sample.
+
+        /// \param value A sample.
+        void Add(double value);
+    };
+
+    /// Aggregates of a UE in a cell over the current interval.
+    struct UeKpis
+    {
+        uint64_t imsi{0};                          //!< UE, once known.
+        std::array<Aggregate, LTE_KPI_COUNT> kpis; //!< Indexed by LteKpi.
+    };
+
+    /**
+     * \param cellId A cell.
+     * \param rnti A UE in the cell.
+     * \return The aggregates of the UE in the cell.
+     */
+    UeKpis& GetUe(uint16_t cellId, uint16_t rnti);
+
+    /// ReportCurrentCellRsrpSinr sink.
+    void ReportRsrpSinr(uint16_t cellId,
+                        uint16_t rnti,
+                        double rsrp,
+                        double sinr,
+                        uint8_t componentCarrierId);
+    /// DlPhyReception sink.
+    void DlPhyReception(PhyReceptionStatParameters params);
+
+    /**
+     * Connect a trace sink once and remember it for DoDispose.
+     * \param source The object with the trace source.
+     * \param name The trace source.
+     * \param callback The sink.
+     */
+    void Connect(Ptr<Object> source, const std::string& name, const CallbackBase& callback);
+    /// Connect the bearers of a UE at an eNB, once the RRC has set them up.
+    void ConnectEnbBearers(Ptr<LteEnbRrc> rrc, uint16_t cellId, uint16_t rnti);
+    /// Connect the bearers of a UE, once its RRC has set them up.
+    void ConnectUeBearers(Ptr<LteUeRrc> rrc);
+    /**
+     * Count bytes into or out of the backlog of a bearer and sample the UE backlog.
+     * \param cellId The cell.
+     * \param rnti The UE in the cell.
+     * \param lcid The logical channel of the bearer.
+     * \param bytes Bytes queued, negative when they leave.
+     */
+    void AddBacklog(uint16_t cellId, uint16_t rnti, uint8_t lcid, int64_t bytes);
+
+    /// ConnectionReconfiguration and HandoverEndOk sink of an eNB RRC.
+    static void EnbBearersChanged(LteKpiTracer* tracer,
+                                  Ptr<LteEnbRrc> rrc,
+                                  uint64_t imsi,
+                                  uint16_t cellId,
+                                  uint16_t rnti);
+    /// ConnectionReconfiguration and HandoverEndOk sink of a UE RRC.
+    static void UeBearersChanged(LteKpiTracer* tracer,
+                                 Ptr<LteUeRrc> rrc,
+                                 uint64_t imsi,
+                                 uint16_t cellId,
+                                 uint16_t rnti);
+    /// TxPDU sink of an eNB PDCP: bytes handed to RLC.
+    static void PdcpTx(LteKpiTracer* tracer,
+                       uint16_t cellId,
+                       uint16_t rnti,
+                       uint8_t lcid,
+                       uint32_t bytes);
+    /// TxDrop sink of an eNB RLC: an SDU dropped from the buffer.
+    static void RlcDrop(LteKpiTracer* tracer,
+                        uint16_t cellId,
+                        uint16_t rnti,
+                        uint8_t lcid,
+                        Ptr<const Packet> packet);
+    /// RxPDU sink of a UE PDCP: bytes delivered by RLC.
+    static void PdcpRx(LteKpiTracer* tracer,
+                       Ptr<LteUeRrc> rrc,
+                       uint16_t rnti,
+                       uint8_t lcid,
+                       uint32_t bytes,
+                       uint64_t delay);
+
+    /// Write a record per UE with samples, reset the aggregates and schedule the next write.
+    void WriteInterval();
+    /// Write a record per UE with samples and reset the aggregates.
+    void WriteRecords();
+
+    Time m_interval;                              //!< Aggregation interval.
+    AsyncFileWriter m_writer;                     //!< Output of the records.
+    std::vector<uint8_t> m_record;                //!< Record being built.
+    Ptr<LteAmc> m_amc;                            //!< SINR to CQI mapping.
+    std::vector<Ptr<LteUeNetDevice>> m_ueDevices; //!< All UEs, to resolve IMSIs.
+    std::map<uint32_t, UeKpis> m_ues;             //!< Aggregates by cell and RNTI.
+    /// Backlog per cell and RNTI, and logical channel.
+    std::map<uint32_t, std::map<uint8_t, int64_t>> m_backlogs;
+    /// A connected trace sink.
+    struct Connection
+    {
+        Ptr<Object> source;    //!< Object with the trace source.
+        std::string name;      //!< Trace source.
+        CallbackBase callback; //!< Sink, to disconnect it.
+    };
+
+    std::vector<Connection> m_connections; //!< Sinks of the RRC and bearer traces.
+    EventId m_writeEvent;                  //!< Next write.
+};
+
+/// Sequential reader of the traces written by LteKpiTracer.
+class LteKpiReader
+{
+  public:
+    /**
+     * Open a trace and read its header.
+     * \param fileName The trace file.
+     * \return False if the file is missing or is not a KPI trace.
+     */
+    bool Open(const std::string& fileName);
+
+    /// \return The aggregation interval of the trace.
+    Time GetInterval() const;
+
+    /**
+     * Read the next record.
+     * \param record The record.
+     * \return False at the end of the trace or on a truncated record.
+     */
+    bool Next(LteKpiRecord& record);
+
+  private:
+    std::ifstream m_file; //!< The trace.
+    Time m_interval;      //!< Aggregation interval.
+};
+
+/**
+ * \param kpi A KPI.
+ * \return Its name, as used in CSV columns.
+ */
+const char* GetLteKpiName(LteKpi kpi);
+
+} // namespace ns3
+
+#endif /* LTE_KPI_TRACER_H */
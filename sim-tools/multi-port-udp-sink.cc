@@ -0,0 +1,247 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "multi-port-udp-sink.h"
+
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/seq-ts-header.h"
+#include "ns3/simulator.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("MultiPortUdpSink");
+
+NS_OBJECT_ENSURE_REGISTERED(MultiPortUdpSink);
+
+uint64_t
+MultiPortUdpSink::Flow::GetLost() const
+{
+    const uint64_t expected = tsPackets > 0 ? uint64_t(maxSeq) + 1 : 0;
+    return expected > tsPackets ? expected - tsPackets : 0;
+}
+
+TypeId
+MultiPortUdpSink::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::MultiPortUdpSink")
+            .SetParent<Application>()
+            .AddConstructor<MultiPortUdpSink>()
+            .AddAttribute("FirstPort",
+                          "The first port to bind.",
+                          UintegerValue(9),
+                          MakeUintegerAccessor(&MultiPortUdpSink::m_firstPort),
+                          MakeUintegerChecker<uint16_t>(1))
+            .AddAttribute("PortCount",
+                          "The number of consecutive ports to bind.",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&MultiPortUdpSink::m_portCount),
+                          MakeUintegerChecker<uint16_t>(1))
+            .AddAttribute("DelayStats",
+                          "Read the SeqTsHeader of every datagram to track delays and losses.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&MultiPortUdpSink::m_delayStats),
+                          MakeBooleanChecker())
+            .AddTraceSource("Rx",
+                            "A datagram has been received.",
+                            MakeTraceSourceAccessor(&MultiPortUdpSink::m_rxTrace),
+                            "ns3::Packet::AddressTracedCallback");
+    return tid;
+}
+
+MultiPortUdpSink::MultiPortUdpSink()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+MultiPortUdpSink::~MultiPortUdpSink()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+MultiPortUdpSink::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_sockets.clear();
+    Application::DoDispose();
+}
+
+uint64_t
+MultiPortUdpSink::GetTotalRx() const
+{
+    return m_totalRx;
+}
+
+std::size_t
+MultiPortUdpSink::GetFlowCount() const
+{
+    return m_flows.size();
+}
+
+uint64_t
+MultiPortUdpSink::GetKey(uint16_t port, const Address& from)
+{
+    const InetSocketAddress address = InetSocketAddress::ConvertFrom(from);
+    return (uint64_t(port) << 48) | (uint64_t(address.GetIpv4().Get()) << 16) |
+           address.GetPort();
+}
+
+const MultiPortUdpSink::Flow*
+MultiPortUdpSink::GetFlow(uint16_t port, const Address& from) const
+{
+    auto it = m_flows.find(GetKey(port, from));
+    return it != m_flows.end() ? &it->second : nullptr;
+}
+
+void
+MultiPortUdpSink::StartApplication()
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_sockets.empty())
+    {
+        return;
+    }
+    NS_ABORT_MSG_IF(uint32_t(m_firstPort) + m_portCount > 65536, "Port range beyond 65535");
+    for (uint32_t port = m_firstPort; port < uint32_t(m_firstPort) + m_portCount; ++port)
+    {
+        Ptr<Socket> socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+        NS_ABORT_MSG_IF(socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), port)) == -1,
+                        "Failed to bind port " << port);
+        socket->SetRecvCallback(MakeCallback(&MultiPortUdpSink::HandleRead, this));
+        m_sockets.push_back(socket);
+    }
+}
+
+void
+MultiPortUdpSink::StopApplication()
+{
+    NS_LOG_FUNCTION(this);
+    for (const auto& socket : m_sockets)
+    {
+        socket->Close();
+        socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+    }
+    m_sockets.clear();
+}
+
+void
+MultiPortUdpSink::HandleRead(Ptr<Socket> socket)
+{
+    Address local;
+    socket->GetSockName(local);
+    const uint16_t port = InetSocketAddress::ConvertFrom(local).GetPort();
+    const Time now = Simulator::Now();
+    const uint32_t headerSize = SeqTsHeader().GetSerializedSize();
+
+    Ptr<Packet> packet;
+    Address from;
+    while ((packet = socket->RecvFrom(from)))
+    {
+        if (packet->GetSize() == 0)
+        {
+            break;
+        }
+        Flow& flow = m_flows[GetKey(port, from)];
+        if (flow.rxPackets == 0)
+        {
+            flow.firstRx = now;
+        }
+        ++flow.rxPackets;
+        flow.rxBytes += packet->GetSize();
+        flow.lastRx = now;
+        m_totalRx += packet->GetSize();
+        if (m_delayStats && packet->GetSize() >= headerSize)
+        {
+            SeqTsHeader header;
+            packet->PeekHeader(header);
+            const Time delay = now - header.GetTs();
+            ++flow.tsPackets;
+            flow.delaySum += delay;
+            flow.maxDelay = Max(flow.maxDelay, delay);
+            flow.maxSeq = std::max(flow.maxSeq, header.GetSeq());
+        }
+        m_rxTrace(packet, from);
+    }
+}
+
+void
+MultiPortUdpSink::PrintHeader(std::ostream& os)
+{
+    os << "node,port,source,sourcePort,rxPackets,rxBytes,lost,throughputKbps,meanDelayMs,"
+          "maxDelayMs\n";
+}
+
+void
+MultiPortUdpSink::Print(std::ostream& os) const
+{
+    const uint32_t nodeId = GetNode()->GetId();
+    for (const auto& [key, flow] : m_flows)
+    {
+        const double seconds = (flow.lastRx - flow.firstRx).GetSeconds();
+        os << nodeId << ',' << (key >> 48) << ','
+           << Ipv4Address(static_cast<uint32_t>(key >> 16)) << ',' << (key & 0xffff) << ','
+           << flow.rxPackets << ',' << flow.rxBytes << ',' << flow.GetLost() << ','
+           << (seconds > 0 ? flow.rxBytes * 8.0 / seconds / 1024 : 0) << ','
+           << (flow.tsPackets > 0 ? flow.delaySum.GetSeconds() * 1000 / flow.tsPackets : 0)
+           << ','
+           << flow.maxDelay.GetSeconds() * 1000 << '\n';
+    }
+}
+
+MultiPortUdpSinkHelper::MultiPortUdpSinkHelper(uint16_t firstPort, uint16_t portCount)
+{
+    m_factory.SetTypeId(MultiPortUdpSink::GetTypeId());
+    m_factory.Set("FirstPort", UintegerValue(firstPort));
+    m_factory.Set("PortCount", UintegerValue(portCount));
+}
+
+void
+MultiPortUdpSinkHelper::SetAttribute(const std::string& name, const AttributeValue& value)
+{
+    m_factory.Set(name, value);
+}
+
+ApplicationContainer
+MultiPortUdpSinkHelper::Install(NodeContainer nodes) const
+{
+    ApplicationContainer apps;
+    for (auto it = nodes.Begin(); it != nodes.End(); ++it)
+    {
+        apps.Add(Install(*it));
+    }
+    return apps;
+}
+
+ApplicationContainer
+MultiPortUdpSinkHelper::Install(Ptr<Node> node) const
+{
+    Ptr<Application> app = m_factory.Create<Application>();
+    node->AddApplication(app);
+    return ApplicationContainer(app);
+}
+
+} // namespace ns3
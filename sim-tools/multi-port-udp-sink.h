@@ -0,0 +1,170 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef MULTI_PORT_UDP_SINK_H
+#define MULTI_PORT_UDP_SINK_H
+
+#include "ns3/address.h"
+#include "ns3/application-container.h"
+#include "ns3/application.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/object-factory.h"
+#include "ns3/packet.h"
+#include "ns3/socket.h"
+#include "ns3/traced-callback.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * UDP sink of a whole range of ports and senders, in place of one PacketSink
+ * per flow.
+ *
+ * The application binds PortCount consecutive ports from FirstPort, one socket
+ * each, and counts what it receives per flow, i.e. per local port and remote
+ * address and port. The flows share one hash table keyed by a single integer,
+ * so the cost of a packet and the memory of a flow do not grow with the number
+ * of flows; many senders can target the same port, which keeps the socket
+ * demultiplexing of the node short as well. With DelayStats set, every
+ * datagram is expected to start with a SeqTsHeader, as sent by UdpClient and
+ * BurstUdpClient, and the sink also tracks the delay and the losses of every
+ * flow, like UdpServer.
+ */
+class MultiPortUdpSink : public Application
+{
+  public:
+    /// Counters of one flow.
+    struct Flow
+    {
+        uint64_t rxPackets{0}; //!< Received datagrams.
+        uint64_t rxBytes{0};   //!< Received bytes.
+        Time firstRx;          //!< Reception of the first datagram.
+        Time lastRx;           //!< Reception of the last datagram.
+        uint64_t tsPackets{0}; //!< Datagrams whose SeqTsHeader was read, with DelayStats.
+        Time delaySum;         //!< Sum of the delays of those datagrams.
+        Time maxDelay;         //!< Largest delay, with DelayStats.
+        uint32_t maxSeq{0};    //!< Highest sequence number, with DelayStats.
+
+        /// \return The timestamped datagrams missing below the highest sequence number.
+        uint64_t GetLost() const;
+    };
+
+    MultiPortUdpSink();
+    ~MultiPortUdpSink() override;
+
+    /**
+     * Register this type.
+     * \return The TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /// \return The bytes received on all ports.
+    uint64_t GetTotalRx() const;
+
+    /// \return The number of flows seen.
+    std::size_t GetFlowCount() const;
+
+    /**
+     * \param port A local port.
+     * \param from The sender, an InetSocketAddress.
+     * \return The counters of the flow, null if nothing was received from it.
+     */
+    const Flow* GetFlow(uint16_t port, const Address& from) const;
+
+    /**
+     * Print the header line of Print.
+     * \param os The output stream.
+     */
+    static void PrintHeader(std::ostream& os);
+
+    /**
+     * Print one CSV line per flow, prefixed by the node id.
+     * \param os The output stream.
+     */
+    void Print(std::ostream& os) const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    void StartApplication() override;
+    void StopApplication() override;
+
+    /// Receive callback of all sockets.
+    void HandleRead(Ptr<Socket> socket);
+
+    /**
+     * \param port A local port.
+     * \param from The sender, an InetSocketAddress.
+     * \return The key of the flow.
+     */
+    static uint64_t GetKey(uint16_t port, const Address& from);
+
+    uint16_t m_firstPort;                       //!< First bound port.
+    uint16_t m_portCount;                       //!< Number of bound ports.
+    bool m_delayStats;                          //!< Whether datagrams carry a SeqTsHeader.
+    std::vector<Ptr<Socket>> m_sockets;         //!< One socket per port.
+    std::unordered_map<uint64_t, Flow> m_flows; //!< Counters by flow key.
+    uint64_t m_totalRx{0};                      //!< Bytes received.
+
+    TracedCallback<Ptr<const Packet>, const Address&> m_rxTrace; //!< Every datagram.
+};
+
+/**
+ * Installs MultiPortUdpSink, like PacketSinkHelper.
+ */
+class MultiPortUdpSinkHelper
+{
+  public:
+    /**
+     * \param firstPort The first port to bind.
+     * \param portCount The number of consecutive ports to bind.
+     */
+    MultiPortUdpSinkHelper(uint16_t firstPort, uint16_t portCount = 1);
+
+    /**
+     * Set an attribute of the applications to install.
+     * \param name The attribute name.
+     * \param value The attribute value.
+     */
+    void SetAttribute(const std::string& name, const AttributeValue& value);
+
+    /**
+     * \param nodes The nodes.
+     * \return One application per node.
+     */
+    ApplicationContainer Install(NodeContainer nodes) const;
+
+    /**
+     * \param node The node.
+     * \return The application.
+     */
+    ApplicationContainer Install(Ptr<Node> node) const;
+
+  private:
+    ObjectFactory m_factory; //!< Application factory.
+};
+
+} // namespace ns3
+
+#endif /* MULTI_PORT_UDP_SINK_H */
@@ -0,0 +1,592 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "parameter-sweep.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <sys/wait.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <sstream>
+#include <thread>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ParameterSweep");
+
+namespace
+{
+
+/// Name of the summary file every run is asked to write.
+const char SUMMARY_FILE[] = "summary.csv";
+
+/// \return The argument quoted for /bin/sh.
+std::string
+ShellQuote(const std::string& argument)
+{
+    std::string quoted = "'";
+    for (char c : argument)
+    {
+        if (c == '\'')
+        {
+            quoted += "'\\''";
+        }
+        else
+        {
+            quoted += c;
+        }
+    }
+    return quoted + "'";
+}
+
+/// \return The metrics of a "metric,value" summary file, empty if missing.
+std::map<std::string, double>
+ReadSummary(const std::string& fileName)
+{
+    std::map<std::string, double> metrics;
+    std::ifstream is(fileName);
+    std::string line;
+    while (std::getline(is, line))
+    {
+        std::size_t comma = line.find(',');
+        if (comma == std::string::npos || line.compare(0, comma, "metric") == 0)
+        {
+            continue;
+        }
+        metrics[line.substr(0, comma)] = std::strtod(line.c_str() + comma + 1, nullptr);
+    }
+    return metrics;
+}
+
+/// File of a cache entry holding the wall-clock duration of its run.
+const char CACHE_META_FILE[] = "cache-meta.txt";
+
+/// 64-bit FNV-1a offset basis.
+const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+
+/// \return The FNV-1a hash of some bytes, continuing from hash.
+uint64_t
+Fnv1a(const char* data, std::size_t size, uint64_t hash)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/// \return The FNV-1a hash of the contents of a file, continuing from hash.
+uint64_t
+HashFile(const std::string& fileName, uint64_t hash)
+{
+    std::ifstream is(fileName, std::ios::binary);
+    NS_ABORT_MSG_IF(!is.is_open(), "Unable to read " << fileName);
+    std::vector<char> buffer(1 << 16);
+    while (is.read(buffer.data(), buffer.size()) || is.gcount() > 0)
+    {
+        hash = Fnv1a(buffer.data(), is.gcount(), hash);
+    }
+    return hash;
+}
+
+/// \return The hash as 16 hexadecimal digits.
+std::string
+ToHex(uint64_t hash)
+{
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(hash));
+    return text;
+}
+
+/// \return The shared libraries a binary loads, as resolved by ldd.
+std::vector<std::string>
+GetLibraries(const std::string& program)
+{
+    std::vector<std::string> libraries;
+    FILE* ldd = popen(("ldd " + ShellQuote(program) + " 2>/dev/null").c_str(), "r");
+    if (!ldd)
+    {
+        return libraries;
+    }
+    // "libns3.40-lte-default.so => /path/libns3.40-lte-default.so (0x...)"
+    char line[4096];
+    while (std::fgets(line, sizeof(line), ldd))
+    {
+        const std::string text(line);
+        const std::size_t arrow = text.find("=> /");
+        if (arrow != std::string::npos)
+        {
+            const std::string path = text.substr(arrow + 3, text.find(" (", arrow) - arrow - 3);
+            libraries.push_back(path);
+        }
+    }
+    pclose(ldd);
+    return libraries;
+}
+
+/**
+ * Copy a directory tree, hard linking the files when the file system allows.
+ * \return False if it could not be copied.
+ */
+bool
+CopyTree(const std::filesystem::path& from, const std::filesystem::path& to)
+{
+    namespace fs = std::filesystem;
+    std::error_code error;
+    fs::copy(from, to, fs::copy_options::recursive | fs::copy_options::create_hard_links, error);
+    if (error)
+    {
+        fs::remove_all(to, error);
+        fs::copy(from, to, fs::copy_options::recursive, error);
+    }
+    return !error;
+}
+
+/// Jobs owned by one worker.
+struct WorkQueue
+{
+    std::mutex mutex;             //!< Protects jobs.
+    std::deque<std::size_t> jobs; //!< Indexes of the points, most expensive first.
+};
+
+} // namespace
+
+void
+ParameterSweep::SetProgram(const std::string& program)
+{
+    m_program = std::filesystem::absolute(program).string();
+}
+
+void
+ParameterSweep::SetOutputDirectory(const std::string& directory)
+{
+    m_outputDirectory = std::filesystem::absolute(directory).string();
+}
+
+void
+ParameterSweep::SetThreads(uint32_t threads)
+{
+    m_threads = threads;
+}
+
+void
+ParameterSweep::SetCacheDirectory(const std::string& directory)
+{
+    m_cacheDirectory = directory.empty() ? "" : std::filesystem::absolute(directory).string();
+}
+
+void
+ParameterSweep::SetRuns(uint32_t first, uint32_t count)
+{
+    m_firstRun = first;
+    m_runCount = count;
+}
+
+void
+ParameterSweep::AddParameter(const std::string& name, const std::vector<std::string>& values)
+{
+    NS_ABORT_MSG_IF(values.empty(), "Parameter " << name << " has no values");
+    m_grid.emplace_back(name, values);
+}
+
+bool
+ParameterSweep::AddGrid(const std::string& grid)
+{
+    std::istringstream parameters(grid);
+    for (std::string parameter; std::getline(parameters, parameter, ';');)
+    {
+        if (parameter.empty())
+        {
+            continue;
+        }
+        std::size_t equal = parameter.find('=');
+        if (equal == std::string::npos || equal == 0)
+        {
+            return false;
+        }
+        std::vector<std::string> values;
+        std::istringstream list(parameter.substr(equal + 1));
+        for (std::string value; std::getline(list, value, ',');)
+        {
+            values.push_back(value);
+        }
+        if (values.empty())
+        {
+            return false;
+        }
+        AddParameter(parameter.substr(0, equal), values);
+    }
+    return true;
+}
+
+void
+ParameterSweep::AddFixedArgument(const std::string& argument)
+{
+    m_fixedArguments.push_back(argument);
+}
+
+std::vector<SweepPoint>
+ParameterSweep::Expand() const
+{
+    std::vector<SweepPoint> points(1);
+    for (const auto& [name, values] : m_grid)
+    {
+        std::vector<SweepPoint> expanded;
+        expanded.reserve(points.size() * values.size());
+        for (const auto& point : points)
+        {
+            for (const auto& value : values)
+            {
+                SweepPoint p = point;
+                p.params.emplace_back(name, value);
+                expanded.push_back(std::move(p));
+            }
+        }
+        points = std::move(expanded);
+    }
+
+    std::vector<SweepPoint> withRuns;
+    withRuns.reserve(points.size() * m_runCount);
+    for (const auto& point : points)
+    {
+        for (uint32_t r = 0; r < m_runCount; ++r)
+        {
+            SweepPoint p = point;
+            p.run = m_firstRun + r;
+            withRuns.push_back(std::move(p));
+        }
+    }
+    return withRuns;
+}
+
+std::vector<SweepResult>
+ParameterSweep::Run(const std::vector<SweepPoint>& points) const
+{
+    NS_LOG_FUNCTION(this << points.size());
+    NS_ABORT_MSG_IF(m_program.empty(), "No scenario program set");
+
+    uint32_t threads = m_threads > 0 ? m_threads : std::thread::hardware_concurrency();
+    threads = std::max<uint32_t>(1, std::min<std::size_t>(threads, points.size()));
+
+    // Deal the jobs round robin, most expensive first, so every worker starts
+    // with its longest job and the short ones are left over for stealing
+    std::vector<std::size_t> order(points.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&points](std::size_t a, std::size_t b) {
+        return EstimateCost(points[a]) > EstimateCost(points[b]);
+    });
+    std::vector<WorkQueue> queues(threads);
+    for (std::size_t i = 0; i < order.size(); ++i)
+    {
+        queues[i % threads].jobs.push_back(order[i]);
+    }
+
+    const std::string buildId = m_cacheDirectory.empty() ? "" : GetBuildId();
+    std::vector<SweepResult> results(points.size());
+    std::atomic<std::size_t> done{0};
+    std::mutex outputMutex;
+
+    auto worker = [&](uint32_t self) {
+        while (true)
+        {
+            std::size_t job = points.size();
+            {
+                std::lock_guard<std::mutex> lock(queues[self].mutex);
+                if (!queues[self].jobs.empty())
+                {
+                    job = queues[self].jobs.front();
+                    queues[self].jobs.pop_front();
+                }
+            }
+            for (uint32_t k = 1; job == points.size() && k < threads; ++k)
+            {
+                WorkQueue& victim = queues[(self + k) % threads];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.jobs.empty())
+                {
+                    job = victim.jobs.back();
+                    victim.jobs.pop_back();
+                }
+            }
+            if (job == points.size())
+            {
+                return;
+            }
+
+            results[job] = Execute(points[job], buildId);
+            std::size_t finished = ++done;
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cout << "[" << finished << "/" << points.size() << "] "
+                      << results[job].directory << " exit=" << results[job].exitCode
+                      << " wall=" << results[job].wallSeconds << "s"
+                      << (results[job].cached ? " cached" : "") << std::endl;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (uint32_t t = 0; t < threads; ++t)
+    {
+        pool.emplace_back(worker, t);
+    }
+    for (auto& thread : pool)
+    {
+        thread.join();
+    }
+    return results;
+}
+
+void
+ParameterSweep::WriteTable(const std::vector<SweepResult>& results, const std::string& fileName)
+{
+    NS_LOG_FUNCTION(results.size() << fileName);
+    std::ofstream os(fileName, std::ios::out | std::ios::trunc);
+    NS_ABORT_MSG_IF(!os.is_open(), "Unable to open " << fileName);
+
+    std::set<std::string> metricNames;
+    for (const auto& result : results)
+    {
+        for (const auto& metric : result.metrics)
+        {
+            metricNames.insert(metric.first);
+        }
+    }
+
+    if (!results.empty())
+    {
+        for (const auto& param : results.front().point.params)
+        {
+            os << param.first << ',';
+        }
+    }
+    os << "RngRun,exitCode,wallSeconds,cached";
+    for (const auto& name : metricNames)
+    {
+        os << ',' << name;
+    }
+    os << '\n';
+
+    for (const auto& result : results)
+    {
+        for (const auto& param : result.point.params)
+        {
+            os << param.second << ',';
+        }
+        os << result.point.run << ',' << result.exitCode << ',' << result.wallSeconds << ','
+           << result.cached;
+        for (const auto& name : metricNames)
+        {
+            os << ',';
+            auto it = result.metrics.find(name);
+            if (it != result.metrics.end())
+            {
+                os << it->second;
+            }
+        }
+        os << '\n';
+    }
+}
+
+std::string
+ParameterSweep::GetDirectory(const SweepPoint& point) const
+{
+    std::string name;
+    for (const auto& [param, value] : point.params)
+    {
+        name += param + "=" + value + "_";
+    }
+    name += "run" + std::to_string(point.run);
+    for (char& c : name)
+    {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '=' && c != '.' && c != '-' &&
+            c != '_')
+        {
+            c = '_';
+        }
+    }
+    return (std::filesystem::path(m_outputDirectory) / name).string();
+}
+
+double
+ParameterSweep::EstimateCost(const SweepPoint& point)
+{
+    // Sizes and durations are what make a run long, and they are the numeric
+    // parameters; their product ranks the jobs well enough for scheduling
+    double cost = 1;
+    for (const auto& param : point.params)
+    {
+        double value = std::strtod(param.second.c_str(), nullptr);
+        if (value > 0)
+        {
+            cost *= value;
+        }
+    }
+    return cost;
+}
+
+std::vector<std::string>
+ParameterSweep::GetArguments(const SweepPoint& point) const
+{
+    std::vector<std::string> arguments;
+    for (const auto& [param, value] : point.params)
+    {
+        arguments.push_back("--" + param + "=" + value);
+    }
+    arguments.insert(arguments.end(), m_fixedArguments.begin(), m_fixedArguments.end());
+    arguments.push_back("--RngRun=" + std::to_string(point.run));
+    return arguments;
+}
+
+std::string
+ParameterSweep::GetBuildId() const
+{
+    NS_LOG_FUNCTION(this);
+    // The system libraries do not change between two builds of a scenario;
+    // the ns-3 and scratch libraries are where most of its code lives
+    uint64_t hash = HashFile(m_program, FNV_OFFSET);
+    for (const auto& library : GetLibraries(m_program))
+    {
+        if (library.rfind("/lib", 0) != 0 && library.rfind("/usr/lib", 0) != 0)
+        {
+            hash = HashFile(library, hash);
+        }
+    }
+    return ToHex(hash);
+}
+
+std::string
+ParameterSweep::GetCacheKey(const SweepPoint& point, const std::string& buildId) const
+{
+    // Sorted by name, so the order of the grid does not matter; the sort is
+    // stable, so a repeated argument keeps the value CommandLine would use
+    std::vector<std::string> arguments = GetArguments(point);
+    std::stable_sort(arguments.begin(),
+                     arguments.end(),
+                     [](const std::string& a, const std::string& b) {
+                         return a.substr(0, a.find('=')) < b.substr(0, b.find('='));
+                     });
+    std::string key = "scenario=" + std::filesystem::path(m_program).filename().string() +
+                      "\nbuild=" + buildId + "\n";
+    for (const auto& argument : arguments)
+    {
+        key += "arg=" + argument + "\n";
+        // An argument naming an input file (e.g. a mobility trace) is only
+        // reproducible while that file is: key its contents, not its name.
+        // The scenario runs in the point directory, so resolve it from there
+        std::size_t equals = argument.find('=');
+        if (equals == std::string::npos || equals + 1 == argument.size())
+        {
+            continue;
+        }
+        std::filesystem::path input = argument.substr(equals + 1);
+        if (input.is_relative())
+        {
+            input = std::filesystem::path(GetDirectory(point)) / input;
+        }
+        std::error_code error;
+        if (std::filesystem::is_regular_file(input, error))
+        {
+            key += "input=" + ToHex(HashFile(input.string(), FNV_OFFSET)) + "\n";
+        }
+    }
+    for (const char* variable : {"NS_GLOBAL_VALUE", "NS_ATTRIBUTE_DEFAULT"})
+    {
+        const char* value = std::getenv(variable);
+        key += std::string(variable) + "=" + (value ? value : "") + "\n";
+    }
+    return ToHex(Fnv1a(key.data(), key.size(), FNV_OFFSET));
+}
+
+SweepResult
+ParameterSweep::Execute(const SweepPoint& point, const std::string& buildId) const
+{
+    SweepResult result;
+    result.point = point;
+    result.directory = GetDirectory(point);
+    const std::filesystem::path summary = std::filesystem::path(result.directory) / SUMMARY_FILE;
+
+    std::filesystem::path entry;
+    if (!m_cacheDirectory.empty())
+    {
+        // Keyed before the directory goes, as an input file may be in it
+        entry = std::filesystem::path(m_cacheDirectory) / GetCacheKey(point, buildId);
+        // Files restored from the cache may be links to it: start from
+        // scratch rather than overwrite them
+        std::filesystem::remove_all(result.directory);
+        if (std::filesystem::is_directory(entry) && CopyTree(entry, result.directory))
+        {
+            NS_LOG_INFO("Restored " << result.directory << " from " << entry);
+            std::ifstream(entry / CACHE_META_FILE) >> result.wallSeconds;
+            result.exitCode = 0;
+            result.cached = true;
+            result.metrics = ReadSummary(summary.string());
+            return result;
+        }
+    }
+    std::filesystem::create_directories(result.directory);
+    std::filesystem::remove(summary);
+
+    std::string command = "cd " + ShellQuote(result.directory) + " && " + ShellQuote(m_program);
+    for (const auto& argument : GetArguments(point))
+    {
+        command += " " + ShellQuote(argument);
+    }
+    command += std::string(" --summaryFile=") + SUMMARY_FILE;
+    command += " > stdout.log 2> stderr.log";
+
+    auto start = std::chrono::steady_clock::now();
+    int status = std::system(command.c_str());
+    result.wallSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.exitCode = (status != -1 && WIFEXITED(status)) ? WEXITSTATUS(status) : -1;
+    result.metrics = ReadSummary(summary.string());
+
+    // Only complete runs are worth reusing; the entry appears at once, by a
+    // rename, so a concurrent sweep never restores half of it
+    auto stopped = result.metrics.find("stoppedEarly");
+    if (!entry.empty() && result.exitCode == 0 && !result.metrics.empty() &&
+        (stopped == result.metrics.end() || stopped->second == 0))
+    {
+        std::ostringstream suffix;
+        suffix << ".tmp-" << std::this_thread::get_id();
+        const std::filesystem::path temporary = entry.string() + suffix.str();
+        std::error_code error;
+        std::filesystem::create_directories(m_cacheDirectory, error);
+        std::filesystem::remove_all(temporary, error);
+        if (CopyTree(result.directory, temporary))
+        {
+            std::ofstream(temporary / CACHE_META_FILE) << result.wallSeconds << '\n';
+            std::filesystem::rename(temporary, entry, error);
+        }
+        std::filesystem::remove_all(temporary, error);
+    }
+    return result;
+}
+
+} // namespace ns3
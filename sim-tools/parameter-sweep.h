@@ -0,0 +1,187 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PARAMETER_SWEEP_H
+#define PARAMETER_SWEEP_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/// One point of a sweep: a value for every swept parameter and an RngRun.
+struct SweepPoint
+{
+    std::vector<std::pair<std::string, std::string>> params; //!< Parameter values, grid order.
+    uint32_t run{1};                                          //!< RngRun of the job.
+};
+
+/// Outcome of one executed sweep point.
+struct SweepResult
+{
+    SweepPoint point;                      //!< The executed point.
+    std::string directory;                 //!< Working directory of the run.
+    int exitCode{-1};                      //!< Exit code of the scenario.
+    double wallSeconds{0};                 //!< Wall-clock duration of the run.
+    bool cached{false};                    //!< Whether it was restored from the result cache.
+    std::map<std::string, double> metrics; //!< Metrics read from the run summary.
+};
+
+/**
+ * Runs a scenario binary over a parameter grid times a range of RngRun seeds.
+ *
+ * Every job runs in its own directory under the output directory, so the
+ * relative output files of the scenarios (pcaps, flowmon, plots) never
+ * clobber each other, and writes its RunSummary there; only the summary of a
+ * previous run is removed first. Jobs are spread over a pool of
+ * worker threads with one queue each; a worker that runs out of jobs steals
+ * from the others, and the expensive jobs are dealt first so a long run does
+ * not start last and leave the other cores idle.
+ *
+ * With a cache directory set, the directory of every successful run is also
+ * stored there under a hash of everything that determines its outcome: the
+ * scenario name, the contents of its binary and of the non-system shared
+ * libraries it loads, its arguments, the contents of the input files they
+ * name (e.g. a mobility trace), RngRun and the NS_GLOBAL_VALUE and
+ * NS_ATTRIBUTE_DEFAULT variables. The defaults of the arguments not given
+ * and the Config::SetDefault calls of the scenario are compiled in, so a
+ * rebuild changes the key. A point whose key is cached is not run again:
+ * its directory is restored from the cache, hard linked when possible, so
+ * a repeated sweep returns at once and a changed grid only runs the new
+ * points. Runs that fail or stop early on their wall-clock budget are not
+ * cached. With a cache the run directories are emptied before every run,
+ * since restored files may be hard links into the cache.
+ *
+ * This is where the cores of a machine are used: a single run stays on one
+ * thread, since the per-cell subframe processing of the LTE module shares the
+ * simulator event queue, the random streams and the trace sinks, and cannot
+ * be split over threads without changing the module itself. To use more cores
+ * for one configuration, sweep more RngRun values instead of a longer run;
+ * ReplicationController picks how many from the variance of the results.
+ */
+class ParameterSweep
+{
+  public:
+    /**
+     * Set the scenario to run.
+     * \param program Path of the scenario binary.
+     */
+    void SetProgram(const std::string& program);
+
+    /**
+     * Set where the per-run directories are created.
+     * \param directory The output directory.
+     */
+    void SetOutputDirectory(const std::string& directory);
+
+    /**
+     * Set the number of jobs that run at the same time.
+     * \param threads Number of workers, 0 for one per core.
+     */
+    void SetThreads(uint32_t threads);
+
+    /**
+     * Set where successful runs are cached.
+     * \param directory The cache directory, empty to always run.
+     */
+    void SetCacheDirectory(const std::string& directory);
+
+    /**
+     * Set the seeds every grid point is run with.
+     * \param first First RngRun.
+     * \param count Number of consecutive RngRun values.
+     */
+    void SetRuns(uint32_t first, uint32_t count);
+
+    /**
+     * Add a swept parameter.
+     * \param name Name of the scenario command line argument.
+     * \param values Values to sweep.
+     */
+    void AddParameter(const std::string& name, const std::vector<std::string>& values);
+
+    /**
+     * Add parameters from a grid description such as
+     * "numNodePairs=2,4,8;simTime=5s,10s".
+     * \param grid The grid description.
+     * \return False if the description is malformed.
+     */
+    bool AddGrid(const std::string& grid);
+
+    /**
+     * Add an argument passed unchanged to every run.
+     * \param argument The argument, e.g. "--useCa=false".
+     */
+    void AddFixedArgument(const std::string& argument);
+
+    /// \return The cartesian product of all parameters and runs.
+    std::vector<SweepPoint> Expand() const;
+
+    /**
+     * Execute points on the worker pool.
+     * \param points The points to run.
+     * \return The results, in the order of the points.
+     */
+    std::vector<SweepResult> Run(const std::vector<SweepPoint>& points) const;
+
+    /**
+     * Write results as one table: one row per run, one column per parameter
+     * and per metric found in any of the run summaries.
+     * \param results The results.
+     * \param fileName The output CSV file.
+     */
+    static void WriteTable(const std::vector<SweepResult>& results, const std::string& fileName);
+
+  private:
+    /// \return The working directory of a point.
+    std::string GetDirectory(const SweepPoint& point) const;
+    /// \return The relative cost of a point, used to start long jobs first.
+    static double EstimateCost(const SweepPoint& point);
+    /// \return The arguments of a point, as passed to the scenario.
+    std::vector<std::string> GetArguments(const SweepPoint& point) const;
+    /// \return The hash of the scenario binary and of the libraries it loads.
+    std::string GetBuildId() const;
+    /**
+     * \param point A point.
+     * \param buildId Hash of the scenario binary.
+     * \return The cache key of the point.
+     */
+    std::string GetCacheKey(const SweepPoint& point, const std::string& buildId) const;
+    /**
+     * Run one point, or restore it from the cache, and collect its summary.
+     * \param point The point.
+     * \param buildId Hash of the scenario binary, unused without a cache.
+     * \return Its result.
+     */
+    SweepResult Execute(const SweepPoint& point, const std::string& buildId) const;
+
+    std::string m_program;                     //!< Scenario binary.
+    std::string m_outputDirectory{"sweep"};    //!< Root of the run directories.
+    uint32_t m_threads{0};                     //!< Number of workers.
+    std::string m_cacheDirectory;              //!< Result cache, empty if disabled.
+    uint32_t m_firstRun{1};                    //!< First RngRun.
+    uint32_t m_runCount{1};                    //!< Number of RngRun values.
+    std::vector<std::string> m_fixedArguments; //!< Arguments of every run.
+    /// Swept parameters and their values.
+    std::vector<std::pair<std::string, std::vector<std::string>>> m_grid;
+};
+
+} // namespace ns3
+
+#endif /* PARAMETER_SWEEP_H */
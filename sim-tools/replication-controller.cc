@@ -0,0 +1,314 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "replication-controller.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ReplicationController");
+
+namespace
+{
+
+/// \return The quantile of the standard normal distribution at p, in (0, 1).
+double
+GetNormalQuantile(double p)
+{
+    // Newton on the cumulative distribution, which is smooth and monotonic
+    double x = 0;
+    for (int i = 0; i < 50; ++i)
+    {
+        const double cdf = 0.5 * std::erfc(-x / std::sqrt(2.0));
+        const double pdf = std::exp(-x * x / 2) / std::sqrt(2 * M_PI);
+        const double step = (cdf - p) / pdf;
+        x -= step;
+        if (std::abs(step) < 1e-12)
+        {
+            break;
+        }
+    }
+    return x;
+}
+
+} // namespace
+
+ReplicationController::ReplicationController(const ParameterSweep& sweep)
+    : m_sweep(sweep)
+{
+}
+
+void
+ReplicationController::AddMetric(const std::string& metric)
+{
+    m_metrics.push_back(metric);
+}
+
+void
+ReplicationController::SetTarget(double relativeHalfWidth, double confidence)
+{
+    NS_ABORT_MSG_IF(relativeHalfWidth <= 0, "The target half-width must be positive");
+    NS_ABORT_MSG_IF(confidence <= 0 || confidence >= 1, "The confidence must be in (0, 1)");
+    m_target = relativeHalfWidth;
+    m_confidence = confidence;
+}
+
+void
+ReplicationController::SetRunLimits(uint32_t minRuns, uint32_t maxRuns)
+{
+    NS_ABORT_MSG_IF(minRuns < 2, "A confidence interval needs at least 2 replicas");
+    m_minRuns = minRuns;
+    m_maxRuns = std::max(minRuns, maxRuns);
+}
+
+double
+ReplicationController::GetStudentQuantile(double confidence, uint32_t dof)
+{
+    NS_ABORT_MSG_IF(dof == 0, "The Student t distribution needs a degree of freedom");
+    const double p = (1 + confidence) / 2;
+    if (dof == 1)
+    {
+        return std::tan(M_PI * (p - 0.5));
+    }
+    if (dof == 2)
+    {
+        return (2 * p - 1) / std::sqrt(2 * p * (1 - p));
+    }
+    // Cornish-Fisher expansion around the normal quantile
+    const double z = GetNormalQuantile(p);
+    const double n = dof;
+    const double z2 = z * z;
+    const double g1 = z * (z2 + 1) / 4;
+    const double g2 = z * ((5 * z2 + 16) * z2 + 3) / 96;
+    const double g3 = z * (((3 * z2 + 19) * z2 + 17) * z2 - 15) / 384;
+    const double g4 = z * ((((79 * z2 + 776) * z2 + 1482) * z2 - 1920) * z2 - 945) / 92160;
+    return z + g1 / n + g2 / (n * n) + g3 / (n * n * n) + g4 / (n * n * n * n);
+}
+
+ReplicationEstimate
+ReplicationController::Estimate(const GridPoint& point, const std::string& metric) const
+{
+    // Welford, so a metric in the millions keeps its small variance
+    ReplicationEstimate estimate;
+    double m2 = 0;
+    for (const auto& result : point.results)
+    {
+        auto it = result.metrics.find(metric);
+        if (result.exitCode != 0 || it == result.metrics.end() || std::isnan(it->second))
+        {
+            continue;
+        }
+        ++estimate.samples;
+        const double delta = it->second - estimate.mean;
+        estimate.mean += delta / estimate.samples;
+        m2 += delta * (it->second - estimate.mean);
+    }
+    if (estimate.samples >= 2)
+    {
+        const double stdDev = std::sqrt(m2 / (estimate.samples - 1));
+        estimate.halfWidth = GetStudentQuantile(m_confidence, estimate.samples - 1) * stdDev /
+                             std::sqrt(estimate.samples);
+    }
+    return estimate;
+}
+
+uint32_t
+ReplicationController::GetNeededRuns(const GridPoint& point) const
+{
+    uint32_t needed = m_minRuns;
+    for (const auto& metric : m_metrics)
+    {
+        const ReplicationEstimate estimate = Estimate(point, metric);
+        if (estimate.mean == 0)
+        {
+            return m_maxRuns;
+        }
+        if (estimate.halfWidth <= m_target * std::abs(estimate.mean))
+        {
+            continue;
+        }
+        // The half-width shrinks as 1 / sqrt(n) for the same variance; scale
+        // the replicas that gave samples by the runs that did not
+        const double ratio = estimate.halfWidth / (m_target * std::abs(estimate.mean));
+        const double samples = std::ceil(estimate.samples * ratio * ratio);
+        const double runs = samples * point.results.size() / estimate.samples;
+        needed = std::max<double>(needed, std::min<double>(runs, m_maxRuns));
+    }
+    return needed;
+}
+
+std::vector<SweepResult>
+ReplicationController::Run()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ABORT_MSG_IF(m_metrics.empty(), "No metric to estimate");
+
+    // One grid point per parameter set, starting at its smallest RngRun
+    m_points.clear();
+    std::map<std::vector<std::pair<std::string, std::string>>, std::size_t> index;
+    for (const auto& point : m_sweep.Expand())
+    {
+        auto [it, inserted] = index.emplace(point.params, m_points.size());
+        if (inserted)
+        {
+            m_points.push_back({point, {}, false, false, false});
+        }
+        else
+        {
+            SweepPoint& first = m_points[it->second].point;
+            first.run = std::min(first.run, point.run);
+        }
+    }
+
+    for (uint32_t round = 1;; ++round)
+    {
+        std::vector<SweepPoint> jobs;
+        std::vector<std::size_t> owners;
+        for (std::size_t i = 0; i < m_points.size(); ++i)
+        {
+            GridPoint& point = m_points[i];
+            if (point.done)
+            {
+                continue;
+            }
+            const uint32_t runs = point.results.size();
+            uint32_t needed = runs < m_minRuns ? m_minRuns : GetNeededRuns(point);
+            // At most double per round: the first estimates are noisy
+            needed = std::min({needed, std::max(m_minRuns, 2 * runs), m_maxRuns});
+            for (uint32_t k = runs; k < std::max(needed, runs + 1); ++k)
+            {
+                SweepPoint job = point.point;
+                job.run = point.point.run + k;
+                jobs.push_back(job);
+                owners.push_back(i);
+            }
+        }
+        if (jobs.empty())
+        {
+            break;
+        }
+        std::cout << "Round " << round << ": " << jobs.size() << " replicas" << std::endl;
+
+        std::vector<SweepResult> results = m_sweep.Run(jobs);
+        for (std::size_t j = 0; j < results.size(); ++j)
+        {
+            m_points[owners[j]].results.push_back(std::move(results[j]));
+        }
+        for (auto& point : m_points)
+        {
+            if (point.done)
+            {
+                continue;
+            }
+            std::sort(point.results.begin(),
+                      point.results.end(),
+                      [](const SweepResult& a, const SweepResult& b) {
+                          return a.point.run < b.point.run;
+                      });
+            if (point.results.size() < m_minRuns)
+            {
+                continue;
+            }
+            // Without two samples there is no interval to narrow; the runs
+            // crash or do not report the metric, and more would not change that
+            point.failed =
+                std::any_of(m_metrics.begin(), m_metrics.end(), [&](const std::string& metric) {
+                    return Estimate(point, metric).samples < 2;
+                });
+            if (point.failed)
+            {
+                std::ostringstream params;
+                for (const auto& param : point.point.params)
+                {
+                    params << ' ' << param.first << '=' << param.second;
+                }
+                std::cout << "No estimate after " << point.results.size()
+                          << " replicas of" << params.str() << ", giving up" << std::endl;
+                point.done = true;
+                continue;
+            }
+            point.converged =
+                std::all_of(m_metrics.begin(), m_metrics.end(), [&](const std::string& metric) {
+                    const ReplicationEstimate estimate = Estimate(point, metric);
+                    return estimate.mean != 0 &&
+                           estimate.halfWidth <= m_target * std::abs(estimate.mean);
+                });
+            point.done = point.converged || point.results.size() >= m_maxRuns;
+        }
+    }
+
+    std::vector<SweepResult> all;
+    uint32_t converged = 0;
+    uint32_t failed = 0;
+    for (const auto& point : m_points)
+    {
+        all.insert(all.end(), point.results.begin(), point.results.end());
+        converged += point.converged ? 1 : 0;
+        failed += point.failed ? 1 : 0;
+    }
+    std::cout << converged << " of " << m_points.size() << " points converged, " << failed
+              << " failed, in " << all.size() << " replicas" << std::endl;
+    return all;
+}
+
+void
+ReplicationController::WriteEstimates(const std::string& fileName) const
+{
+    NS_LOG_FUNCTION(this << fileName);
+    std::ofstream os(fileName, std::ios::out | std::ios::trunc);
+    NS_ABORT_MSG_IF(!os.is_open(), "Unable to open " << fileName);
+
+    if (!m_points.empty())
+    {
+        for (const auto& param : m_points.front().point.params)
+        {
+            os << param.first << ',';
+        }
+    }
+    os << "runs,converged,failed";
+    for (const auto& metric : m_metrics)
+    {
+        os << ',' << metric << ',' << metric << "HalfWidth";
+    }
+    os << '\n';
+
+    for (const auto& point : m_points)
+    {
+        for (const auto& param : point.point.params)
+        {
+            os << param.second << ',';
+        }
+        os << point.results.size() << ',' << point.converged << ',' << point.failed;
+        for (const auto& metric : m_metrics)
+        {
+            const ReplicationEstimate estimate = Estimate(point, metric);
+            os << ',' << estimate.mean << ',' << estimate.halfWidth;
+        }
+        os << '\n';
+    }
+}
+
+} // namespace ns3
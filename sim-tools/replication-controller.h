@@ -0,0 +1,146 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef REPLICATION_CONTROLLER_H
+#define REPLICATION_CONTROLLER_H
+
+#include "parameter-sweep.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/// Mean of a metric over the replicas of a grid point and its confidence interval.
+struct ReplicationEstimate
+{
+    uint32_t samples{0}; //!< Replicas in which the metric is defined.
+    double mean{0};      //!< Sample mean.
+    double halfWidth{0}; //!< Half-width of the confidence interval of the mean.
+};
+
+/**
+ * Runs every grid point of a ParameterSweep over as many RngRun replicas as
+ * its metrics need, instead of a fixed number.
+ *
+ * Each grid point starts with MinRuns replicas. After every round, the
+ * Student t confidence interval of the mean of each chosen metric is
+ * computed, and a point is done once the half-width of every one is within
+ * the target fraction of its mean. Otherwise, it gets the replicas the
+ * current variance says it is missing, at most as many as it already has
+ * so a noisy early estimate cannot overshoot, and never more than MaxRuns
+ * in total. The replicas of all open points in a round run together on
+ * the sweep's worker pool, so the cores go to the high-variance points
+ * once the easy ones stop.
+ *
+ * Replica k of a point runs with RngRun first + k, where first is the
+ * smallest RngRun the sweep would use. A longer sequence therefore extends
+ * a shorter one, and with a cache directory an interrupted or repeated
+ * controller run only executes the replicas it has not seen. A metric
+ * missing or NaN in a run summary, or a failed run, counts as a replica
+ * without a sample. A point that still has fewer than two samples of some
+ * metric after MinRuns replicas is marked failed and not run further, since
+ * more replicas of a crashing scenario or a misspelled metric would not
+ * help. A metric whose mean is zero never meets a relative target, so its
+ * point runs to MaxRuns.
+ */
+class ReplicationController
+{
+  public:
+    /// \param sweep The program, grid and execution settings; its run count is ignored.
+    explicit ReplicationController(const ParameterSweep& sweep);
+
+    /**
+     * Add a run summary metric whose mean must reach the target precision.
+     * \param metric The metric, e.g. meanDelayMs or throughputKbps.
+     */
+    void AddMetric(const std::string& metric);
+
+    /**
+     * \param relativeHalfWidth Target half-width of the confidence interval,
+     *        as a fraction of the mean.
+     * \param confidence Confidence level of the interval, in (0, 1).
+     */
+    void SetTarget(double relativeHalfWidth, double confidence);
+
+    /**
+     * \param minRuns Replicas of every point before the first check, at least 2.
+     * \param maxRuns Replicas after which a point stops whatever its precision.
+     */
+    void SetRunLimits(uint32_t minRuns, uint32_t maxRuns);
+
+    /**
+     * Run the replicas of every grid point until it converges, fails or
+     * reaches MaxRuns.
+     * \return The results of all replicas, by grid point then RngRun.
+     */
+    std::vector<SweepResult> Run();
+
+    /**
+     * Write one row per grid point: its parameters, replicas, whether it
+     * converged or failed, and the mean and half-width of every metric.
+     * \param fileName The CSV file.
+     */
+    void WriteEstimates(const std::string& fileName) const;
+
+    /**
+     * \param confidence Two-sided confidence level, in (0, 1).
+     * \param dof Degrees of freedom, at least 1.
+     * \return The Student t quantile of the interval; exact for 1 and 2
+     *         degrees of freedom, within 1% from 3 on.
+     */
+    static double GetStudentQuantile(double confidence, uint32_t dof);
+
+  private:
+    /// A grid point and its replicas so far.
+    struct GridPoint
+    {
+        SweepPoint point;                 //!< Parameters, with the first RngRun.
+        std::vector<SweepResult> results; //!< Replicas, by RngRun.
+        bool done{false};                 //!< Converged, failed or at MaxRuns.
+        bool converged{false};            //!< Every metric reached the target.
+        bool failed{false};               //!< A metric lacked samples after MinRuns.
+    };
+
+    /**
+     * \param point A grid point.
+     * \param metric One of the metrics.
+     * \return Its mean and confidence interval over the replicas so far.
+     */
+    ReplicationEstimate Estimate(const GridPoint& point, const std::string& metric) const;
+
+    /**
+     * \param point A grid point with at least MinRuns replicas and two
+     *        samples of every metric.
+     * \return How many replicas it needs in total, from its current
+     *         estimates; MaxRuns if some metric has a zero mean.
+     */
+    uint32_t GetNeededRuns(const GridPoint& point) const;
+
+    const ParameterSweep& m_sweep;      //!< Execution of the replicas.
+    std::vector<std::string> m_metrics; //!< Metrics checked for precision.
+    double m_target{0.05};              //!< Target relative half-width.
+    double m_confidence{0.95};          //!< Confidence level.
+    uint32_t m_minRuns{3};              //!< Replicas before the first check.
+    uint32_t m_maxRuns{30};             //!< Replicas at most.
+    std::vector<GridPoint> m_points;    //!< Grid points of the last Run.
+};
+
+} // namespace ns3
+
+#endif /* REPLICATION_CONTROLLER_H */
@@ -0,0 +1,116 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "run-summary.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <fstream>
+#include <limits>
+
+#include <sys/resource.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("RunSummary");
+
+void
+RunSummary::Set(const std::string& metric, double value)
+{
+    for (auto& entry : m_metrics)
+    {
+        if (entry.first == metric)
+        {
+            entry.second = value;
+            return;
+        }
+    }
+    m_metrics.emplace_back(metric, value);
+}
+
+void
+RunSummary::AddFlowMonitor(Ptr<FlowMonitor> monitor)
+{
+    NS_LOG_FUNCTION(this << monitor);
+    uint64_t txPackets = 0;
+    uint64_t rxPackets = 0;
+    uint64_t rxBytes = 0;
+    uint64_t lostPackets = 0;
+    Time delaySum;
+    Time jitterSum;
+    uint64_t jitterSamples = 0;
+    Time firstTx = Time::Max();
+    Time lastRx;
+
+    const FlowMonitor::FlowStatsContainer& stats = monitor->GetFlowStats();
+    for (const auto& entry : stats)
+    {
+        const FlowMonitor::FlowStats& flow = entry.second;
+        txPackets += flow.txPackets;
+        rxPackets += flow.rxPackets;
+        rxBytes += flow.rxBytes;
+        lostPackets += flow.lostPackets;
+        delaySum += flow.delaySum;
+        jitterSum += flow.jitterSum;
+        jitterSamples += flow.rxPackets > 1 ? flow.rxPackets - 1 : 0;
+        firstTx = Min(firstTx, flow.timeFirstTxPacket);
+        lastRx = Max(lastRx, flow.timeLastRxPacket);
+    }
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double activeSeconds = (lastRx - firstTx).GetSeconds();
+    Set("flows", stats.size());
+    Set("txPackets", txPackets);
+    Set("rxPackets", rxPackets);
+    Set("rxBytes", rxBytes);
+    Set("lostPackets", lostPackets);
+    Set("lossRatio", txPackets > 0 ? 1.0 - double(rxPackets) / txPackets : nan);
+    Set("throughputKbps", activeSeconds > 0 ? rxBytes * 8.0 / activeSeconds / 1024 : nan);
+    Set("meanDelayMs", rxPackets > 0 ? delaySum.GetSeconds() / rxPackets * 1000 : nan);
+    Set("meanJitterMs", jitterSamples > 0 ? jitterSum.GetSeconds() / jitterSamples * 1000 : nan);
+}
+
+void
+RunSummary::AddRunCost(double wallSeconds)
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const uint64_t events = Simulator::GetEventCount();
+    Set("runWallSeconds", wallSeconds);
+    Set("events", events);
+    Set("eventsPerWallSecond", wallSeconds > 0 ? events / wallSeconds : nan);
+
+    // ru_maxrss is in KiB on Linux
+    struct rusage usage;
+    Set("peakRssKb", getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : nan);
+}
+
+void
+RunSummary::Write(const std::string& fileName) const
+{
+    NS_LOG_FUNCTION(this << fileName);
+    std::ofstream os(fileName, std::ios::out | std::ios::trunc);
+    NS_ABORT_MSG_IF(!os.is_open(), "Unable to open " << fileName);
+    os.precision(std::numeric_limits<double>::max_digits10);
+    os << "metric,value\n";
+    for (const auto& [metric, value] : m_metrics)
+    {
+        os << metric << ',' << value << '\n';
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,70 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RUN_SUMMARY_H
+#define RUN_SUMMARY_H
+
+#include "ns3/flow-monitor.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Scalar results of one simulation run, written as a "metric,value" CSV file.
+ *
+ * This is the file the sweep runner merges into its result table, so every
+ * scenario that takes a summaryFile argument writes one.
+ */
+class RunSummary
+{
+  public:
+    /**
+     * Set a metric, replacing any previous value.
+     * \param metric The metric name.
+     * \param value The value.
+     */
+    void Set(const std::string& metric, double value);
+
+    /**
+     * Add the aggregate statistics of all flows of a monitor: flows, packets,
+     * bytes, loss, throughput [kb/s], mean delay and mean jitter [ms].
+     * \param monitor The flow monitor, after CheckForLostPackets.
+     */
+    void AddFlowMonitor(Ptr<FlowMonitor> monitor);
+
+    /**
+     * Add what the run cost: wall time, executed events, events per wall
+     * second and the peak resident set size of the process [KiB].
+     * \param wallSeconds The wall time of Simulator::Run.
+     */
+    void AddRunCost(double wallSeconds);
+
+    /**
+     * Write the metrics, in the order they were first set.
+     * \param fileName The output file.
+     */
+    void Write(const std::string& fileName) const;
+
+  private:
+    std::vector<std::pair<std::string, double>> m_metrics; //!< Metrics in insertion order.
+};
+
+} // namespace ns3
+
+#endif /* RUN_SUMMARY_H */
@@ -0,0 +1,243 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "simulation-progress.h"
+
+#include "ns3/boolean.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <csignal>
+#include <iomanip>
+#include <iostream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SimulationProgress");
+
+NS_OBJECT_ENSURE_REGISTERED(SimulationProgress);
+
+namespace
+{
+
+/// Set by the SIGINT handler, polled by the checks.
+volatile std::sig_atomic_t g_interrupted = 0;
+/// SIGINT handler of the process before Start.
+void (*g_previousHandler)(int) = SIG_DFL;
+
+/// SIGINT handler: ask for a clean stop, and let a second SIGINT kill the process.
+void
+HandleInterrupt(int)
+{
+    g_interrupted = 1;
+    std::signal(SIGINT, SIG_DFL);
+}
+
+/// \return The seconds between two wall-clock times.
+double
+ElapsedSeconds(std::chrono::steady_clock::time_point from,
+               std::chrono::steady_clock::time_point to)
+{
+    return std::chrono::duration<double>(to - from).count();
+}
+
+} // namespace
+
+TypeId
+SimulationProgress::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::SimulationProgress")
+            .SetParent<Object>()
+            .AddConstructor<SimulationProgress>()
+            .AddAttribute("CheckInterval",
+                          "Simulated time between two looks at the wall clock.",
+                          TimeValue(MilliSeconds(10)),
+                          MakeTimeAccessor(&SimulationProgress::m_checkInterval),
+                          MakeTimeChecker(MicroSeconds(1)))
+            .AddAttribute("ReportInterval",
+                          "Wall time between two progress lines (0 prints none).",
+                          TimeValue(Seconds(10)),
+                          MakeTimeAccessor(&SimulationProgress::m_reportInterval),
+                          MakeTimeChecker(Seconds(0)))
+            .AddAttribute("WallClockBudget",
+                          "Wall time after which the run is stopped early (0 for no limit).",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&SimulationProgress::m_budget),
+                          MakeTimeChecker(Seconds(0)))
+            .AddAttribute("HandleInterrupt",
+                          "Stop the run cleanly on the first SIGINT.",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&SimulationProgress::m_handleInterrupt),
+                          MakeBooleanChecker());
+    return tid;
+}
+
+SimulationProgress::SimulationProgress()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+SimulationProgress::~SimulationProgress()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+SimulationProgress::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_checkEvent.Cancel();
+    RestoreInterruptHandler();
+    Object::DoDispose();
+}
+
+void
+SimulationProgress::Start(Time stopTime)
+{
+    NS_LOG_FUNCTION(this << stopTime);
+    m_startTime = Simulator::Now();
+    m_stopTime = stopTime;
+    m_wallStart = std::chrono::steady_clock::now();
+    m_lastReport = m_wallStart;
+    m_lastEvents = Simulator::GetEventCount();
+    m_stopReason = NOT_STOPPED;
+    m_finished = false;
+    if (m_handleInterrupt && !m_interruptHandlerInstalled)
+    {
+        g_interrupted = 0;
+        g_previousHandler = std::signal(SIGINT, &HandleInterrupt);
+        m_interruptHandlerInstalled = true;
+    }
+    m_checkEvent = Simulator::Schedule(m_checkInterval, &SimulationProgress::Check, this);
+}
+
+void
+SimulationProgress::Finish()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_finished)
+    {
+        return;
+    }
+    m_checkEvent.Cancel();
+    RestoreInterruptHandler();
+    m_wallEnd = std::chrono::steady_clock::now();
+    m_finished = true;
+    if (m_reportInterval.IsStrictlyPositive() || m_stopReason != NOT_STOPPED)
+    {
+        Report();
+    }
+}
+
+void
+SimulationProgress::RestoreInterruptHandler()
+{
+    if (m_interruptHandlerInstalled)
+    {
+        std::signal(SIGINT, g_previousHandler);
+        m_interruptHandlerInstalled = false;
+    }
+}
+
+SimulationProgress::StopReason
+SimulationProgress::GetStopReason() const
+{
+    return m_stopReason;
+}
+
+double
+SimulationProgress::GetWallSeconds() const
+{
+    const auto end = m_finished ? m_wallEnd : std::chrono::steady_clock::now();
+    return ElapsedSeconds(m_wallStart, end);
+}
+
+void
+SimulationProgress::Check()
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (g_interrupted)
+    {
+        StopEarly(INTERRUPT);
+        return;
+    }
+    if (m_budget.IsStrictlyPositive() &&
+        ElapsedSeconds(m_wallStart, now) >= m_budget.GetSeconds())
+    {
+        StopEarly(BUDGET);
+        return;
+    }
+    if (m_reportInterval.IsStrictlyPositive() &&
+        ElapsedSeconds(m_lastReport, now) >= m_reportInterval.GetSeconds())
+    {
+        Report();
+    }
+    m_checkEvent = Simulator::Schedule(m_checkInterval, &SimulationProgress::Check, this);
+}
+
+void
+SimulationProgress::StopEarly(StopReason reason)
+{
+    NS_LOG_FUNCTION(this << reason);
+    m_stopReason = reason;
+    std::clog << "progress: "
+              << (reason == BUDGET ? "wall-clock budget used up" : "interrupted")
+              << ", stopping at " << Simulator::Now().GetSeconds() << " s" << std::endl;
+    Simulator::Stop();
+}
+
+void
+SimulationProgress::Report()
+{
+    const auto now = std::chrono::steady_clock::now();
+    const double wall = ElapsedSeconds(m_wallStart, m_finished ? m_wallEnd : now);
+    const double window = ElapsedSeconds(m_lastReport, now);
+    const uint64_t events = Simulator::GetEventCount();
+    const double simulated = (Simulator::Now() - m_startTime).GetSeconds();
+    const double total = (m_stopTime - m_startTime).GetSeconds();
+
+    std::clog << std::fixed << std::setprecision(1) << "progress: "
+              << Simulator::Now().GetSeconds() << " s of " << m_stopTime.GetSeconds()
+              << " s simulated";
+    if (total > 0)
+    {
+        std::clog << " (" << 100 * simulated / total << "%)";
+    }
+    std::clog << ", " << wall << " s wall";
+    if (window > 0)
+    {
+        std::clog << ", " << std::setprecision(0) << (events - m_lastEvents) / window
+                  << " events/s" << std::setprecision(1);
+    }
+    if (!m_finished && simulated > 0 && total > simulated)
+    {
+        std::clog << ", ETA " << wall * (total - simulated) / simulated << " s";
+    }
+    std::clog << std::defaultfloat << std::endl;
+    m_lastReport = now;
+    m_lastEvents = events;
+}
+
+void
+SimulationProgress::AddToSummary(RunSummary& summary) const
+{
+    summary.AddRunCost(GetWallSeconds());
+    summary.Set("stoppedEarly", m_stopReason != NOT_STOPPED);
+}
+
+} // namespace ns3
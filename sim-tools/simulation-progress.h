@@ -0,0 +1,118 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef SIMULATION_PROGRESS_H
+#define SIMULATION_PROGRESS_H
+
+#include "run-summary.h"
+
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+
+#include <chrono>
+#include <cstdint>
+
+namespace ns3
+{
+
+/**
+ * Progress reporter and wall-clock guard of a simulation run.
+ *
+ * Every CheckInterval of simulated time the reporter looks at the wall clock.
+ * Every ReportInterval of wall time it prints the simulated time, the wall
+ * time, the events per wall second since the previous report and an ETA
+ * extrapolated from the average speed so far. When the WallClockBudget is
+ * used up, or on the first SIGINT if HandleInterrupt is set, it calls
+ * Simulator::Stop, so Simulator::Run returns and the end-of-run statistics of
+ * the scenario cover the simulated time reached; a second SIGINT kills the
+ * process as usual.
+ */
+class SimulationProgress : public Object
+{
+  public:
+    /// Why the run ended.
+    enum StopReason
+    {
+        NOT_STOPPED, //!< The run ended at its stop time or is still running.
+        BUDGET,      //!< The wall-clock budget was used up.
+        INTERRUPT    //!< SIGINT was received.
+    };
+
+    SimulationProgress();
+    ~SimulationProgress() override;
+
+    /**
+     * Register this type.
+     * \return The TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * Start watching the run. Call just before Simulator::Run.
+     * \param stopTime Simulated time at which the run is stopped, for the ETA.
+     */
+    void Start(Time stopTime);
+
+    /**
+     * Stop watching, restore the SIGINT handler and print the final report.
+     * Call as soon as Simulator::Run returns.
+     */
+    void Finish();
+
+    /// \return Why the run ended.
+    StopReason GetStopReason() const;
+
+    /// \return The wall time from Start to Finish, or to now before Finish [s].
+    double GetWallSeconds() const;
+
+    /**
+     * Add the run cost and whether the run was stopped early to a run summary.
+     * \param summary The run summary.
+     */
+    void AddToSummary(RunSummary& summary) const;
+
+  private:
+    void DoDispose() override;
+
+    /// Check the wall clock and the interrupt flag, and schedule the next check.
+    void Check();
+    /// Print a progress line.
+    void Report();
+    /// Stop the run early.
+    void StopEarly(StopReason reason);
+    /// Restore the SIGINT handler of the process.
+    void RestoreInterruptHandler();
+
+    Time m_checkInterval;                               //!< Simulated time between checks.
+    Time m_reportInterval;                              //!< Wall time between reports.
+    Time m_budget;                                      //!< Wall-clock budget, zero for none.
+    bool m_handleInterrupt;                             //!< Whether SIGINT stops the run.
+    Time m_startTime;                                   //!< Simulated time at Start.
+    Time m_stopTime;                                    //!< Planned end of the run.
+    std::chrono::steady_clock::time_point m_wallStart;  //!< Wall time at Start.
+    std::chrono::steady_clock::time_point m_lastReport; //!< Wall time of the last report.
+    std::chrono::steady_clock::time_point m_wallEnd;    //!< Wall time at Finish.
+    bool m_finished{false};                             //!< Whether Finish was called.
+    uint64_t m_lastEvents{0};                           //!< Event count at the last report.
+    StopReason m_stopReason{NOT_STOPPED};               //!< Why the run ended.
+    bool m_interruptHandlerInstalled{false};            //!< Whether SIGINT is caught.
+    EventId m_checkEvent;                               //!< Next check.
+};
+
+} // namespace ns3
+
+#endif /* SIMULATION_PROGRESS_H */
@@ -0,0 +1,278 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "spatial-attach-helper.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/lte-enb-net-device.h"
+#include "ns3/lte-enb-phy.h"
+#include "ns3/mobility-model.h"
+#include "ns3/node.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SpatialAttachHelper");
+
+CellGridIndex::CellGridIndex(const std::vector<Vector>& positions)
+    : m_positions(positions)
+{
+    NS_ABORT_MSG_IF(positions.empty(), "Cannot index an empty set of positions");
+
+    double maxX = positions.front().x;
+    double maxY = positions.front().y;
+    m_minX = maxX;
+    m_minY = maxY;
+    for (const auto& p : positions)
+    {
+        m_minX = std::min(m_minX, p.x);
+        m_minY = std::min(m_minY, p.y);
+        maxX = std::max(maxX, p.x);
+        maxY = std::max(maxY, p.y);
+    }
+
+    // About one point per cell; degenerate (linear) layouts are split along
+    // their long side only
+    const double width = maxX - m_minX;
+    const double height = maxY - m_minY;
+    const double n = positions.size();
+    if (width > 0 && height > 0)
+    {
+        m_cellSize = std::sqrt(width * height / n);
+    }
+    else if (width > 0 || height > 0)
+    {
+        m_cellSize = std::max(width, height) / n;
+    }
+    m_columns = static_cast<int32_t>(width / m_cellSize) + 1;
+    m_rows = static_cast<int32_t>(height / m_cellSize) + 1;
+
+    // Counting sort of the points by cell
+    const std::size_t cells = static_cast<std::size_t>(m_columns) * m_rows;
+    m_cellStart.assign(cells + 1, 0);
+    std::vector<std::size_t> cellOf(positions.size());
+    for (std::size_t i = 0; i < positions.size(); ++i)
+    {
+        cellOf[i] = static_cast<std::size_t>(Row(positions[i].y)) * m_columns +
+                    Column(positions[i].x);
+        ++m_cellStart[cellOf[i] + 1];
+    }
+    for (std::size_t c = 0; c < cells; ++c)
+    {
+        m_cellStart[c + 1] += m_cellStart[c];
+    }
+    m_cellPoints.resize(positions.size());
+    std::vector<uint32_t> fill(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (std::size_t i = 0; i < positions.size(); ++i)
+    {
+        m_cellPoints[fill[cellOf[i]]++] = i;
+    }
+}
+
+int32_t
+CellGridIndex::Column(double x) const
+{
+    auto c = static_cast<int32_t>(std::floor((x - m_minX) / m_cellSize));
+    return std::clamp(c, 0, m_columns - 1);
+}
+
+int32_t
+CellGridIndex::Row(double y) const
+{
+    auto r = static_cast<int32_t>(std::floor((y - m_minY) / m_cellSize));
+    return std::clamp(r, 0, m_rows - 1);
+}
+
+template <typename F>
+void
+CellGridIndex::ForEachInCell(int32_t column, int32_t row, F f) const
+{
+    if (column < 0 || row < 0 || column >= m_columns || row >= m_rows)
+    {
+        return;
+    }
+    const std::size_t cell = static_cast<std::size_t>(row) * m_columns + column;
+    for (uint32_t k = m_cellStart[cell]; k < m_cellStart[cell + 1]; ++k)
+    {
+        f(m_cellPoints[k]);
+    }
+}
+
+uint32_t
+CellGridIndex::FindNearest(const Vector& position) const
+{
+    const int32_t c0 = Column(position.x);
+    const int32_t r0 = Row(position.y);
+    const int32_t maxRing = std::max(m_columns, m_rows);
+
+    uint32_t best = 0;
+    double bestDistance = std::numeric_limits<double>::infinity();
+    auto visit = [&](uint32_t i) {
+        double d = CalculateDistance(position, m_positions[i]);
+        if (d < bestDistance)
+        {
+            bestDistance = d;
+            best = i;
+        }
+    };
+
+    for (int32_t ring = 0; ring <= maxRing; ++ring)
+    {
+        if (ring == 0)
+        {
+            ForEachInCell(c0, r0, visit);
+        }
+        else
+        {
+            for (int32_t dc = -ring; dc <= ring; ++dc)
+            {
+                ForEachInCell(c0 + dc, r0 - ring, visit);
+                ForEachInCell(c0 + dc, r0 + ring, visit);
+            }
+            for (int32_t dr = -ring + 1; dr <= ring - 1; ++dr)
+            {
+                ForEachInCell(c0 - ring, r0 + dr, visit);
+                ForEachInCell(c0 + ring, r0 + dr, visit);
+            }
+        }
+        // Every point in the rings not visited yet is at least this far away
+        if (bestDistance <= ring * m_cellSize)
+        {
+            break;
+        }
+    }
+    return best;
+}
+
+std::vector<uint32_t>
+CellGridIndex::FindWithin(const Vector& position, double radius) const
+{
+    std::vector<uint32_t> found;
+    const int32_t c0 = Column(position.x);
+    const int32_t r0 = Row(position.y);
+    const int32_t reach = static_cast<int32_t>(std::ceil(radius / m_cellSize)) + 1;
+    for (int32_t r = r0 - reach; r <= r0 + reach; ++r)
+    {
+        for (int32_t c = c0 - reach; c <= c0 + reach; ++c)
+        {
+            ForEachInCell(c, r, [&](uint32_t i) {
+                if (CalculateDistance(position, m_positions[i]) <= radius)
+                {
+                    found.push_back(i);
+                }
+            });
+        }
+    }
+    return found;
+}
+
+SpatialAttachHelper::Mode
+SpatialAttachHelper::ModeFromString(const std::string& name)
+{
+    if (name == "nearest")
+    {
+        return NEAREST;
+    }
+    NS_ABORT_MSG_IF(name != "strongest", "Unknown attach mode \"" << name << "\"");
+    return STRONGEST;
+}
+
+void
+SpatialAttachHelper::SetMode(Mode mode)
+{
+    m_mode = mode;
+}
+
+void
+SpatialAttachHelper::SetPathlossModel(Ptr<PropagationLossModel> model)
+{
+    m_pathloss = model;
+}
+
+void
+SpatialAttachHelper::SetSearchRadiusFactor(double factor)
+{
+    NS_ABORT_MSG_IF(factor < 1, "The search radius factor must be at least 1");
+    m_searchRadiusFactor = factor;
+}
+
+void
+SpatialAttachHelper::Attach(Ptr<LteHelper> lteHelper,
+                            NetDeviceContainer ueDevices,
+                            NetDeviceContainer enbDevices) const
+{
+    NS_LOG_FUNCTION(this << lteHelper << ueDevices.GetN() << enbDevices.GetN());
+
+    std::vector<Vector> enbPositions;
+    std::vector<Ptr<MobilityModel>> enbMobility;
+    std::vector<double> enbTxPower;
+    enbPositions.reserve(enbDevices.GetN());
+    for (uint32_t i = 0; i < enbDevices.GetN(); ++i)
+    {
+        Ptr<MobilityModel> mobility = enbDevices.Get(i)->GetNode()->GetObject<MobilityModel>();
+        NS_ABORT_MSG_IF(!mobility, "eNB " << i << " has no mobility model");
+        enbPositions.push_back(mobility->GetPosition());
+        enbMobility.push_back(mobility);
+        if (m_mode == STRONGEST)
+        {
+            Ptr<LteEnbNetDevice> enb = DynamicCast<LteEnbNetDevice>(enbDevices.Get(i));
+            NS_ABORT_MSG_IF(!enb, "Device " << i << " is not an LTE eNB");
+            enbTxPower.push_back(enb->GetPhy()->GetTxPower());
+        }
+    }
+    CellGridIndex index(enbPositions);
+
+    Ptr<PropagationLossModel> pathloss = m_pathloss;
+    if (m_mode == STRONGEST && !pathloss)
+    {
+        pathloss = CreateObject<FriisPropagationLossModel>();
+    }
+
+    for (uint32_t u = 0; u < ueDevices.GetN(); ++u)
+    {
+        Ptr<MobilityModel> ueMobility = ueDevices.Get(u)->GetNode()->GetObject<MobilityModel>();
+        NS_ABORT_MSG_IF(!ueMobility, "UE " << u << " has no mobility model");
+        const Vector position = ueMobility->GetPosition();
+        uint32_t chosen = index.FindNearest(position);
+
+        if (m_mode == STRONGEST)
+        {
+            double radius =
+                CalculateDistance(position, enbPositions[chosen]) * m_searchRadiusFactor;
+            double bestRxPower = -std::numeric_limits<double>::infinity();
+            for (uint32_t candidate : index.FindWithin(position, radius))
+            {
+                double rxPower = pathloss->CalcRxPower(enbTxPower[candidate],
+                                                       enbMobility[candidate],
+                                                       ueMobility);
+                if (rxPower > bestRxPower)
+                {
+                    bestRxPower = rxPower;
+                    chosen = candidate;
+                }
+            }
+        }
+
+        NS_LOG_LOGIC("UE " << u << " at " << position << " attaches to eNB " << chosen);
+        lteHelper->Attach(ueDevices.Get(u), enbDevices.Get(chosen));
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,141 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SPATIAL_ATTACH_HELPER_H
+#define SPATIAL_ATTACH_HELPER_H
+
+#include "ns3/lte-helper.h"
+#include "ns3/net-device-container.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/vector.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Uniform grid over a set of points in the XY plane.
+ *
+ * The grid has about one point per cell, so a nearest neighbour query only
+ * visits the few rings of cells around the query position instead of all the
+ * points.
+ */
+class CellGridIndex
+{
+  public:
+    /**
+     * Build the index.
+     * \param positions The indexed points.
+     */
+    explicit CellGridIndex(const std::vector<Vector>& positions);
+
+    /**
+     * \param position The query position.
+     * \return The index of the point nearest to position.
+     */
+    uint32_t FindNearest(const Vector& position) const;
+
+    /**
+     * \param position The query position.
+     * \param radius The search radius.
+     * \return The indexes of all points within radius of position.
+     */
+    std::vector<uint32_t> FindWithin(const Vector& position, double radius) const;
+
+  private:
+    /// \return The column of x, clamped to the grid.
+    int32_t Column(double x) const;
+    /// \return The row of y, clamped to the grid.
+    int32_t Row(double y) const;
+    /// Call f for every point stored in cell (column, row).
+    template <typename F>
+    void ForEachInCell(int32_t column, int32_t row, F f) const;
+
+    std::vector<Vector> m_positions;    //!< The indexed points.
+    double m_minX{0};                   //!< Left edge of the grid.
+    double m_minY{0};                   //!< Bottom edge of the grid.
+    double m_cellSize{1};               //!< Side of a cell.
+    int32_t m_columns{1};               //!< Number of columns.
+    int32_t m_rows{1};                  //!< Number of rows.
+    std::vector<uint32_t> m_cellStart;  //!< First entry of each cell in m_cellPoints.
+    std::vector<uint32_t> m_cellPoints; //!< Point indexes, grouped by cell.
+};
+
+/**
+ * Attaches UEs to a cell chosen through a CellGridIndex of the eNB positions,
+ * as a fast replacement for the idle mode cell search of LteHelper::Attach
+ * (NetDeviceContainer) in deployments with many eNBs and UEs.
+ *
+ * STRONGEST ranks the candidates by the transmit power of each eNB minus the
+ * pathloss of the ranking model. With eNBs of equal power and a model that
+ * only grows with distance, such as the default Friis, it picks the same
+ * cells as NEAREST at a higher cost; it differs with unequal powers or
+ * with a model that accounts for buildings or shadowing.
+ */
+class SpatialAttachHelper
+{
+  public:
+    /// How the serving cell is chosen.
+    enum Mode
+    {
+        NEAREST,  //!< The geometrically nearest eNB.
+        STRONGEST //!< The highest received power among the eNBs near the nearest one.
+    };
+
+    /**
+     * \param name "nearest" or "strongest".
+     * \return The mode; unknown names abort.
+     */
+    static Mode ModeFromString(const std::string& name);
+
+    /// \param mode How the serving cell is chosen.
+    void SetMode(Mode mode);
+
+    /**
+     * Set the model used to rank candidates in STRONGEST mode, normally the
+     * downlink pathloss model of the scenario. Defaults to Friis.
+     * \param model The propagation loss model.
+     */
+    void SetPathlossModel(Ptr<PropagationLossModel> model);
+
+    /**
+     * Set how far beyond the nearest eNB candidates are considered in
+     * STRONGEST mode, as a multiple of the distance to the nearest eNB.
+     * \param factor The search radius factor, at least 1.
+     */
+    void SetSearchRadiusFactor(double factor);
+
+    /**
+     * Attach every UE to its chosen eNB; the default EPS bearer is activated
+     * as with LteHelper::Attach.
+     * \param lteHelper The LTE helper of the scenario.
+     * \param ueDevices The UE devices.
+     * \param enbDevices The candidate eNB devices.
+     */
+    void Attach(Ptr<LteHelper> lteHelper,
+                NetDeviceContainer ueDevices,
+                NetDeviceContainer enbDevices) const;
+
+  private:
+    Mode m_mode{NEAREST};                 //!< Selection mode.
+    Ptr<PropagationLossModel> m_pathloss; //!< Ranking model of STRONGEST.
+    double m_searchRadiusFactor{2};       //!< Candidate radius of STRONGEST.
+};
+
+} // namespace ns3
+
+#endif /* SPATIAL_ATTACH_HELPER_H */
@@ -0,0 +1,96 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "staggered-install-helper.h"
+
+#include "ns3/abort.h"
+#include "ns3/application.h"
+#include "ns3/log.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("StaggeredInstallHelper");
+
+StaggeredInstallHelper::StaggeredInstallHelper()
+    : m_uniform(CreateObject<UniformRandomVariable>()),
+      m_arrival(CreateObject<ExponentialRandomVariable>())
+{
+}
+
+StaggeredInstallHelper::Pattern
+StaggeredInstallHelper::PatternFromString(const std::string& name)
+{
+    if (name == "simultaneous")
+    {
+        return SIMULTANEOUS;
+    }
+    if (name == "uniform")
+    {
+        return UNIFORM;
+    }
+    NS_ABORT_MSG_IF(name != "poisson", "Unknown start pattern \"" << name << "\"");
+    return POISSON;
+}
+
+void
+StaggeredInstallHelper::SetStartPattern(Pattern pattern, Time start, Time spread)
+{
+    NS_ABORT_MSG_IF(start.IsNegative() || spread.IsNegative(), "Negative start pattern");
+    m_pattern = pattern;
+    m_start = start;
+    m_spread = spread;
+}
+
+int64_t
+StaggeredInstallHelper::AssignStreams(int64_t stream)
+{
+    m_uniform->SetStream(stream);
+    m_arrival->SetStream(stream + 1);
+    return 2;
+}
+
+void
+StaggeredInstallHelper::SetStartTimes(ApplicationContainer apps) const
+{
+    NS_LOG_FUNCTION(this << apps.GetN());
+    if (apps.GetN() == 0)
+    {
+        return;
+    }
+
+    // Poisson arrivals of the population in m_spread on average
+    const double meanGap = m_spread.GetSeconds() / apps.GetN();
+    Time next = m_start;
+    for (uint32_t i = 0; i < apps.GetN(); ++i)
+    {
+        Time start = m_start;
+        switch (m_pattern)
+        {
+        case SIMULTANEOUS:
+            break;
+        case UNIFORM:
+            start += Seconds(m_uniform->GetValue(0, m_spread.GetSeconds()));
+            break;
+        case POISSON:
+            start = next;
+            next += Seconds(m_arrival->GetValue(meanGap, 0));
+            break;
+        }
+        apps.Get(i)->SetStartTime(start);
+    }
+}
+
+} // namespace ns3
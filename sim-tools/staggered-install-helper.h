@@ -0,0 +1,106 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef STAGGERED_INSTALL_HELPER_H
+#define STAGGERED_INSTALL_HELPER_H
+
+#include "ns3/application-container.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * Installs an application on a whole population of nodes and spreads their
+ * start times, so that the connection setups (TCP handshakes, RRC connection
+ * requests) of thousands of clients do not all fall in the same tick.
+ *
+ * The start times come from a dedicated random stream, so a run is
+ * reproducible for a given seed, run number and stream.
+ */
+class StaggeredInstallHelper
+{
+  public:
+    /// How the start times are spread.
+    enum Pattern
+    {
+        SIMULTANEOUS, //!< Every application starts at the start time.
+        UNIFORM,      //!< Uniformly distributed in [start, start + spread).
+        POISSON       //!< Poisson arrivals from the start time, spread / N apart on average.
+    };
+
+    StaggeredInstallHelper();
+
+    /**
+     * \param name simultaneous, uniform or poisson.
+     * \return The pattern; unknown names abort.
+     */
+    static Pattern PatternFromString(const std::string& name);
+
+    /**
+     * \param pattern How the start times are spread.
+     * \param start The earliest start time.
+     * \param spread The window of UNIFORM; the mean duration of the POISSON
+     *        arrivals of the whole population.
+     */
+    void SetStartPattern(Pattern pattern, Time start, Time spread);
+
+    /**
+     * Fix the random stream of the start times.
+     * \param stream The first stream index to use.
+     * \return The number of streams used.
+     */
+    int64_t AssignStreams(int64_t stream);
+
+    /**
+     * Install an application on every node with a helper, in one call, and
+     * spread the start times of the result.
+     * \param helper Any application helper with Install(NodeContainer).
+     * \param nodes The population.
+     * \return The applications, in node order.
+     */
+    template <typename Helper>
+    ApplicationContainer Install(const Helper& helper, NodeContainer nodes) const;
+
+    /**
+     * Spread the start times of applications that are already installed.
+     * \param apps The applications.
+     */
+    void SetStartTimes(ApplicationContainer apps) const;
+
+  private:
+    Pattern m_pattern{SIMULTANEOUS};          //!< Start time pattern.
+    Time m_start;                             //!< Earliest start time.
+    Time m_spread;                            //!< Window of the start times.
+    Ptr<UniformRandomVariable> m_uniform;     //!< Start times of UNIFORM.
+    Ptr<ExponentialRandomVariable> m_arrival; //!< Inter-arrival times of POISSON.
+};
+
+template <typename Helper>
+ApplicationContainer
+StaggeredInstallHelper::Install(const Helper& helper, NodeContainer nodes) const
+{
+    ApplicationContainer apps = helper.Install(nodes);
+    SetStartTimes(apps);
+    return apps;
+}
+
+} // namespace ns3
+
+#endif /* STAGGERED_INSTALL_HELPER_H */
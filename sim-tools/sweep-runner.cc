@@ -0,0 +1,138 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Runs one of the LTE scenarios over a parameter grid and a range of seeds on
+// all cores, e.g.
+//
+//   ./ns3 run "sweep-runner --program=build/scratch/project/ns3.40-project-default
+//              --grid=numNodePairs=2,4,8;simTime=5s,10s --runs=10"
+//
+// Every run gets its own directory under --outputDir and the run summaries are
+// merged into --table. Successful runs are kept in --cacheDir, so repeating a
+// sweep, or extending its grid, only runs the points not seen before.
+//
+// With --ciMetrics, the number of seeds is not fixed: every grid point gets
+// RngRun replicas until the confidence interval of each listed metric is
+// within --ciTarget of its mean, e.g.
+//
+//   --ciMetrics=meanDelayMs,throughputKbps --ciTarget=0.05 --maxRuns=50
+//
+// and the estimates are written to --estimates.
+
+#include "parameter-sweep.h"
+#include "replication-controller.h"
+
+#include "ns3/core-module.h"
+
+#include <iostream>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("SweepRunner");
+
+int
+main(int argc, char* argv[])
+{
+    std::string program;
+    std::string grid;
+    std::string fixedArgs;
+    std::string outputDir = "sweep";
+    std::string table = "sweep.csv";
+    std::string cacheDir = "sweep-cache";
+    uint32_t firstRun = 1;
+    uint32_t runs = 1;
+    uint32_t threads = 0;
+    std::string ciMetrics;
+    double ciTarget = 0.05;
+    double ciLevel = 0.95;
+    uint32_t minRuns = 3;
+    uint32_t maxRuns = 30;
+    std::string estimates = "sweep-estimates.csv";
+
+    CommandLine cmd;
+    cmd.AddValue("program", "Scenario binary to run", program);
+    cmd.AddValue("grid", "Swept parameters, e.g. numNodePairs=2,4;simTime=5s,10s", grid);
+    cmd.AddValue("args", "Space separated arguments passed to every run", fixedArgs);
+    cmd.AddValue("outputDir", "Directory holding one sub-directory per run", outputDir);
+    cmd.AddValue("table", "Merged result table", table);
+    cmd.AddValue("cacheDir",
+                 "Cache of the successful runs (empty to run every point); the run "
+                 "directories are emptied before every run while it is set",
+                 cacheDir);
+    cmd.AddValue("firstRun", "First RngRun", firstRun);
+    cmd.AddValue("runs", "Number of RngRun values per grid point", runs);
+    cmd.AddValue("threads", "Parallel runs (0 for one per core)", threads);
+    cmd.AddValue("ciMetrics",
+                 "Comma separated summary metrics; if set, every grid point runs until their "
+                 "confidence intervals reach ciTarget, instead of a fixed number of runs",
+                 ciMetrics);
+    cmd.AddValue("ciTarget", "Target half-width of the intervals, relative to the mean", ciTarget);
+    cmd.AddValue("ciLevel", "Confidence level of the intervals", ciLevel);
+    cmd.AddValue("minRuns", "RngRun replicas of every grid point before the first check", minRuns);
+    cmd.AddValue("maxRuns", "RngRun replicas of a grid point at most", maxRuns);
+    cmd.AddValue("estimates", "Mean and half-width of the metrics per grid point", estimates);
+    cmd.Parse(argc, argv);
+
+    ParameterSweep sweep;
+    if (program.empty() || !sweep.AddGrid(grid))
+    {
+        std::cerr << "A --program and a valid --grid are required\n";
+        return 1;
+    }
+    sweep.SetProgram(program);
+    sweep.SetOutputDirectory(outputDir);
+    sweep.SetRuns(firstRun, runs);
+    sweep.SetThreads(threads);
+    sweep.SetCacheDirectory(cacheDir);
+    std::istringstream args(fixedArgs);
+    for (std::string arg; args >> arg;)
+    {
+        sweep.AddFixedArgument(arg);
+    }
+
+    std::vector<SweepResult> results;
+    if (ciMetrics.empty())
+    {
+        results = sweep.Run(sweep.Expand());
+    }
+    else
+    {
+        // Replicas are numbered from firstRun; --runs does not apply
+        sweep.SetRuns(firstRun, 1);
+        ReplicationController controller(sweep);
+        std::istringstream metrics(ciMetrics);
+        for (std::string metric; std::getline(metrics, metric, ',');)
+        {
+            controller.AddMetric(metric);
+        }
+        controller.SetTarget(ciTarget, ciLevel);
+        controller.SetRunLimits(minRuns, maxRuns);
+        results = controller.Run();
+        controller.WriteEstimates(estimates);
+    }
+    ParameterSweep::WriteTable(results, table);
+
+    uint32_t failed = 0;
+    uint32_t cached = 0;
+    for (const auto& result : results)
+    {
+        failed += result.exitCode != 0 ? 1 : 0;
+        cached += result.cached ? 1 : 0;
+    }
+    std::cout << results.size() << " runs, " << cached << " from the cache, " << failed
+              << " failed, table in " << table << "\n";
+    return failed > 0 ? 1 : 0;
+}
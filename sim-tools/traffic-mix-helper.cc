@@ -0,0 +1,164 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "traffic-mix-helper.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("TrafficMixHelper");
+
+TrafficMixHelper::TrafficMixHelper(const std::vector<std::string>& profiles)
+    : m_uniform(CreateObject<UniformRandomVariable>())
+{
+    for (const auto& name : profiles)
+    {
+        m_profiles.push_back({name, 0, NodeContainer()});
+    }
+}
+
+void
+TrafficMixHelper::SetWeight(const std::string& profile, double weight)
+{
+    NS_ABORT_MSG_IF(!(weight >= 0),
+                    "Invalid weight " << weight << " of profile \"" << profile << "\"");
+    m_profiles[Find(profile)].weight = weight;
+}
+
+void
+TrafficMixHelper::SetWeights(const std::string& mix)
+{
+    std::istringstream in(mix);
+    std::string pair;
+    while (std::getline(in, pair, ','))
+    {
+        const std::size_t eq = pair.find('=');
+        NS_ABORT_MSG_IF(eq == std::string::npos, "Expected name=weight in \"" << pair << "\"");
+        std::istringstream weight(pair.substr(eq + 1));
+        double value = -1;
+        weight >> value;
+        NS_ABORT_MSG_IF(weight.fail(), "Invalid weight in \"" << pair << "\"");
+        SetWeight(pair.substr(0, eq), value);
+    }
+}
+
+int64_t
+TrafficMixHelper::AssignStreams(int64_t stream)
+{
+    m_uniform->SetStream(stream);
+    return 1;
+}
+
+void
+TrafficMixHelper::Assign(NodeContainer nodes)
+{
+    NS_LOG_FUNCTION(this << nodes.GetN());
+    double total = 0;
+    for (auto& p : m_profiles)
+    {
+        p.nodes = NodeContainer();
+        total += p.weight;
+    }
+    const uint32_t n = nodes.GetN();
+    if (n == 0)
+    {
+        return;
+    }
+    NS_ABORT_MSG_IF(total <= 0, "The traffic mix has no weight");
+
+    // Largest remainder: the floors first, then one more node for the
+    // largest fractional parts, the earlier profile first on ties
+    std::vector<uint32_t> quota(m_profiles.size());
+    std::vector<std::pair<double, std::size_t>> remainders;
+    uint32_t assigned = 0;
+    for (std::size_t i = 0; i < m_profiles.size(); ++i)
+    {
+        const double exact = m_profiles[i].weight / total * n;
+        quota[i] = static_cast<uint32_t>(std::floor(exact));
+        assigned += quota[i];
+        remainders.emplace_back(exact - quota[i], i);
+    }
+    std::stable_sort(remainders.begin(), remainders.end(), [](const auto& a, const auto& b) {
+        return a.first > b.first;
+    });
+    for (std::size_t k = 0; assigned < n; ++k, ++assigned)
+    {
+        ++quota[remainders[k].second];
+    }
+
+    // Profile of every slot, then a Fisher-Yates shuffle of the slots
+    std::vector<std::size_t> slots;
+    slots.reserve(n);
+    for (std::size_t i = 0; i < m_profiles.size(); ++i)
+    {
+        slots.insert(slots.end(), quota[i], i);
+    }
+    for (uint32_t i = n - 1; i > 0; --i)
+    {
+        std::swap(slots[i], slots[m_uniform->GetInteger(0, i)]);
+    }
+    for (uint32_t u = 0; u < n; ++u)
+    {
+        m_profiles[slots[u]].nodes.Add(nodes.Get(u));
+    }
+    for (const auto& p : m_profiles)
+    {
+        NS_LOG_INFO(p.name << ": " << p.nodes.GetN() << " of " << n << " nodes");
+    }
+}
+
+std::size_t
+TrafficMixHelper::Find(const std::string& name) const
+{
+    for (std::size_t i = 0; i < m_profiles.size(); ++i)
+    {
+        if (m_profiles[i].name == name)
+        {
+            return i;
+        }
+    }
+    std::string known;
+    for (const auto& p : m_profiles)
+    {
+        known += (known.empty() ? "" : ", ") + p.name;
+    }
+    NS_ABORT_MSG("Unknown traffic profile \"" << name << "\"; expected one of " << known);
+    return 0;
+}
+
+NodeContainer
+TrafficMixHelper::GetNodes(const std::string& profile) const
+{
+    return m_profiles[Find(profile)].nodes;
+}
+
+void
+TrafficMixHelper::AddToSummary(RunSummary& summary) const
+{
+    for (const auto& p : m_profiles)
+    {
+        summary.Set(p.name + "Ues", p.nodes.GetN());
+    }
+}
+
+} // namespace ns3
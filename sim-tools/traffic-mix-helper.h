@@ -0,0 +1,132 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef TRAFFIC_MIX_HELPER_H
+#define TRAFFIC_MIX_HELPER_H
+
+#include "run-summary.h"
+
+#include "ns3/application-container.h"
+#include "ns3/node-container.h"
+#include "ns3/random-variable-stream.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Splits a UE population between weighted traffic profiles (web browsing,
+ * bulk TCP, CBR UDP, idle, ...), so that every profile is then installed on
+ * its nodes in one Install call.
+ *
+ * The number of nodes of a profile is its share of the total weight,
+ * rounded by largest remainder, so the load of each profile is set by its
+ * weight alone and does not change between runs. Which nodes get which
+ * profile is a random permutation drawn from a dedicated stream: a run is
+ * reproducible for a given seed, run number and stream, and two run numbers
+ * give two independent placements of the same mix.
+ */
+class TrafficMixHelper
+{
+  public:
+    /**
+     * \param profiles The profiles the scenario installs, all of weight zero
+     *        until set; they keep this order.
+     */
+    explicit TrafficMixHelper(const std::vector<std::string>& profiles);
+
+    /**
+     * Change the weight of a profile; unknown profiles abort, so a typo or a
+     * profile the scenario does not install cannot leave nodes idle.
+     * \param profile The profile name.
+     * \param weight Its relative weight, zero to keep it empty.
+     */
+    void SetWeight(const std::string& profile, double weight);
+
+    /**
+     * Set the weights of several profiles at once.
+     * \param mix "name=weight" pairs separated by commas, e.g.
+     *        "http=2,bulk=1,udp=1,idle=1".
+     */
+    void SetWeights(const std::string& mix);
+
+    /**
+     * Fix the random stream of the placement.
+     * \param stream The first stream index to use.
+     * \return The number of streams used.
+     */
+    int64_t AssignStreams(int64_t stream);
+
+    /**
+     * Give every node a profile, replacing any previous assignment.
+     * \param nodes The population.
+     */
+    void Assign(NodeContainer nodes);
+
+    /**
+     * \param profile A profile name.
+     * \return Its nodes in population order; unknown profiles abort.
+     */
+    NodeContainer GetNodes(const std::string& profile) const;
+
+    /**
+     * Install an application on all the nodes of a profile in one call.
+     * \param profile The profile.
+     * \param helper Any application helper with Install(NodeContainer).
+     * \return The applications, empty if the profile has no node.
+     */
+    template <typename Helper>
+    ApplicationContainer Install(const std::string& profile, const Helper& helper) const;
+
+    /**
+     * Add the number of nodes of every profile to a run summary, as
+     * "<profile>Ues".
+     * \param summary The run summary.
+     */
+    void AddToSummary(RunSummary& summary) const;
+
+  private:
+    /// A profile and the nodes it was given.
+    struct Profile
+    {
+        std::string name;    //!< Profile name.
+        double weight;       //!< Relative weight.
+        NodeContainer nodes; //!< Nodes of the last assignment.
+    };
+
+    /**
+     * \param name A profile name.
+     * \return The index of the profile; unknown names abort.
+     */
+    std::size_t Find(const std::string& name) const;
+
+    std::vector<Profile> m_profiles;      //!< Profiles in scenario order.
+    Ptr<UniformRandomVariable> m_uniform; //!< Permutation of the nodes.
+};
+
+template <typename Helper>
+ApplicationContainer
+TrafficMixHelper::Install(const std::string& profile, const Helper& helper) const
+{
+    const NodeContainer nodes = GetNodes(profile);
+    return nodes.GetN() > 0 ? helper.Install(nodes) : ApplicationContainer();
+}
+
+} // namespace ns3
+
+#endif /* TRAFFIC_MIX_HELPER_H */
@@ -18,6 +18,9 @@
  * Author: Lauri Sormunen <lauri.sormunen@magister.fi>
  */
 
+#include "http-metrics-collector.h"
+#include "http-qoe-tracker.h"
+
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
 #include "ns3/internet-module.h"
@@ -62,14 +65,14 @@ ClientRx (Ptr<const Packet> packet, const Address &address)
 void
 ClientMainObjectReceived (Ptr<const ThreeGppHttpClient>, Ptr<const Packet> packet)
 {
-  Ptr<Packet> p = packet->Copy ();
   ThreeGppHttpHeader header;
-  p->RemoveHeader (header);
-  if (header.GetContentLength () == p->GetSize ()
+  const uint32_t headerSize = packet->PeekHeader (header);
+  const uint32_t contentSize = packet->GetSize () - headerSize;
+  if (header.GetContentLength () == contentSize
       && header.GetContentType () == ThreeGppHttpHeader::MAIN_OBJECT)
     {
       NS_LOG_INFO ("Client has successfully received a main object of "
-                   << p->GetSize () << " bytes.");
+                   << contentSize << " bytes.");
     }
   else
     {
@@ -80,14 +83,14 @@ ClientMainObjectReceived (Ptr<const ThreeGppHttpClient>, Ptr<const Packet> packe
 void
 ClientEmbeddedObjectReceived (Ptr<const ThreeGppHttpClient>, Ptr<const Packet> packet)
 {
-  Ptr<Packet> p = packet->Copy ();
   ThreeGppHttpHeader header;
-  p->RemoveHeader (header);
-  if (header.GetContentLength () == p->GetSize ()
+  const uint32_t headerSize = packet->PeekHeader (header);
+  const uint32_t contentSize = packet->GetSize () - headerSize;
+  if (header.GetContentLength () == contentSize
       && header.GetContentType () == ThreeGppHttpHeader::EMBEDDED_OBJECT)
     {
       NS_LOG_INFO ("Client has successfully received an embedded object of "
-                   << p->GetSize () << " bytes.");
+                   << contentSize << " bytes.");
     }
   else
     {
@@ -99,15 +102,20 @@ int
 main (int argc, char *argv[])
 {
   double simTimeSec = 30;
+  std::string httpTrace = "metrics";
   CommandLine cmd;
   cmd.AddValue ("SimulationTime", "Length of simulation in seconds.", simTimeSec);
+  cmd.AddValue ("httpTrace", "metrics (counters and histograms in three-gpp-http-example-http.csv, page load times in three-gpp-http-example-http-qoe.csv) or log (NS_LOG_INFO per packet)", httpTrace);
   cmd.Parse (argc, argv);
 
   Time::SetResolution (Time::NS);
   LogComponentEnableAll (LOG_PREFIX_TIME);
   //LogComponentEnableAll (LOG_PREFIX_FUNC);
   //LogComponentEnable ("ThreeGppHttpClient", LOG_INFO);
-  LogComponentEnable ("ThreeGppHttpExample", LOG_INFO);
+  if (httpTrace == "log")
+    {
+      LogComponentEnable ("ThreeGppHttpExample", LOG_INFO);
+    }
 
   // Setup two nodes
   NodeContainer nodes;
@@ -137,12 +145,24 @@ main (int argc, char *argv[])
   ApplicationContainer serverApps = serverHelper.Install (nodes.Get (1));
   Ptr<ThreeGppHttpServer> httpServer = serverApps.Get (0)->GetObject<ThreeGppHttpServer> ();
 
-  // Example of connecting to the trace sources
-  httpServer->TraceConnectWithoutContext ("ConnectionEstablished",
-                                          MakeCallback (&ServerConnectionEstablished));
-  httpServer->TraceConnectWithoutContext ("MainObject", MakeCallback (&MainObjectGenerated));
-  httpServer->TraceConnectWithoutContext ("EmbeddedObject", MakeCallback (&EmbeddedObjectGenerated));
-  httpServer->TraceConnectWithoutContext ("Tx", MakeCallback (&ServerTx));
+  // Counters instead of a log line per packet, unless asked for
+  Ptr<HttpMetricsCollector> httpMetrics;
+  Ptr<HttpQoeTracker> httpQoe;
+  if (httpTrace == "metrics")
+    {
+      httpMetrics = CreateObject<HttpMetricsCollector> ();
+      httpMetrics->Install (serverApps);
+      httpQoe = CreateObject<HttpQoeTracker> ();
+    }
+  else
+    {
+      // Example of connecting to the trace sources
+      httpServer->TraceConnectWithoutContext ("ConnectionEstablished",
+                                              MakeCallback (&ServerConnectionEstablished));
+      httpServer->TraceConnectWithoutContext ("MainObject", MakeCallback (&MainObjectGenerated));
+      httpServer->TraceConnectWithoutContext ("EmbeddedObject", MakeCallback (&EmbeddedObjectGenerated));
+      httpServer->TraceConnectWithoutContext ("Tx", MakeCallback (&ServerTx));
+    }
 
   // Setup HTTP variables for the server
   PointerValue varPtr;
@@ -159,15 +179,31 @@ main (int argc, char *argv[])
   ApplicationContainer clientApps = clientHelper.Install (nodes.Get (0));
   Ptr<ThreeGppHttpClient> httpClient = clientApps.Get (0)->GetObject<ThreeGppHttpClient> ();
 
-  // Example of connecting to the trace sources
-  httpClient->TraceConnectWithoutContext ("RxMainObject", MakeCallback (&ClientMainObjectReceived));
-  httpClient->TraceConnectWithoutContext ("RxEmbeddedObject", MakeCallback (&ClientEmbeddedObjectReceived));
-  httpClient->TraceConnectWithoutContext ("Rx", MakeCallback (&ClientRx));
+  if (httpMetrics)
+    {
+      httpMetrics->Install (clientApps);
+      httpQoe->Install (clientApps);
+      httpMetrics->Start ("three-gpp-http-example-http.csv");
+      // The periodic summaries never let the event list run empty
+      Simulator::Stop (Seconds (simTimeSec));
+    }
+  else
+    {
+      // Example of connecting to the trace sources
+      httpClient->TraceConnectWithoutContext ("RxMainObject", MakeCallback (&ClientMainObjectReceived));
+      httpClient->TraceConnectWithoutContext ("RxEmbeddedObject", MakeCallback (&ClientEmbeddedObjectReceived));
+      httpClient->TraceConnectWithoutContext ("Rx", MakeCallback (&ClientRx));
+    }
 
   // Stop browsing after 30 minutes
   clientApps.Stop (Seconds (simTimeSec));
     pointToPoint.EnablePcapAll("three-gpp-http-example");
   Simulator::Run ();
+  if (httpMetrics)
+    {
+      httpMetrics->Flush ();
+      httpQoe->Write ("three-gpp-http-example-http-qoe.csv");
+    }
   Simulator::Destroy ();
   return 0;
 }
\ No newline at end of file